@@ -0,0 +1,99 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "BackgroundStripes.h"
+#include "MkException.h"
+#include "define.h"
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+/**
+* @brief Split the image in stripes and create one model per stripe
+*
+* @param x_size      Size of the images
+* @param x_nbStripes Number of horizontal stripes
+* @param x_overlap   Number of rows of the neighbouring stripes given to each model
+* @param x_factory   Function that creates a model
+*/
+void BackgroundStripes::Reset(const Size& x_size, int x_nbStripes, int x_overlap, const Factory& x_factory)
+{
+	if(x_nbStripes < 1)
+		throw MkException("Invalid number of stripes for background subtraction: " + to_string(x_nbStripes), LOC);
+	m_size = x_size;
+	m_stripes.clear();
+	for(const auto& tile : splitInStripes(x_size, x_nbStripes, x_overlap))
+	{
+		m_stripes.push_back(Stripe());
+		m_stripes.back().tile  = tile;
+		m_stripes.back().model = x_factory();
+	}
+}
+
+/**
+* @brief Apply the models on all stripes and stitch the foreground
+*
+* @param x_input        Input image
+* @param xr_foreground  Output foreground mask
+* @param x_learningRate Learning rate passed to the models
+*/
+void BackgroundStripes::Apply(const Mat& x_input, Mat& xr_foreground, double x_learningRate)
+{
+	if(m_stripes.size() == 1)
+	{
+		m_stripes.front().model->apply(x_input, xr_foreground, x_learningRate);
+		return;
+	}
+	xr_foreground.create(x_input.size(), CV_8UC1);
+	parallelForEach(m_stripes.size(), [&](int i)
+	{
+		Stripe& stripe(m_stripes[i]);
+		stripe.model->apply(x_input(stripe.tile.halo), stripe.foreground, x_learningRate);
+		stripe.foreground(stripe.tile.Local()).copyTo(xr_foreground(stripe.tile.roi));
+	});
+}
+
+/**
+* @brief Stitch the background images of all models
+*
+* @param xr_background Output background image
+*/
+void BackgroundStripes::GetBackgroundImage(Mat& xr_background)
+{
+	if(m_stripes.size() == 1)
+	{
+		m_stripes.front().model->getBackgroundImage(xr_background);
+		return;
+	}
+	for(auto& stripe : m_stripes)
+	{
+		stripe.model->getBackgroundImage(stripe.background);
+		if(stripe.background.empty())
+			continue;
+		xr_background.create(m_size, stripe.background.type());
+		stripe.background(stripe.tile.Local()).copyTo(xr_background(stripe.tile.roi));
+	}
+}
+
+} // namespace mk
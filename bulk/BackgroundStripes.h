@@ -0,0 +1,62 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_BACKGROUND_STRIPES_H
+#define MK_BACKGROUND_STRIPES_H
+
+#include <functional>
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "opencv2/video/background_segm.hpp"
+#include "Tiles.h"
+
+namespace mk {
+
+/**
+* @brief Run independent background models on horizontal stripes of the image, in parallel. Each model also sees an
+*        overlap band of the neighbouring stripes, so that the stitched mask has no seams.
+*/
+class BackgroundStripes
+{
+public:
+	typedef std::function<cv::Ptr<cv::BackgroundSubtractor>()> Factory;
+
+	void Reset(const cv::Size& x_size, int x_nbStripes, int x_overlap, const Factory& x_factory);
+	void Apply(const cv::Mat& x_input, cv::Mat& xr_foreground, double x_learningRate);
+	void GetBackgroundImage(cv::Mat& xr_background);
+	inline size_t GetNbStripes() const {return m_stripes.size();}
+
+protected:
+	struct Stripe
+	{
+		Tile tile;       // the halo is given to the model, the roi is written
+		cv::Ptr<cv::BackgroundSubtractor> model;
+		cv::Mat foreground;
+		cv::Mat background;
+	};
+	std::vector<Stripe> m_stripes;
+	cv::Size m_size;
+};
+
+} // namespace mk
+#endif
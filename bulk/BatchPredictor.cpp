@@ -0,0 +1,187 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "BatchPredictor.h"
+#include "FeatureStd.h"
+#include "MkException.h"
+#include "util.h"
+
+// the fast path is checked against the model on this number of samples (and on both classes for a classifier)
+#define MIN_VERIFIED_SAMPLES 100
+
+namespace mk {
+using namespace std;
+using namespace cv;
+using namespace cv::ml;
+
+log4cxx::LoggerPtr BatchPredictor::m_logger(log4cxx::Logger::getLogger("BatchPredictor"));
+
+/**
+* @brief Set the model used for prediction. If the model is a trained SVM with a linear kernel and one decision
+*        function, its support vectors are reduced to one weight vector
+*
+* @param x_model Model
+*/
+void BatchPredictor::SetModel(const Ptr<ml::StatModel>& x_model)
+{
+	mp_model   = x_model;
+	m_weights  = Mat();
+	m_rho      = 0;
+	m_verified = false;
+	m_nbVerified = 0;
+	m_labelsVerified[0] = m_labelsVerified[1] = false;
+
+	Ptr<SVM> svm = x_model.dynamicCast<SVM>();
+	if(svm.empty() || !svm->isTrained() || svm->getKernelType() != SVM::LINEAR)
+		return;
+	m_svmType = svm->getType();
+
+	// note: a classifier of n classes has n(n-1)/2 decision functions. OpenCV compresses the support vectors of a
+	//       linear SVM to one vector per decision function
+	const Mat sv = svm->getSupportVectors();
+	if((m_svmType == SVM::C_SVC || m_svmType == SVM::NU_SVC) && sv.rows != 1)
+	{
+		LOG_DEBUG(m_logger, "SVM has more than one decision function, no fast path");
+		return;
+	}
+
+	Mat alpha, index;
+	m_rho = svm->getDecisionFunction(0, alpha, index);
+	alpha.convertTo(alpha, CV_64F);
+	Mat weights = Mat::zeros(1, sv.cols, CV_64F);
+	for(int i = 0 ; i < index.cols * index.rows ; i++)
+	{
+		Mat row;
+		sv.row(index.at<int>(i)).convertTo(row, CV_64F);
+		weights += alpha.at<double>(i) * row;
+	}
+	weights.convertTo(m_weights, CV_32F);
+	LOG_DEBUG(m_logger, "Linear SVM reduced to a weight vector of size " << m_weights.cols);
+}
+
+/**
+* @brief Predict all samples
+*
+* @param x_samples  Samples (CV_32F), one per row
+* @param xr_results Results (CV_32F), one per row
+*/
+void BatchPredictor::Predict(const Mat& x_samples, Mat& xr_results)
+{
+	if(mp_model.empty())
+		throw MkException("No model to predict with", LOC);
+	if(x_samples.empty())
+	{
+		xr_results = Mat(0, 1, CV_32F);
+		return;
+	}
+	if(!IsLinear())
+	{
+		mp_model->predict(x_samples, xr_results);
+		return;
+	}
+
+	PredictLinear(x_samples, xr_results);
+	if(m_verified)
+		return;
+
+	// The fast path relies on the internals of OpenCV (e.g. labels 0 and 1): check it against the model until enough
+	// samples of each class were predicted. A single batch may not contain all cases
+	Mat expected;
+	mp_model->predict(x_samples, expected);
+	const bool classifier = m_svmType == SVM::C_SVC || m_svmType == SVM::NU_SVC || m_svmType == SVM::ONE_CLASS;
+	for(int i = 0 ; i < x_samples.rows ; i++)
+	{
+		const float exp = expected.at<float>(i);
+		const float res = xr_results.at<float>(i);
+		if(classifier ? exp != res : abs(exp - res) > 1e-3 * (1 + abs(exp)))
+		{
+			LOG_WARN(m_logger, "Fast prediction of linear SVM differs from the model (" << res << " instead of " << exp << "), it is disabled");
+			m_weights = Mat();
+			expected.copyTo(xr_results);
+			return;
+		}
+		if(classifier)
+			m_labelsVerified[exp != 0] = true;
+	}
+	m_nbVerified += x_samples.rows;
+	m_verified = m_nbVerified >= MIN_VERIFIED_SAMPLES && (!classifier || (m_labelsVerified[0] && m_labelsVerified[1]));
+	if(m_verified)
+		LOG_DEBUG(m_logger, "Fast prediction of linear SVM verified on " << m_nbVerified << " samples");
+}
+
+/// Evaluate the decision function of a linear SVM as a product with the weights
+void BatchPredictor::PredictLinear(const Mat& x_samples, Mat& xr_results) const
+{
+	if(x_samples.cols != m_weights.cols)
+		throw MkException("Samples do not match the size of the model", LOC);
+	gemm(x_samples, m_weights, 1, noArray(), 0, xr_results, GEMM_2_T);
+	xr_results -= m_rho;
+
+	if(m_svmType == SVM::C_SVC || m_svmType == SVM::NU_SVC)
+	{
+		// note: OpenCV gives the first class (sorted labels) for a positive decision
+		for(int i = 0 ; i < xr_results.rows ; i++)
+			xr_results.at<float>(i) = xr_results.at<float>(i) > 0 ? 0 : 1;
+	}
+	else if(m_svmType == SVM::ONE_CLASS)
+	{
+		for(int i = 0 ; i < xr_results.rows ; i++)
+			xr_results.at<float>(i) = xr_results.at<float>(i) > 0 ? 1 : 0;
+	}
+}
+
+/**
+* @brief Extract the features of objects as a matrix of samples
+*
+* @param x_objects       Objects
+* @param x_featureNames  Names of the float features, one per column
+* @param x_response      Name of the response feature: objects without response have a response of -1. Ignored if empty
+* @param xr_samples      Samples (CV_32F), one row per object
+* @param xr_responses    Responses (CV_32S), one row per object
+*/
+void BatchPredictor::ExtractSamples(const vector<Object>& x_objects, const vector<string>& x_featureNames,
+	const string& x_response, Mat& xr_samples, Mat& xr_responses)
+{
+	if(x_featureNames.empty())
+		throw MkException("No feature to extract", LOC);
+	xr_samples.create(x_objects.size(), x_featureNames.size(), CV_32F);
+	xr_responses.create(x_objects.size(), 1, CV_32S);
+
+	int row = 0;
+	for(const auto& obj : x_objects)
+	{
+		float* samples = xr_samples.ptr<float>(row);
+		for(const auto& name : x_featureNames)
+		{
+			const FeatureFloat* feat = dynamic_cast<const FeatureFloat*>(&obj.GetFeature(name));
+			if(feat == nullptr)
+				throw MkException("Feature " + name + " must be a float", LOC);
+			*samples++ = feat->value;
+		}
+		xr_responses.at<int>(row) = !x_response.empty() && obj.HasFeature(x_response) ?
+			static_cast<int>(dynamic_cast<const FeatureFloat&>(obj.GetFeature(x_response)).value > 0.4) : -1;
+		row++;
+	}
+}
+
+} // namespace mk
@@ -0,0 +1,67 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_BATCH_PREDICTOR_H
+#define MK_BATCH_PREDICTOR_H
+
+#include <vector>
+#include <log4cxx/logger.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/ml.hpp>
+#include "Object.h"
+
+namespace mk {
+
+/**
+* @brief Predict the samples of a frame in one batch with a statistical model. Linear SVMs are evaluated as a
+*        matrix product with the weight vector (vectorized by OpenCV) instead of the kernel sum of each sample.
+*        The fast path is checked against the prediction of OpenCV until enough samples of each class were predicted.
+*/
+class BatchPredictor
+{
+public:
+	void SetModel(const cv::Ptr<cv::ml::StatModel>& x_model);
+	void Predict(const cv::Mat& x_samples, cv::Mat& xr_results);
+	inline bool IsLinear() const {return !m_weights.empty();}
+	inline bool IsVerified() const {return m_verified;}
+
+	static void ExtractSamples(const std::vector<Object>& x_objects, const std::vector<std::string>& x_featureNames,
+		const std::string& x_response, cv::Mat& xr_samples, cv::Mat& xr_responses);
+
+protected:
+	void PredictLinear(const cv::Mat& x_samples, cv::Mat& xr_results) const;
+
+	cv::Ptr<cv::ml::StatModel> mp_model;
+	cv::Mat m_weights;   // weight vector of a linear SVM (1 x cols, CV_32F)
+	double m_rho     = 0;
+	int m_svmType    = 0;
+	bool m_verified  = false;
+	int m_nbVerified = 0;                 // number of samples checked against the model
+	bool m_labelsVerified[2] = {false, false}; // classes checked against the model
+
+private:
+	static log4cxx::LoggerPtr m_logger;
+};
+
+} // namespace mk
+#endif
@@ -0,0 +1,218 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_BATCH_QUEUE_H
+#define MK_BATCH_QUEUE_H
+
+#include <boost/noncopyable.hpp>
+#include <functional>
+#include <condition_variable>
+#include <exception>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace mk {
+
+/**
+* @brief A queue that accumulates items and writes them by batches in a background thread (e.g. for a database).
+*        A batch is written when it reaches its size or when the flush interval has elapsed.
+*        Exceptions thrown while writing are rethrown at the next call to Push or Flush.
+*/
+template<class T> class BatchQueue : boost::noncopyable
+{
+public:
+	typedef std::function<void(std::vector<T>&)> Writer;
+
+	/**
+	* @brief Constructor
+	*
+	* @param x_batchSize     Number of items that triggers a write
+	* @param x_flushInterval Maximal time that an item stays in the queue [s]
+	* @param x_maxSize       Maximal number of items in the queue, if the queue is full Push waits
+	* @param x_writer        Function that writes a batch
+	*/
+	BatchQueue(size_t x_batchSize, double x_flushInterval, size_t x_maxSize, Writer x_writer) :
+		m_batchSize(std::max<size_t>(x_batchSize, 1)),
+		m_flushInterval(static_cast<int64_t>(x_flushInterval * 1000)),
+		m_maxSize(std::max(x_maxSize, m_batchSize)),
+		m_writer(x_writer)
+	{
+		m_thread = std::thread(&BatchQueue::Work, this);
+	}
+
+	/// Destructor: remaining items are written before the thread exits
+	virtual ~BatchQueue()
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_condPush.notify_one();
+		m_thread.join();
+	}
+
+	/// Add an item to the queue. This only blocks if the queue is full
+	void Push(T&& x_item)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		RethrowIfNeeded();
+		m_condWritten.wait(lock, [this]{return m_items.size() < m_maxSize;});
+		Add(std::move(x_item));
+	}
+
+	/// Add an item to the queue if it is not full. Return false if the item was not added
+	bool TryPush(T&& x_item)
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		RethrowIfNeeded();
+		if(m_items.size() >= m_maxSize)
+			return false;
+		Add(std::move(x_item));
+		return true;
+	}
+
+	/// Write the queued items without waiting for the batch to be full or for the flush interval. This does not block
+	void Submit()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		RethrowIfNeeded();
+		// note: if the queue is empty, all items are already being written
+		if(m_items.empty())
+			return;
+		m_submitRequested = true;
+		m_condPush.notify_one();
+	}
+
+	/// Write all items and wait for completion
+	void Flush()
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_flushRequested = true;
+		m_condPush.notify_one();
+		m_condWritten.wait(lock, [this]{return m_items.empty() && !m_writing;});
+		m_flushRequested = false;
+		RethrowIfNeeded();
+	}
+
+	inline uint64_t GetNbWritten() const {std::unique_lock<std::mutex> lock(m_mutex); return m_nbWritten;}
+	inline uint64_t GetNbBatches() const {std::unique_lock<std::mutex> lock(m_mutex); return m_nbBatches;}
+	inline size_t GetNbQueued() const {std::unique_lock<std::mutex> lock(m_mutex); return m_items.size();}
+
+protected:
+	/// Add an item and wake the thread if needed. Must be called with the lock
+	void Add(T&& x_item)
+	{
+		// note: the flush interval starts with the oldest item of the queue
+		if(m_items.empty())
+			m_oldestPush = std::chrono::steady_clock::now();
+		m_items.push_back(std::move(x_item));
+		if(m_items.size() == 1 || m_items.size() >= m_batchSize || m_flushInterval.count() == 0)
+			m_condPush.notify_one();
+	}
+
+	/// Loop of the background thread
+	void Work()
+	{
+		std::vector<T> batch;
+		std::unique_lock<std::mutex> lock(m_mutex);
+		while(true)
+		{
+			auto ready = [this]{
+				return m_stop || (!m_items.empty() && (m_flushRequested || m_submitRequested || m_items.size() >= m_batchSize || m_flushInterval.count() == 0));
+			};
+			// note: when the interval has elapsed, the items are written even if the batch is incomplete
+			if(m_flushInterval.count() == 0)
+				m_condPush.wait(lock, ready);
+			else
+			{
+				m_condPush.wait(lock, [this]{return m_stop || !m_items.empty();});
+				m_condPush.wait_until(lock, m_oldestPush + m_flushInterval, ready);
+			}
+			if(m_items.empty())
+			{
+				if(m_stop)
+					return;
+				continue;
+			}
+			batch.swap(m_items);
+			m_submitRequested = false;
+			m_writing = true;
+			lock.unlock();
+			m_condWritten.notify_all();
+
+			try
+			{
+				m_writer(batch);
+			}
+			catch(...)
+			{
+				std::unique_lock<std::mutex> lock2(m_mutex);
+				m_exception = std::current_exception();
+			}
+			size_t nb = batch.size();
+			batch.clear();
+
+			lock.lock();
+			m_writing = false;
+			m_nbWritten += nb;
+			m_nbBatches++;
+			m_condWritten.notify_all();
+		}
+	}
+
+	/// Rethrow the last exception of the writer. Must be called with the lock
+	void RethrowIfNeeded()
+	{
+		if(m_exception)
+		{
+			std::exception_ptr excep = m_exception;
+			m_exception = nullptr;
+			std::rethrow_exception(excep);
+		}
+	}
+
+	const size_t m_batchSize;
+	const std::chrono::milliseconds m_flushInterval;
+	const size_t m_maxSize;
+	Writer m_writer;
+
+	std::thread m_thread;
+	mutable std::mutex m_mutex;
+	std::condition_variable m_condPush;    // signaled when a batch is ready to be written
+	std::condition_variable m_condWritten; // signaled when items were removed from the queue
+	std::vector<T> m_items;
+	std::chrono::steady_clock::time_point m_oldestPush; // time of the push of the oldest item in the queue
+	std::exception_ptr m_exception;
+	bool m_stop           = false;
+	bool m_flushRequested = false;
+	bool m_submitRequested = false;
+	bool m_writing        = false;
+	uint64_t m_nbWritten  = 0;
+	uint64_t m_nbBatches  = 0;
+};
+
+} // namespace mk
+#endif
@@ -23,6 +23,7 @@
 
 #include <memory>
 #include <boost/format.hpp>
+#include <opencv2/core/core.hpp>
 
 #include "Context.h"
 #include "util.h"
@@ -57,6 +58,10 @@ Context::Context(ParameterStructure& xr_params) :
 		m_jobId   = "test_" + ts;
 	}
 	else m_jobId = m_param.jobId;
+	mp_imageEncoder = std::make_unique<ImageEncoder>(m_param.encoderThreads);
+	// note: all parallel processing of images (OpenCV and tiles of modules) uses the same pool of threads
+	if(m_param.nbThreads > 0)
+		cv::setNumThreads(m_param.nbThreads);
 	LOG_INFO(m_logger, "Created context with cameraId=\"" << GetCameraId() << "\", jobId=\""
 		<< GetJobId() << "\", applicationName=\"" << GetApplicationName() << "\", configFile=\"" << m_param.configFile << "\"");
 	m_param.PrintParameters();
@@ -65,6 +70,9 @@ Context::Context(ParameterStructure& xr_params) :
 Context::~Context()
 {
 	LOG_DEBUG(m_logger, "Destroy context object");
+	// note: all images must be written before the output directory is archived
+	mp_imageEncoder.reset();
+
 	// check if dir is empty and was automatically generated (no -o option)
 	mp_outputDir->CheckOutputDir();
 	bool empty = m_param.outputDir.empty() && mp_outputDir->IsEmpty();
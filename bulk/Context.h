@@ -30,6 +30,7 @@
 #include "ParameterStructure.h"
 #include "ParameterT.h"
 #include "MkDirectory.h"
+#include "ImageEncoder.h"
 
 namespace mk {
 /**
@@ -55,6 +56,8 @@ public:
 			AddParameter(new ParameterString("cameraId",  ""       , &cameraId      ,  "CameraId id for storage in database. Leave empty for tests only."));
 			AddParameter(new ParameterString("cacheIn",        ""  , &cacheIn       ,  "The cache directory of a previous, empty if no cache, relative to output directory"));
 			AddParameter(new ParameterString("cacheOut",       ""  , &cacheOut      ,  "The directory in which the cache should be written, empty if no cache, relative to current directory"));
+			AddParameter(new ParameterInt("encoderThreads",    2, 0, 64, &encoderThreads,  "Number of threads used to encode and write images (thumbnails, events). If 0 images are written synchronously"));
+			AddParameter(new ParameterInt("nbThreads",         0, 0, 256, &nbThreads,      "Number of threads used to process images in parallel (by OpenCV and by tiles in modules). If 0 all cores are used"));
 		}
 		bool autoClean;
 		std::string archiveDir;
@@ -68,6 +71,8 @@ public:
 		std::string cameraId;
 		std::string cacheIn;
 		std::string cacheOut;
+		int encoderThreads;
+		int nbThreads;
 	};
 
 	~Context() override;
@@ -96,6 +101,12 @@ public:
 			throw MkException("No output cache dir exists, use option -O", LOC);
 		return *mp_cacheOut;
 	}
+	inline ImageEncoder& RefImageEncoder()
+	{
+		if(mp_imageEncoder.get() == nullptr)
+			throw MkException("No image encoder exists", LOC);
+		return *mp_imageEncoder;
+	}
 	inline bool IsCentralized() const {return m_param.centralized;}
 	inline bool IsRealTime() const {return m_param.realTime;}
 	const Parameters& GetParameters() const override {return m_param;}
@@ -106,6 +117,7 @@ protected:
 	std::unique_ptr<MkDirectory> mp_outputDir;
 	std::unique_ptr<MkDirectory> mp_cacheIn;
 	std::unique_ptr<MkDirectory> mp_cacheOut;
+	std::unique_ptr<ImageEncoder> mp_imageEncoder;
 
 private:
 	const Parameters& m_param;
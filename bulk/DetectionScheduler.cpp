@@ -0,0 +1,222 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "DetectionScheduler.h"
+#include "Tiles.h"
+#include "define.h"
+#include <opencv2/imgproc/imgproc.hpp>
+#include <cmath>
+
+#define THUMBNAIL_WIDTH  64
+#define THUMBNAIL_HEIGHT 48
+#define ACTIVITY_PIXEL_THRESHOLD 16
+#define MIN_TRACKING_SCORE 0.5
+#define COST_ALPHA 0.2
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+log4cxx::LoggerPtr DetectionScheduler::m_logger(log4cxx::Logger::getLogger("DetectionScheduler"));
+
+void DetectionScheduler::Reset()
+{
+	m_tracked.clear();
+	m_lastThumbnail = Mat();
+	m_detected             = false;
+	m_framesSinceDetection = 0;
+	m_interval             = 1;
+	m_detectionCost        = 0;
+	m_trackingCost         = 0;
+	m_nbFrames             = 0;
+	m_nbDetections         = 0;
+}
+
+/**
+* @brief Decide if the full detection must be run on the current frame
+*
+* @param x_image             Current image
+* @param x_interval          Number of frames between two detections
+* @param x_maxInterval       Maximal number of frames between two detections, if the interval is increased to meet the fps
+* @param x_activityThreshold Fraction of pixels changed since the last detection that triggers a detection (0: disabled)
+* @param x_fps               Target fps of the module (0: no target)
+*
+* @return true if the detection must be run
+*/
+bool DetectionScheduler::IsDetectionNeeded(const Mat& x_image, int x_interval, int x_maxInterval, double x_activityThreshold, double x_fps)
+{
+	m_nbFrames++;
+	m_interval = x_interval;
+	if(x_fps > 0 && m_detectionCost > 1.0 / x_fps)
+	{
+		// note: the average cost of a frame is (detection + (n - 1) * tracking) / n, it must stay below 1 / fps
+		const double margin = 1.0 / x_fps - m_trackingCost;
+		const int needed = margin > 0 ? static_cast<int>(ceil((m_detectionCost - m_trackingCost) / margin)) : x_maxInterval;
+		m_interval = max(m_interval, min(needed, x_maxInterval));
+	}
+
+	if(!m_detected || m_framesSinceDetection + 1 >= m_interval)
+		return true;
+	return x_activityThreshold > 0 && Activity(x_image) > x_activityThreshold;
+}
+
+/// Must be called before the full detection, to measure its cost
+void DetectionScheduler::StartDetection()
+{
+	m_startDetection = chrono::steady_clock::now();
+}
+
+/**
+* @brief Store the result of the full detection, the templates of detected objects are kept for tracking
+*
+* @param x_image    Image on which the detection was done
+* @param x_detected Detected rectangles
+*/
+void DetectionScheduler::SetDetections(const Mat& x_image, const vector<Rect>& x_detected)
+{
+	UpdateCost(m_detectionCost, chrono::duration<double>(chrono::steady_clock::now() - m_startDetection).count());
+	m_nbDetections++;
+	m_detected = true;
+	m_framesSinceDetection = 0;
+
+	// note: templates are only needed if frames are tracked
+	m_tracked.clear();
+	if(m_interval > 1)
+	{
+		for(const auto& elem : x_detected)
+		{
+			Rect rect = elem & Rect(Point(0, 0), x_image.size());
+			if(rect.area() > 0)
+				m_tracked.push_back(TrackedObject{rect, x_image(rect).clone()});
+		}
+	}
+	resize(x_image, m_lastThumbnail, Size(THUMBNAIL_WIDTH, THUMBNAIL_HEIGHT), 0, 0, INTER_AREA);
+}
+
+/**
+* @brief Propagate the last detections to the current frame: each object is searched by template matching in a window
+*        around its last position. Objects that are not found are dropped.
+*
+* @param x_image    Current image
+* @param xr_tracked Tracked rectangles
+*/
+void DetectionScheduler::Track(const Mat& x_image, vector<Rect>& xr_tracked)
+{
+	auto start = chrono::steady_clock::now();
+	m_framesSinceDetection++;
+	m_lost.assign(m_tracked.size(), 0);
+
+	parallelForEach(m_tracked.size(), [this, &x_image](int i){
+		TrackedObject& obj(m_tracked[i]);
+		// note: an object is assumed to move by less than half its size between two frames
+		const int margin = max(obj.rect.width, obj.rect.height) / 2 + 1;
+		Rect search(obj.rect.x - margin, obj.rect.y - margin, obj.rect.width + 2 * margin, obj.rect.height + 2 * margin);
+		search &= Rect(Point(0, 0), x_image.size());
+		if(search.width < obj.templ.cols || search.height < obj.templ.rows)
+		{
+			m_lost[i] = 1;
+			return;
+		}
+		Mat result;
+		matchTemplate(x_image(search), obj.templ, result, TM_CCOEFF_NORMED);
+		double maxVal = 0;
+		Point maxLoc;
+		minMaxLoc(result, nullptr, &maxVal, nullptr, &maxLoc);
+		if(!(maxVal >= MIN_TRACKING_SCORE))
+		{
+			m_lost[i] = 1;
+			return;
+		}
+		obj.rect = Rect(search.tl() + maxLoc, obj.templ.size());
+	});
+
+	xr_tracked.clear();
+	size_t j = 0;
+	for(size_t i = 0 ; i < m_tracked.size() ; i++)
+	{
+		if(m_lost[i])
+			continue;
+		xr_tracked.push_back(m_tracked[i].rect);
+		if(i != j)
+			m_tracked[j] = std::move(m_tracked[i]);
+		j++;
+	}
+	m_tracked.resize(j);
+	UpdateCost(m_trackingCost, chrono::duration<double>(chrono::steady_clock::now() - start).count());
+}
+
+/**
+* @brief Process one frame: run the full detection if needed, otherwise propagate the last detections
+*
+* @param x_image             Current image
+* @param x_interval          Number of frames between two detections
+* @param x_maxInterval       Maximal number of frames between two detections
+* @param x_activityThreshold Fraction of pixels changed since the last detection that triggers a detection (0: disabled)
+* @param x_fps               Target fps of the module (0: no target)
+* @param x_detect            Full detection of the module
+* @param xr_detected         Detected or tracked rectangles
+*
+* @return true if the full detection was run
+*/
+bool DetectionScheduler::Process(const Mat& x_image, int x_interval, int x_maxInterval, double x_activityThreshold, double x_fps,
+	const function<void(vector<Rect>&)>& x_detect, vector<Rect>& xr_detected)
+{
+	xr_detected.clear();
+	if(!IsDetectionNeeded(x_image, x_interval, x_maxInterval, x_activityThreshold, x_fps))
+	{
+		Track(x_image, xr_detected);
+		return false;
+	}
+	StartDetection();
+	x_detect(xr_detected);
+	SetDetections(x_image, xr_detected);
+	return true;
+}
+
+/// Log the fraction of frames on which the detection was run and add it to the results of the module
+void DetectionScheduler::PrintStatistics(const string& x_moduleName, mkconf& xr_result) const
+{
+	double ratio = m_nbFrames > 0 ? static_cast<double>(m_nbDetections) / m_nbFrames : 0;
+	LOG_INFO(m_logger, "Module " << x_moduleName << ": the detection was run on " << 100 * ratio << "% of the frames");
+	xr_result["module"][x_moduleName]["detectionRatio"] = ratio;
+}
+
+/// Fraction of the pixels that changed since the last detection, measured on thumbnails
+double DetectionScheduler::Activity(const Mat& x_image) const
+{
+	if(m_lastThumbnail.empty())
+		return 1;
+	Mat thumbnail, diff;
+	resize(x_image, thumbnail, m_lastThumbnail.size(), 0, 0, INTER_AREA);
+	absdiff(thumbnail, m_lastThumbnail, diff);
+	if(diff.channels() > 1)
+		diff = diff.reshape(1);
+	return static_cast<double>(countNonZero(diff > ACTIVITY_PIXEL_THRESHOLD)) / diff.total();
+}
+
+/// Update the moving average of a cost
+void DetectionScheduler::UpdateCost(double& xr_cost, double x_value)
+{
+	xr_cost = xr_cost == 0 ? x_value : (1 - COST_ALPHA) * xr_cost + COST_ALPHA * x_value;
+}
+} // namespace mk
@@ -0,0 +1,85 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_DETECTION_SCHEDULER_H
+#define MK_DETECTION_SCHEDULER_H
+
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <log4cxx/logger.h>
+#include <opencv2/core/core.hpp>
+#include "config.h"
+
+namespace mk {
+/**
+* @brief Schedule the full detection of an expensive detector: detections are only run every n frames or when the
+*        activity of the scene is high. In between, the last detections are propagated by template matching.
+*        If the module has a target fps, the interval between detections is increased according to the measured
+*        costs of detection and tracking.
+*/
+class DetectionScheduler
+{
+public:
+	void Reset();
+	bool IsDetectionNeeded(const cv::Mat& x_image, int x_interval, int x_maxInterval, double x_activityThreshold, double x_fps);
+	void StartDetection();
+	void SetDetections(const cv::Mat& x_image, const std::vector<cv::Rect>& x_detected);
+	void Track(const cv::Mat& x_image, std::vector<cv::Rect>& xr_tracked);
+	bool Process(const cv::Mat& x_image, int x_interval, int x_maxInterval, double x_activityThreshold, double x_fps,
+		const std::function<void(std::vector<cv::Rect>&)>& x_detect, std::vector<cv::Rect>& xr_detected);
+	void PrintStatistics(const std::string& x_moduleName, mkconf& xr_result) const;
+
+	inline uint64_t GetNbFrames() const {return m_nbFrames;}
+	inline uint64_t GetNbDetections() const {return m_nbDetections;}
+	inline int GetInterval() const {return m_interval;}
+
+protected:
+	/// An object detected at the last detection, propagated by template matching
+	struct TrackedObject
+	{
+		cv::Rect rect;
+		cv::Mat  templ;
+	};
+	double Activity(const cv::Mat& x_image) const;
+	void UpdateCost(double& xr_cost, double x_value);
+
+	std::vector<TrackedObject> m_tracked;
+	std::vector<uchar> m_lost;
+	cv::Mat m_lastThumbnail;           // thumbnail of the image of the last detection, to measure the activity
+	bool m_detected           = false; // true if a detection was done since the last reset
+	int m_framesSinceDetection = 0;
+	int m_interval             = 1;
+	double m_detectionCost     = 0;    // average time of a detection [s]
+	double m_trackingCost      = 0;    // average time of the tracking of a frame [s]
+	std::chrono::steady_clock::time_point m_startDetection;
+	uint64_t m_nbFrames        = 0;
+	uint64_t m_nbDetections    = 0;
+
+private:
+	static log4cxx::LoggerPtr m_logger;
+};
+
+} // namespace mk
+#endif
@@ -72,6 +72,7 @@ public:
 	virtual void Randomize(unsigned int& xr_seed, const mkjson& x_requirement, const cv::Size& x_size);
 
 	template<class T> inline void AddExternalInfo(const std::string& x_label, const T& x_value) {m_externalInfo[x_label] = x_value;}
+	inline const mkjson& GetExternalInfo() const {return m_externalInfo;}
 	// inline void AddExternalInfo(const std::string& x_label, const std::string& x_value) {m_externalInfo[x_label] = x_value;}
 	// inline void AddExternalInfo(const std::string& x_label, double x_value) {m_externalInfo[x_label] = x_value;}
 	// inline void AddExternalInfo(const std::string& x_label, int x_value) {m_externalInfo[x_label] = x_value;}
@@ -72,10 +72,12 @@ void Factories::RegisterAll()
 	REGISTER_FEATURE(FeatureFloatInTime, "FeatureFloatInTime");
 	REGISTER_FEATURE(FeatureVectorFloat, "FeatureVectorFloat");
 	REGISTER_FEATURE(FeatureVectorInt, "FeatureVectorInt");
+	REGISTER_FEATURE(FeatureVectorUChar, "FeatureVectorUChar");
 	REGISTER_FEATURE(FeatureString, "FeatureString");
 	REGISTER_FEATURE(FeatureKeyPoint, "FeatureKeyPoint");
 	REGISTER_FEATURE(FeaturePoint2f, "FeaturePoint2f");
 	REGISTER_FEATURE(FeaturePoint3f, "FeaturePoint3f");
+	REGISTER_FEATURE(FeatureBinaryDescriptor, "FeatureBinaryDescriptor");
 	REGISTER_FEATURE(FeatureHistory, "FeatureHistory");
 	// REGISTER_FEATURE(FeatureMat, "FeatureMat"); // Experimental
 
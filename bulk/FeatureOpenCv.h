@@ -37,6 +37,7 @@ namespace mk {
 typedef FeatureT<cv::KeyPoint>	  FeatureKeyPoint;
 typedef FeatureT<cv::Point2f>	  FeaturePoint2f;
 typedef FeatureT<cv::Point3f>	  FeaturePoint3f;
+typedef FeatureT<BinaryDescriptor> FeatureBinaryDescriptor;
 // typedef FeatureT<cv::Mat>	  FeatureMat;
 } // namespace mk
 #endif
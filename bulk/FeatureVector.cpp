@@ -41,4 +41,19 @@ template<>void FeatureVectorT<int>::Deserialize(const mkjson& x_json)
 		throw MkException("Wrong feature vector type " + x_json.at("type").get<string>(), LOC);
 	values = x_json.at("values").get<vector<int>>();
 }
+
+template<>void FeatureVectorT<uchar>::Serialize(mkjson& rx_json) const
+{
+	rx_json = mkjson{
+		{"type", "uchar"},
+		{"values", values}
+	};
+}
+
+template<>void FeatureVectorT<uchar>::Deserialize(const mkjson& x_json)
+{
+	if(x_json.at("type").get<string>() != "uchar")
+		throw MkException("Wrong feature vector type " + x_json.at("type").get<string>(), LOC);
+	values = x_json.at("values").get<vector<uchar>>();
+}
 } // namespace mk
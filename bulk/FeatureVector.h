@@ -66,11 +66,14 @@ public:
 
 template<>void FeatureVectorT<int>::Serialize(mkjson& rx_json) const;
 template<>void FeatureVectorT<int>::Deserialize(const mkjson& x_json);
+template<>void FeatureVectorT<uchar>::Serialize(mkjson& rx_json) const;
+template<>void FeatureVectorT<uchar>::Deserialize(const mkjson& x_json);
 
 
 // Definitions
 typedef FeatureVectorT<float>   FeatureVectorFloat;
 typedef FeatureVectorT<int>   FeatureVectorInt;
+typedef FeatureVectorT<uchar> FeatureVectorUChar;
 
 
 } // namespace mk
@@ -0,0 +1,267 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "ImageEncoder.h"
+#include <fstream>
+#include <opencv2/highgui/highgui.hpp>
+#include "MkException.h"
+#include "define.h"
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+log4cxx::LoggerPtr ImageEncoder::m_logger(log4cxx::Logger::getLogger("ImageEncoder"));
+
+// Maximal number of queued jobs per thread: if the queue is full the caller waits
+#define MAX_JOBS_PER_THREAD 16
+
+/**
+* @brief Constructor
+*
+* @param x_nbThreads Number of worker threads. If 0, images are encoded synchronously in the calling thread
+*/
+ImageEncoder::ImageEncoder(int x_nbThreads)
+{
+	if(x_nbThreads < 0)
+		throw MkException("Number of threads for image encoding must be positive", LOC);
+	for(int i = 0 ; i < x_nbThreads ; i++)
+		m_threads.emplace_back(&ImageEncoder::Work, this);
+	LOG_DEBUG(m_logger, "Created image encoder with " << x_nbThreads << " threads");
+}
+
+ImageEncoder::~ImageEncoder()
+{
+	// note: remaining jobs are processed before the threads exit
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_condPush.notify_all();
+	for(auto& elem : m_threads)
+		elem.join();
+}
+
+/**
+* @brief Main loop of each worker thread
+*/
+void ImageEncoder::Work()
+{
+	// each worker owns its buffer: the allocation is reused from one image to the next
+	vector<uchar> buffer;
+	while(true)
+	{
+		Job job;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_condPush.wait(lock, [this]{return m_stop || !m_jobs.empty();});
+			if(m_jobs.empty())
+				return; // stop was requested and all jobs are done
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+			m_nbRunning++;
+		}
+		m_condPop.notify_all();
+
+		// note: exceptions are stored in the future of the job
+		job(buffer);
+
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_nbRunning--;
+		}
+		m_condPop.notify_all();
+	}
+}
+
+/**
+* @brief Queue a job for the workers or execute it if no worker exists
+*
+* @param x_job Job to execute
+* @return A future that is ready once the job has completed
+*/
+future<void> ImageEncoder::Push(Job&& x_job)
+{
+	future<void> fut = x_job.get_future();
+	unique_lock<mutex> lock(m_mutex);
+	if(m_threads.empty())
+	{
+		x_job(m_buffer);
+		return fut;
+	}
+	m_condPop.wait(lock, [this]{return m_jobs.size() < MAX_JOBS_PER_THREAD * m_threads.size();});
+	m_jobs.push_back(std::move(x_job));
+	lock.unlock();
+	m_condPush.notify_one();
+	return fut;
+}
+
+/**
+* @brief Encode an image and give the resulting bytes to a sink
+*
+* @param x_image     Image to encode (a copy is kept until the encoding is done, the caller can reuse its image)
+* @param x_extension Extension that determines the format: jpg, png or webp
+* @param x_quality   Quality of the encoding in [0-100]
+* @param x_sink      Function that receives the encoded bytes (e.g. to write a file)
+* @return A future that is ready when the sink has been called
+*/
+future<void> ImageEncoder::Encode(const Mat& x_image, const string& x_extension, int x_quality, Sink x_sink)
+{
+	Mat image = x_image.clone();
+	return Push(Job([image, x_extension, x_quality, x_sink](vector<uchar>& xr_buffer)
+	{
+		try
+		{
+			EncodeToBuffer(image, x_extension, x_quality, xr_buffer);
+			x_sink(xr_buffer);
+		}
+		catch(exception& e)
+		{
+			LOG_ERROR(m_logger, "Exception while encoding image: " << e.what());
+			throw;
+		}
+	}));
+}
+
+/**
+* @brief Encode an image and write it to a file
+*
+* @param x_image        Image to encode
+* @param x_extension    Extension that determines the format: jpg, png or webp
+* @param x_quality      Quality of the encoding in [0-100]
+* @param x_fileWithPath File to write
+* @return A future that is ready when the file is written
+*/
+future<void> ImageEncoder::Encode(const Mat& x_image, const string& x_extension, int x_quality, const string& x_fileWithPath)
+{
+	return Encode(x_image, x_extension, x_quality, [x_fileWithPath](const vector<uchar>& x_buffer)
+	{
+		WriteToFile(x_buffer, x_fileWithPath);
+	});
+}
+
+/**
+* @brief Write a text content (e.g. a JSON description) to a file asynchronously
+*
+* @param x_content      Content to write
+* @param x_fileWithPath File to write
+* @return A future that is ready when the file is written
+*/
+future<void> ImageEncoder::Write(string&& x_content, const string& x_fileWithPath)
+{
+	// note: a shared pointer is used since C++14 lambdas cannot capture by move into a copyable function
+	auto content = make_shared<string>(std::move(x_content));
+	return Push(Job([content, x_fileWithPath](vector<uchar>& /*xr_buffer*/)
+	{
+		ofstream of(x_fileWithPath);
+		if(!of.is_open())
+		{
+			LOG_ERROR(m_logger, "Impossible to create file " << x_fileWithPath);
+			throw MkException("Impossible to create file " + x_fileWithPath, LOC);
+		}
+		of << *content;
+	}));
+}
+
+/**
+* @brief Wait until all queued jobs are done
+*/
+void ImageEncoder::Flush()
+{
+	unique_lock<mutex> lock(m_mutex);
+	m_condPop.wait(lock, [this]{return m_jobs.empty() && m_nbRunning == 0;});
+}
+
+/**
+* @brief Wait for the completion of jobs. All jobs are waited for, then the first error is rethrown
+*
+* @param xr_futures Futures returned by Encode or Write, the vector is cleared
+*/
+void ImageEncoder::Wait(vector<future<void>>& xr_futures)
+{
+	exception_ptr excep;
+	for(auto& elem : xr_futures)
+	{
+		try
+		{
+			elem.get();
+		}
+		catch(...)
+		{
+			if(!excep)
+				excep = current_exception();
+		}
+	}
+	xr_futures.clear();
+	if(excep)
+		rethrow_exception(excep);
+}
+
+/**
+* @brief Encode an image to a memory buffer
+*
+* @param x_image     Image to encode
+* @param x_extension Extension that determines the format: jpg, png or webp
+* @param x_quality   Quality of the encoding in [0-100]
+* @param xr_buffer   Output buffer, its allocation is reused
+*/
+void ImageEncoder::EncodeToBuffer(const Mat& x_image, const string& x_extension, int x_quality, vector<uchar>& xr_buffer)
+{
+	if(!imencode("." + x_extension, x_image, xr_buffer, EncodingParameters(x_extension, x_quality)))
+		throw MkException("Cannot encode image to format " + x_extension, LOC);
+}
+
+/**
+* @brief Write an encoded buffer to file
+*
+* @param x_buffer       Encoded image
+* @param x_fileWithPath File to write
+*/
+void ImageEncoder::WriteToFile(const vector<uchar>& x_buffer, const string& x_fileWithPath)
+{
+	ofstream of(x_fileWithPath, ios::binary);
+	if(!of.is_open())
+		throw MkException("Impossible to create file " + x_fileWithPath, LOC);
+	of.write(reinterpret_cast<const char*>(x_buffer.data()), x_buffer.size());
+}
+
+/**
+* @brief Return the parameters to pass to OpenCV for encoding
+*
+* @param x_extension Extension that determines the format: jpg, png or webp
+* @param x_quality   Quality of the encoding in [0-100]. For png this is converted to a compression level
+* @return Encoding parameters
+*/
+vector<int> ImageEncoder::EncodingParameters(const string& x_extension, int x_quality)
+{
+	x_quality = RANGE(x_quality, 0, 100);
+	if(x_extension == "jpg" || x_extension == "jpeg")
+		return {IMWRITE_JPEG_QUALITY, x_quality};
+	if(x_extension == "png")
+		return {IMWRITE_PNG_COMPRESSION, (100 - x_quality) * 9 / 100};
+	if(x_extension == "webp")
+		return {IMWRITE_WEBP_QUALITY, max(1, x_quality)};
+	return {};
+}
+
+} // namespace mk
@@ -0,0 +1,83 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_IMAGE_ENCODER_H
+#define MK_IMAGE_ENCODER_H
+
+#include <log4cxx/logger.h>
+#include <opencv2/core/core.hpp>
+#include <boost/noncopyable.hpp>
+#include <functional>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <deque>
+#include <vector>
+
+namespace mk {
+
+/**
+* @brief A pool of worker threads used to encode images (jpg, png, webp) to memory buffers.
+*        The encoded bytes are then given to a sink (a file, a database, ...). All public methods are thread-safe.
+*/
+class ImageEncoder : boost::noncopyable
+{
+public:
+	/// A sink receives the encoded bytes. The buffer is owned by the worker and reused for the next image.
+	typedef std::function<void(const std::vector<uchar>&)> Sink;
+
+	explicit ImageEncoder(int x_nbThreads);
+	virtual ~ImageEncoder();
+
+	std::future<void> Encode(const cv::Mat& x_image, const std::string& x_extension, int x_quality, Sink x_sink);
+	std::future<void> Encode(const cv::Mat& x_image, const std::string& x_extension, int x_quality, const std::string& x_fileWithPath);
+	std::future<void> Write(std::string&& x_content, const std::string& x_fileWithPath);
+	void Flush();
+	static void Wait(std::vector<std::future<void>>& xr_futures);
+	inline int GetNbThreads() const {return static_cast<int>(m_threads.size());}
+
+	static void EncodeToBuffer(const cv::Mat& x_image, const std::string& x_extension, int x_quality, std::vector<uchar>& xr_buffer);
+	static void WriteToFile(const std::vector<uchar>& x_buffer, const std::string& x_fileWithPath);
+	static std::vector<int> EncodingParameters(const std::string& x_extension, int x_quality);
+
+protected:
+	typedef std::packaged_task<void(std::vector<uchar>&)> Job;
+	std::future<void> Push(Job&& x_job);
+	void Work();
+
+	std::vector<std::thread> m_threads;
+	std::deque<Job>          m_jobs;
+	std::mutex               m_mutex;
+	std::condition_variable  m_condPush;   // signaled when a job is queued or at destruction
+	std::condition_variable  m_condPop;    // signaled when a job is dequeued or done
+	size_t                   m_nbRunning = 0;
+	bool                     m_stop      = false;
+	std::vector<uchar>       m_buffer;     // buffer used when encoding synchronously (no thread)
+
+private:
+	static log4cxx::LoggerPtr m_logger;
+};
+
+} // namespace mk
+#endif
@@ -29,6 +29,7 @@
 #include "Module.h"
 #include "Input.h"
 #include "Stream.h"
+#include "StreamImage.h"
 #include "Event.h"
 #include "MkException.h"
 #include "ControllerManager.h"
@@ -218,9 +219,70 @@ void Manager::Connect()
 		if(!mas.is_null() && !mas.get<string>().empty())
 			RefModuleByName(mas.get<string>()).AddDependingModule(module);
 	}
+	if(m_param.fuseModules)
+		FuseModules();
 	m_isConnected = true;
 }
 
+/**
+* @brief Find the chains of fusable modules (e.g. BgrSubRunAvg -> Morph -> Mask) and fuse them: each chain is then
+*        processed by bands of rows by its first module. A module is fused with the previous one if its image input
+*        is the only consumer of the output of the previous module and if it is processed each time the previous one is.
+*/
+void Manager::FuseModules()
+{
+	map<const Module*, Stream*> previousInputs; // input of each module that is connected to the previous module of a chain
+	map<const Module*, Module*> nextModules;    // next module of each module in a chain
+	for(auto& elem : m_modules)
+	{
+		Module& module(*elem.second);
+		if(!module.IsFusable() || module.IsAutoProcessed() || module.GetFps() != 0 || module.IsCached())
+			continue;
+		const string master = module.GetParameters().GetParameterByName("master").GetValue().get<string>();
+
+		// find the only input that is connected to a fusable module
+		Stream* fusedInput = nullptr;
+		int nbCandidates   = 0;
+		for(auto& input : module.GetInputStreamList())
+		{
+			if(!input.second->IsConnected())
+				continue;
+			const Stream& output(input.second->GetConnected());
+			const Module& previous(output.GetModule());
+			if(!previous.IsFusable() || previous.IsCached())
+				continue;
+			nbCandidates++;
+			if(output.GetNbConnected() == 1 && output.GetClass() == StreamImage::className && input.second->IsBlocking()
+				&& previous.GetSize() == module.GetSize() && (master.empty() || master == previous.GetName()))
+				fusedInput = input.second;
+		}
+		if(nbCandidates != 1 || fusedInput == nullptr)
+			continue;
+
+		const Module* previous = &fusedInput->GetConnected().GetModule();
+		if(nextModules.find(previous) != nextModules.end())
+			continue;
+		previousInputs[&module] = fusedInput;
+		nextModules[previous]   = &module;
+	}
+
+	// fuse the chains, starting from their first module
+	for(auto& elem : nextModules)
+	{
+		if(previousInputs.find(elem.first) != previousInputs.end())
+			continue;
+		Module& head(RefModuleByName(elem.first->GetName()));
+		string names = head.GetName();
+		for(auto it = nextModules.find(&head) ; it != nextModules.end() ; it = nextModules.find(it->second))
+		{
+			Stream* input = previousInputs.at(it->second);
+			head.FuseWith(*it->second, input->GetConnected(), *input);
+			names += " -> " + it->second->GetName();
+		}
+		LOG_INFO(m_logger, "Fused modules " << names);
+	}
+}
+
 /**
 * @brief Check if modules are correctly connected
 *
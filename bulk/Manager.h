@@ -50,10 +50,12 @@ public:
 			AddParameter(new ParameterInt("nbFrames", 0, 0, INT_MAX, &nbFrames, "Number of frames to process. 0 for infinite. Only works in centralized mode"));
 			AddParameter(new ParameterString("arguments", "",         &arguments, "Command-line arguments, for storage only"));
 			AddParameter(new ParameterString("aspectRatio", "", &aspectRatio, "If non-empty, at creation each module width/height are changed to match this aspect ratio. E.g. \"4:3\"."));
+			AddParameter(new ParameterBool("fuseModules", false, &fuseModules, "Fuse chains of pixel modules (e.g. BgrSubRunAvg, Morph, Mask): a chain is processed by bands of rows so that the intermediate images stay in cache"));
 		}
 		int nbFrames;
 		std::string arguments; // note: This is used in simulations, see what to do in normal case
 		std::string aspectRatio;
+		bool fuseModules;
 		mkconf config;
 	};
 
@@ -144,6 +146,7 @@ private:
 
 	Module& RefModuleByName(const std::string& x_name) const;
 	void ConnectInput(const mkconf& x_inputConfig, Module& xr_module, const std::string& x_input) const;
+	void FuseModules();
 
 	int64_t m_frameCount = 0;
 	bool m_isConnected   = false;
@@ -26,11 +26,17 @@
 #include "util.h"
 #include "json.hpp"
 #include "Stream.h"
+#include "StreamImage.h"
 #include "Timer.h"
 #include "ModuleTimer.h"
 #include "ControllerModule.h"
 #include "Factories.h"
 
+// Minimal number of rows of a tile: smaller tiles are not worth the overhead
+#define MIN_TILE_ROWS 32
+// Number of rows processed at once by the first module of a fused chain
+#define FUSION_BAND_ROWS 16
+
 namespace mk {
 using namespace std;
 using namespace mk;
@@ -71,6 +77,7 @@ void Module::Reset()
 	LOG_INFO(m_logger, "Reseting module " << GetName() << " of class " << GetClass());
 	Processable::Reset();
 	m_nbReset++;
+	m_processedByFusion = false;
 
 	// note: The input streams must never be reset since this would be incoherent with the 
 	//       behavior of parameters. Reseting them would erase the current value and set them to default.
@@ -101,6 +108,147 @@ void Module::Reset()
 }
 
 
+/**
+* @brief Return the number of tiles used by ProcessTiles: this depends on the number of threads and on the image height
+*/
+int Module::GetNbTiles() const
+{
+	return max(1, min(cv::getNumThreads(), m_param.height / MIN_TILE_ROWS));
+}
+
+/**
+* @brief Process the image by horizontal tiles in parallel. The function must only write inside the roi of its tile.
+*        Threads are taken from the pool of OpenCV, shared with the rest of the application.
+*
+* @param x_function Function that processes one tile
+* @param x_halo     Number of neighbouring rows needed by the function to process a tile (e.g. for a filter)
+*/
+void Module::ProcessTiles(const function<void(const Tile&)>& x_function, int x_halo)
+{
+	int nbTiles = GetNbTiles();
+	if(nbTiles == 1)
+	{
+		Tile tile{0, cv::Rect(0, 0, m_param.width, m_param.height), cv::Rect(0, 0, m_param.width, m_param.height)};
+		x_function(tile);
+		return;
+	}
+	// note: the tiles are only computed again if the configuration has changed
+	if(static_cast<int>(m_tiles.size()) != nbTiles || m_tilesHalo != x_halo)
+	{
+		m_tiles     = splitInStripes(GetSize(), nbTiles, x_halo);
+		m_tilesHalo = x_halo;
+	}
+	parallelForEach(m_tiles.size(), [this, &x_function](int i){x_function(m_tiles[i]);});
+}
+
+/**
+* @brief Process the frame by tiles in parallel with the methods of fusable modules (BeginTiles, ProcessTile, EndTiles)
+*/
+void Module::ProcessFrameByTiles()
+{
+	BeginTiles();
+	ProcessTiles([this](const Tile& x_tile){ProcessTile(x_tile);}, GetTileHalo());
+	EndTiles();
+}
+
+/**
+* @brief Fuse the next module of a chain with this one: the chain is then processed by this module.
+*        Must be called on the first module of the chain. See Manager::FuseModules
+*
+* @param xr_next   Next module of the chain
+* @param x_output  Output stream of the last module of the chain
+* @param xr_input  Input of the next module, connected to x_output
+*/
+void Module::FuseWith(Module& xr_next, const Stream& x_output, Stream& xr_input)
+{
+	const auto* output = dynamic_cast<const StreamImage*>(&x_output);
+	auto* input        = dynamic_cast<StreamImage*>(&xr_input);
+	if(output == nullptr || input == nullptr)
+		throw MkException("Only image streams can be fused: " + x_output.GetName() + " and " + xr_input.GetName(), LOC);
+	if(!xr_next.IsFusable() || xr_next.IsFused() || m_isFusedWithPrevious)
+		throw MkException("Module " + xr_next.GetName() + " cannot be fused with " + GetName(), LOC);
+
+	m_fusedModules.push_back(FusedModule{&xr_next, &x_output, &output->GetImage(), &input->RefImage()});
+	xr_next.m_isFusedWithPrevious = true;
+}
+
+/**
+* @brief Process the chain of fused modules, band by band: each module processes the rows for which the rows
+*        of its input (with the halo) are ready. The intermediate images are only accessed by bands that stay in cache.
+*        Fusion falls back to the normal processing if an intermediate stream got another consumer (e.g. a viewer)
+*        or if the input of a module cannot be copied without conversion.
+*
+* @return True if the chain was processed
+*/
+bool Module::ProcessFusedModules()
+{
+	for(const auto& elem : m_fusedModules)
+	{
+		if(elem.outputStream->GetNbConnected() != 1 || elem.output->cols != GetWidth() || elem.output->rows != GetHeight()
+			|| elem.input->size() != elem.output->size() || elem.input->type() != elem.output->type() || elem.module->GetSize() != GetSize())
+			return false;
+
+		// note: other inputs must be synchronized with the chain to be read now
+		for(const auto& input : elem.module->m_inputStreams)
+		{
+			if(input.second->IsConnected() && &input.second->GetConnected() != elem.outputStream
+				&& input.second->IsSynchronized() && input.second->GetTimeStampConnected() != m_currentTimeStamp)
+				return false;
+		}
+	}
+
+	vector<Module*> chain{this};
+	for(auto& elem : m_fusedModules)
+	{
+		for(auto& input : elem.module->m_inputStreams)
+		{
+			if(input.second->IsConnected() && &input.second->GetConnected() != elem.outputStream)
+				input.second->ConvertInput();
+		}
+		chain.push_back(elem.module);
+	}
+	for(auto& elem : chain)
+		elem->BeginTiles();
+
+	const int width  = GetWidth();
+	const int height = GetHeight();
+	vector<int> done(chain.size(), 0);   // number of rows processed by each module
+	vector<int> copied(chain.size(), 0); // number of rows copied to the input of each module
+	while(done.back() < height)
+	{
+		for(size_t i = 0 ; i < chain.size() ; i++)
+		{
+			int end = min(height, done.at(0) + FUSION_BAND_ROWS);
+			int halo = chain[i]->GetTileHalo();
+			if(i > 0)
+			{
+				// copy the new rows of the previous module to the input of this one
+				const FusedModule& fused(m_fusedModules.at(i - 1));
+				if(done.at(i - 1) > copied.at(i))
+				{
+					cv::Rect rows(0, copied.at(i), width, done.at(i - 1) - copied.at(i));
+					(*fused.output)(rows).copyTo((*fused.input)(rows));
+					copied.at(i) = done.at(i - 1);
+				}
+				end = copied.at(i) == height ? height : copied.at(i) - halo;
+			}
+			if(end <= done.at(i))
+				continue;
+			int top    = max(0, done.at(i) - halo);
+			int bottom = min(height, end + halo);
+			Tile tile{0, cv::Rect(0, done.at(i), width, end - done.at(i)), cv::Rect(0, top, width, bottom - top)};
+			chain[i]->ProcessTile(tile);
+			done.at(i) = end;
+		}
+	}
+
+	for(auto& elem : chain)
+		elem->EndTiles();
+	for(auto& elem : m_fusedModules)
+		elem.module->m_processedByFusion = true;
+	return true;
+}
+
 /**
 * @brief Return the fps that can be used for recording. This value is special as it depends from preceeding modules.
 *
@@ -204,6 +352,10 @@ void Module::ComputeCurrentTimeStamp()
 void Module::Process()
 {
 	m_timerWaiting.Start();
+	// note: the flag is only valid for the call that follows the processing of the fused chain, even if this call
+	//       returns early (e.g. paused or not synchronized)
+	const bool processedByFusion = m_processedByFusion;
+	m_processedByFusion = false;
 	// WriteLock lock(RefLock());
 	try
 	{
@@ -217,7 +369,11 @@ void Module::Process()
 		m_timerWaiting.Stop();
 
 		// note: Inputs must call ProcessFrame to set the time stamp
-		if(m_param.cached < CachedState::READ_CACHE || IsInput())
+		if(processedByFusion)
+		{
+			// note: the frame was already processed by the first module of the fused chain
+		}
+		else if(m_param.cached < CachedState::READ_CACHE || IsInput())
 		{
 			m_timerConversion.Start();
 			// Read and convert inputs
@@ -232,7 +388,8 @@ void Module::Process()
 			m_timerConversion.Stop();
 			m_timerProcessFrame.Start();
 
-			ProcessFrame();
+			if(m_fusedModules.empty() || !ProcessFusedModules())
+				ProcessFrame();
 
 			m_timerProcessFrame.Stop();
 		}
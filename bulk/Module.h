@@ -32,6 +32,7 @@
 #include "Timer.h"
 #include "enums.h"
 #include "ParameterEnumT.h"
+#include "Tiles.h"
 
 #define MAX_WIDTH  6400
 #define MAX_HEIGHT 4800
@@ -125,6 +126,7 @@ public:
 	inline int GetImageType() const      {return m_param.type;}
 	inline double GetFps() const         {return m_param.fps;}
 	inline bool IsAutoProcessed() const  {return m_param.autoProcess;}
+	inline bool IsCached() const         {return m_param.cached != CachedState::NO_CACHE;}
 	double GetRecordingFps() const override;
 
 	/// Add a module to the list: depending modules are called when processing is complete
@@ -149,6 +151,11 @@ public:
 	void WriteToCache() const;
 	void ReadFromCache();
 
+	// Fusion of modules: a chain of pixel modules is processed by bands of rows by its first module
+	virtual bool IsFusable() const {return false;}  /// Return true if the module implements ProcessTile. To be overridden
+	void FuseWith(Module& xr_next, const Stream& x_output, Stream& xr_input);
+	inline bool IsFused() const {return !m_fusedModules.empty() || m_isFusedWithPrevious;}
+
 protected:
 	void Reset() override;
 	void Process() override;
@@ -171,6 +178,17 @@ protected:
 	virtual void ProcessFrame() = 0;
 	inline virtual bool IsInputProcessed() const {return true;}
 
+	// Processing of the image by tiles in parallel: for modules that operate on pixels or small neighbourhoods
+	int GetNbTiles() const;
+	void ProcessTiles(const std::function<void(const Tile&)>& x_function, int x_halo = 0);
+
+	// Processing by tiles for fusable modules: ProcessFrame calls ProcessFrameByTiles
+	void ProcessFrameByTiles();
+	virtual int GetTileHalo() const {return 0;}                  /// Number of neighbouring rows needed to process a tile
+	virtual void BeginTiles() {}                                 /// Called once per frame before the tiles are processed
+	virtual void ProcessTile(const Tile& /*x_tile*/) {}          /// Process one tile, only write inside the roi of the tile
+	virtual void EndTiles() {}                                   /// Called once per frame after all tiles are processed
+
 	// Streams
 	std::map<std::string, Stream *> m_inputStreams;
 	std::map<std::string, Stream *> m_outputStreams;
@@ -181,6 +199,21 @@ protected:
 private:
 	Parameters& m_param;
 	static log4cxx::LoggerPtr m_logger;
+	std::vector<Tile> m_tiles;
+	int m_tilesHalo = 0;
+
+	/// A module fused with the previous one in the chain: the output of the previous module is copied band by band
+	struct FusedModule
+	{
+		Module*       module;
+		const Stream* outputStream;
+		const cv::Mat* output;
+		cv::Mat*       input;
+	};
+	bool ProcessFusedModules();
+	std::vector<FusedModule> m_fusedModules;
+	bool m_isFusedWithPrevious = false;
+	bool m_processedByFusion   = false;
 };
 
 } // namespace mk
@@ -23,6 +23,9 @@
 #include "ModulePython.h"
 #include "FeatureVector.h"
 #include "FeatureStd.h"
+#include "Object.h"
+#include <typeinfo>
+#include <algorithm>
 
 namespace mk {
 using namespace cv;
@@ -32,57 +35,47 @@ using namespace boost::python;
 ModulePython::OncePython ModulePython::oncePython;
 log4cxx::LoggerPtr ModulePython::m_logger(log4cxx::Logger::getLogger("ModulePython"));
 
-/// Convert cv::Mat to Python: https://misspent.wordpress.com/2009/09/27/how-to-write-boost-python-converters/
+/**
+* @brief Convert cv::Mat to Python: https://misspent.wordpress.com/2009/09/27/how-to-write-boost-python-converters/
+*        The matrix is given as a numpy array of shape (rows, cols) or (rows, cols, channels) that is a view on the
+*        data of the matrix: no copy is done, the array is only valid during the call to Python.
+*/
 PyObject* ModulePython::MatToPython::convert(cv::Mat const& x_mat)
 {
-	assert(x_mat.type() == CV_8UC1);
-	PyObject *mylist = PyList_New(x_mat.cols * x_mat.rows);
-	assert(mylist);
-	int k = 0;
-	for (int i = 0; i < x_mat.rows; i++)
-	{
-		for (int j = 0; j < x_mat.cols; j++)
-		{
-			PyList_SET_ITEM(mylist, k++, PyInt_FromLong(x_mat.at<uchar>(i, j)));// PyInt_FromLong(array[x_mat.step[0] * i + j]));
-		}
-	}
-	// Py_BuildValue("[i]", mylist);
-	return mylist; // boost::python::incref(mylist);
+	object numpy = boost::python::import("numpy");
+	// note: the last row of a submatrix may end before the step
+	const size_t size = x_mat.empty() ? 0 : x_mat.step[0] * (x_mat.rows - 1) + x_mat.cols * x_mat.elemSize();
+#if PY_MAJOR_VERSION >= 3
+	object buffer(handle<>(PyMemoryView_FromMemory(reinterpret_cast<char*>(x_mat.data), size, PyBUF_WRITE)));
+#else
+	object buffer(handle<>(PyBuffer_FromReadWriteMemory(x_mat.data, size)));
+#endif
+	boost::python::tuple shape   = x_mat.channels() == 1
+		? boost::python::make_tuple(x_mat.rows, x_mat.cols)
+		: boost::python::make_tuple(x_mat.rows, x_mat.cols, x_mat.channels());
+	boost::python::tuple strides = x_mat.channels() == 1
+		? boost::python::make_tuple(x_mat.step[0], x_mat.elemSize())
+		: boost::python::make_tuple(x_mat.step[0], x_mat.elemSize(), x_mat.elemSize1());
+	object array = numpy.attr("ndarray")(shape, numpy.attr("dtype")(numpyType(x_mat.depth())), buffer, 0, strides);
+	return boost::python::incref(array.ptr());
 }
 
-/// Convert FeatureList to Python
+/// Convert FeatureList to Python: a numpy array of floats
 PyObject* ModulePython::FeatureListToPython::convert(ModulePython::FeatureList const& x_list)
 {
-	PyObject *mylist = PyList_New(x_list.GetNumberOfFeatures());
-	int cpt = 0;
+	Mat row(1, x_list.GetNumberOfFeatures(), CV_32F);
+	float* out = row.ptr<float>();
 	for (const auto & featureName : x_list.featureNames)
 	{
 		// Retrieve the feature with the given name
 		auto feat = x_list.features.find(featureName);
 		if(feat == x_list.features.end())
 			throw MkException("Feature " + featureName + " not found in input object", LOC);
-
-		//LOG_DEBUG(m_logger, "Add feature "<<featureName<<" to Python arguments: "<<*feat->second);
-		const FeatureFloat* pff = dynamic_cast<const FeatureFloat*>(&*feat->second);
-		if(pff != nullptr)
-		{
-			PyList_SET_ITEM(mylist, cpt, PyFloat_FromDouble(pff->value));
-			cpt++;
-		}
-		else
-		{
-			const FeatureVectorFloat* pff = dynamic_cast<const FeatureVectorFloat*>(&*feat->second);
-			if(pff == nullptr)
-				throw MkException("Feature " + featureName + " must inherit from FeatureFloat or FeatureVectorFloat", LOC);
-			for(auto val : pff->values)
-			{
-				PyList_SET_ITEM(mylist, cpt, PyFloat_FromDouble(val));
-				cpt++;
-			}
-		}
+		out = CopyFeature(*feat->second, out);
 	}
-	// Py_BuildValue("[d]", mylist);
-	return mylist;// boost::python::incref(mylist);
+	// note: the array must own its data since the matrix is temporary
+	object array(handle<>(MatToPython::convert(row)));
+	return boost::python::incref(array.attr("copy")().ptr());
 }
 
 int ModulePython::FeatureList::GetNumberOfFeatures() const
@@ -94,18 +87,82 @@ int ModulePython::FeatureList::GetNumberOfFeatures() const
 		auto feat = features.find(featureName);
 		if(feat == features.end())
 			throw MkException("Feature " + featureName + " not found in input object", LOC);
-		const FeatureFloat* pff = dynamic_cast<const FeatureFloat*>(&*feat->second);
-		if(pff != nullptr)
-		{
-			cnt++;
-		}
-		else
+		cnt += FeatureSize(*feat->second, featureName);
+	}
+	return cnt;
+}
+
+/// Number of values of a feature, it must inherit from FeatureFloat or FeatureVectorFloat
+int ModulePython::FeatureSize(const Feature& x_feature, const string& x_name)
+{
+	if(dynamic_cast<const FeatureFloat*>(&x_feature) != nullptr)
+		return 1;
+	const FeatureVectorFloat* pfv = dynamic_cast<const FeatureVectorFloat*>(&x_feature);
+	if(pfv == nullptr)
+		throw MkException("Feature " + x_name + " must inherit from FeatureFloat or FeatureVectorFloat", LOC);
+	return pfv->values.size();
+}
+
+/// Copy the values of a feature, the type must have been checked with FeatureSize. Return the end of the copied values
+float* ModulePython::CopyFeature(const Feature& x_feature, float* xp_out)
+{
+	const FeatureFloat* pff = dynamic_cast<const FeatureFloat*>(&x_feature);
+	if(pff != nullptr)
+	{
+		*xp_out = pff->value;
+		return xp_out + 1;
+	}
+	const vector<float>& values(static_cast<const FeatureVectorFloat&>(x_feature).values);
+	return copy(values.begin(), values.end(), xp_out);
+}
+
+/**
+* @brief Copy the features of all objects in one matrix, to give them to Python at once. The GIL is not needed
+*
+* @param x_objects      Objects
+* @param x_featureNames Names of the features, in the order of columns
+* @param xr_matrix      Matrix of floats: one row per object
+*/
+void ModulePython::FeaturesToMatrix(const vector<Object>& x_objects, const vector<string>& x_featureNames, Mat& xr_matrix)
+{
+	if(x_objects.empty())
+	{
+		xr_matrix.create(0, 0, CV_32F);
+		return;
+	}
+	// note: the type and size of each feature are given by the first object, this avoids casts for the other objects
+	struct Column
+	{
+		const type_info* type;
+		bool isFloat;
+		int size;
+	};
+	vector<Column> columns;
+	int cols = 0;
+	for(const auto& name : x_featureNames)
+	{
+		const Feature& feature(x_objects.front().GetFeature(name));
+		const int size = FeatureSize(feature, name);
+		columns.push_back(Column{&typeid(feature), dynamic_cast<const FeatureFloat*>(&feature) != nullptr, size});
+		cols += size;
+	}
+	xr_matrix.create(x_objects.size(), cols, CV_32F);
+
+	for(size_t i = 0 ; i < x_objects.size() ; i++)
+	{
+		float* out = xr_matrix.ptr<float>(i);
+		for(size_t j = 0 ; j < columns.size() ; j++)
 		{
-			const FeatureVectorFloat* pff = dynamic_cast<const FeatureVectorFloat*>(&*feat->second);
-			if(pff != nullptr) cnt+= pff->values.size();
+			const Feature& feature(x_objects[i].GetFeature(x_featureNames[j]));
+			const Column& column(columns[j]);
+			if(typeid(feature) != *column.type || (!column.isFloat && static_cast<const FeatureVectorFloat&>(feature).values.size() != static_cast<size_t>(column.size)))
+				throw MkException("Feature " + x_featureNames[j] + " of object " + to_string(i) + " differs in type or size from the first object", LOC);
+			if(column.isFloat)
+				*out++ = static_cast<const FeatureFloat&>(feature).value;
+			else
+				out = CopyFeature(feature, out);
 		}
 	}
-	return cnt;
 }
 
 ModulePython::OncePython::OncePython()
@@ -119,10 +176,20 @@ ModulePython::ModulePython(ParameterStructure& xr_params) :
 	Module(xr_params),
 	m_param(dynamic_cast<Parameters&>(xr_params))
 {
+	if(m_param.nbProcesses > 0)
+	{
+		// note: the interpreter of markus is not used
+		LOG_DEBUG(m_logger, "Run Python file " << m_param.script << " in " << m_param.nbProcesses << " worker processes");
+		mp_pool.reset(new PythonWorkerPool(m_param.nbProcesses, Size(m_param.width, m_param.height), m_param.type, m_param.python,
+			m_param.scriptPath, m_param.script, m_param.function, m_param.timeout));
+		return;
+	}
+
+	LOG_DEBUG(m_logger, "Initialize module from Python file " << m_param.script);
+	InitPython();
+	ScopedGil gil;
 	try
 	{
-		LOG_DEBUG(m_logger, "Initialize module from Python file " << m_param.script);
-		oncePython.Init();
 
 		// Change working directory (for python)
 		char pwd[256];
@@ -130,8 +197,9 @@ ModulePython::ModulePython(ParameterStructure& xr_params) :
 		if(res == nullptr)
 			throw MkException("Change of working dir to " + string(pwd) + " failed", LOC);
 
+		// note: each module runs its script in its own namespace, so that scripts do not override the functions of each other
 		m_pyMain    = boost::python::import("__main__");
-		m_pyGlobals = m_pyMain.attr("__dict__");
+		m_pyGlobals = m_pyMain.attr("__dict__").attr("copy")();
 
 		stringstream ss;
 		ss << "import sys\n" 
@@ -143,6 +211,9 @@ ModulePython::ModulePython(ParameterStructure& xr_params) :
 	catch(...)
 	{
 		PyErr_Print();
+		m_pyModule  = object();
+		m_pyGlobals = object();
+		m_pyMain    = object();
 		throw MkException("Error in initialization of ModulePython with script " + m_param.script, LOC);
 	}
 
@@ -151,6 +222,13 @@ ModulePython::ModulePython(ParameterStructure& xr_params) :
 
 ModulePython::~ModulePython()
 {
+	if(mp_pool != nullptr)
+		return;
+	// note: Python objects must be released with the lock
+	ScopedGil gil;
+	m_pyModule  = object();
+	m_pyGlobals = object();
+	m_pyMain    = object();
 }
 
 void ModulePython::Reset()
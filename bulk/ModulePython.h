@@ -25,14 +25,20 @@
 #define MODULE_PYTHON_H
 
 #include <boost/python.hpp>
+#include <memory>
 #include "Module.h"
+#include "PythonWorkerPool.h"
 
 namespace mk {
 class FeaturePtr;
+class Feature;
+class Object;
 
 /**
-* @brief This class is a parent class for all module of keypoint extraction
-* http://docs.opencv.org/modules/features2d/doc/common_interfaces_of_feature_detectors.html
+* @brief This class is a parent class for all modules that call a Python script. Images are given to Python as numpy
+*        arrays that share the data of the matrix (no copy) and the features of all objects as one matrix.
+*        The global interpreter lock is only held while Python code runs: calls to Python must be done in the scope
+*        of a ScopedGil.
 */
 class ModulePython : public Module
 {
@@ -42,19 +48,37 @@ class ModulePython : public Module
 		OncePython();
 		void Init()
 		{
-			if(!m_initialized)
-				Py_Initialize();
+			if(m_initialized)
+				return;
+			Py_Initialize();
+			PyEval_InitThreads();
+			// note: the lock is released, it is acquired by each thread that calls Python
+			mp_mainState = PyEval_SaveThread();
 			m_initialized = true;
 		}
 		~OncePython()
 		{
-			if(m_initialized)
-				Py_Finalize();
+			if(!m_initialized)
+				return;
+			PyEval_RestoreThread(mp_mainState);
+			Py_Finalize();
 		}
 	protected:
 		bool m_initialized = false;
+		PyThreadState* mp_mainState = nullptr;
 	};
 protected:
+	/// Hold the global interpreter lock of Python in a scope
+	class ScopedGil final
+	{
+	public:
+		ScopedGil() : m_state(PyGILState_Ensure()) {}
+		~ScopedGil() {PyGILState_Release(m_state);}
+		ScopedGil(const ScopedGil&) = delete;
+		ScopedGil& operator = (const ScopedGil&) = delete;
+	private:
+		PyGILState_STATE m_state;
+	};
 
 	/// A struct representing a list of features and the names of features to use (for use in method calls)
 	struct FeatureList
@@ -67,7 +91,7 @@ protected:
 		const std::vector<std::string>& featureNames;
 	};
 
-	// Conversion structures
+	// Conversion structures: the GIL must be held
 	struct MatToPython
 	{
 		static PyObject* convert(cv::Mat const& x_mat);
@@ -85,9 +109,17 @@ public:
 		{
 			AddParameter(new ParameterString("scriptPath",  "python_dir", &scriptPath, "Path to the folder containing python scripts"));
 			AddParameter(new ParameterString("script", 	     "script.py",  &script,     "Name of the Python script (without .py)"));
+			AddParameter(new ParameterInt("nbProcesses",    0, 0, 64,     &nbProcesses, "Number of worker processes that run the script. Images are given through shared memory and results are returned asynchronously (0: the script runs in markus)"));
+			AddParameter(new ParameterString("function",    "process",    &function,    "Function of the script called by the worker processes with the image and the objects"));
+			AddParameter(new ParameterString("python",      "python",     &python,      "Python executable of the worker processes"));
+			AddParameter(new ParameterDouble("timeout",     10, 0, 3600,  &timeout,     "Maximal time of the script for one image in a worker process [s], the worker is then restarted (0: no limit)"));
 		};
 		std::string scriptPath;
 		std::string script;
+		int nbProcesses;
+		std::string function;
+		std::string python;
+		double timeout;
 	};
 
 	explicit ModulePython(ParameterStructure& xr_params);
@@ -101,6 +133,10 @@ private:
 protected:
 	void ProcessFrame() override = 0;
 	void Reset() override;
+	static void InitPython() {oncePython.Init();} /// Initialize the interpreter of markus, once for all modules
+	static int FeatureSize(const Feature& x_feature, const std::string& x_name);
+	static float* CopyFeature(const Feature& x_feature, float* xp_out);
+	static void FeaturesToMatrix(const std::vector<Object>& x_objects, const std::vector<std::string>& x_featureNames, cv::Mat& xr_matrix);
 
 	// input
 
@@ -110,6 +146,7 @@ protected:
 	boost::python::object m_pyMain;
 	boost::python::object m_pyGlobals;
 	boost::python::object m_pyModule;
+	std::unique_ptr<PythonWorkerPool> mp_pool; // only if the script runs in worker processes
 };
 
 
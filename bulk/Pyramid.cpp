@@ -0,0 +1,93 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "Pyramid.h"
+#include "Tiles.h"
+#include "MkException.h"
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+/**
+* @brief Build the pyramid of an image. All levels are resized from level 0 in parallel. The buffers of the levels are
+*        reused from one frame to the next, so that modules holding the levels keep pointing to the current frame.
+*
+* @param x_image       Original image
+* @param x_scaleFactor Ratio between the sizes of two consecutive levels
+* @param x_minSize     Minimal size of a level
+* @param x_maxLevels   Maximal number of levels
+* @param x_equalize    Equalize the histogram of the image (only for CV_8UC1)
+*/
+void Pyramid::Build(const Mat& x_image, double x_scaleFactor, const Size& x_minSize, int x_maxLevels, bool x_equalize)
+{
+	if(x_scaleFactor <= 1)
+		throw MkException("The scale factor of a pyramid must be greater than 1", LOC);
+	if(x_equalize && x_image.type() != CV_8UC1)
+		throw MkException("Only images of type CV_8UC1 can be equalized", LOC);
+
+	m_scaleFactor = x_scaleFactor;
+	m_scales.clear();
+	for(double scale = 1 ; static_cast<int>(m_scales.size()) < x_maxLevels ; scale *= x_scaleFactor)
+	{
+		if(cvRound(x_image.cols / scale) < x_minSize.width || cvRound(x_image.rows / scale) < x_minSize.height)
+			break;
+		m_scales.push_back(scale);
+	}
+	m_levels.resize(m_scales.size());
+	if(m_levels.empty())
+		return;
+
+	if(x_equalize)
+		equalizeHist(x_image, m_levels[0]);
+	else
+		x_image.copyTo(m_levels[0]);
+
+	parallelForEach(m_levels.size() - 1, [this](int i){
+		const Mat& original(m_levels[0]);
+		Size size(cvRound(original.cols / m_scales[i + 1]), cvRound(original.rows / m_scales[i + 1]));
+		resize(original, m_levels[i + 1], size, 0, 0, INTER_LINEAR);
+	});
+}
+
+void to_json(mkjson& _json, const Pyramid& _ser)
+{
+	// note: for simplicity, we only serialize the sizes of levels
+	_json = mkjson{{"scaleFactor", _ser.m_scaleFactor}, {"levels", mkjson::array()}};
+	for(size_t i = 0 ; i < _ser.m_levels.size() ; i++)
+		_json["levels"].push_back(mkjson{{"width", _ser.m_levels[i].cols}, {"height", _ser.m_levels[i].rows}, {"scale", _ser.m_scales[i]}});
+}
+
+void from_json(const mkjson& _json, Pyramid& _ser)
+{
+	_ser.m_scaleFactor = _json.at("scaleFactor").get<double>();
+	_ser.m_levels.clear();
+	_ser.m_scales.clear();
+	for(const auto& elem : _json.at("levels"))
+	{
+		_ser.m_levels.push_back(Mat::zeros(elem.at("height").get<int>(), elem.at("width").get<int>(), CV_8UC1));
+		_ser.m_scales.push_back(elem.at("scale").get<double>());
+	}
+}
+} // namespace mk
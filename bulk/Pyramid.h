@@ -0,0 +1,57 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_PYRAMID_H
+#define MK_PYRAMID_H
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "serialize.h"
+
+namespace mk {
+/**
+* @brief A pyramid of scaled images, built once per frame and shared by reference by all modules that need to scan
+*        an image at several scales (e.g. detectors). Level 0 has the size of the original image.
+*/
+class Pyramid
+{
+public:
+	friend void to_json(mkjson& _json, const Pyramid& _ser);
+	friend void from_json(const mkjson& _json, Pyramid& _ser);
+
+	void Build(const cv::Mat& x_image, double x_scaleFactor, const cv::Size& x_minSize, int x_maxLevels, bool x_equalize);
+
+	inline size_t GetNbLevels() const {return m_levels.size();}
+	inline const cv::Mat& GetLevel(size_t x_index) const {return m_levels.at(x_index);}
+	/// Scale of a level: size of the original image divided by the size of the level
+	inline double GetScale(size_t x_index) const {return m_scales.at(x_index);}
+	inline double GetScaleFactor() const {return m_scaleFactor;}
+
+protected:
+	std::vector<cv::Mat> m_levels;
+	std::vector<double> m_scales;
+	double m_scaleFactor = 1;
+};
+
+} // namespace mk
+#endif
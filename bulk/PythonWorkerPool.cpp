@@ -0,0 +1,371 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "PythonWorkerPool.h"
+#include "MkException.h"
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <algorithm>
+
+// number of consecutive failures of workers before giving up
+#define MAX_FAILURES_PER_WORKER 10
+
+namespace mk {
+using namespace std;
+using namespace cv;
+namespace bip = boost::interprocess;
+
+log4cxx::LoggerPtr PythonWorkerPool::m_logger(log4cxx::Logger::getLogger("PythonWorkerPool"));
+
+/// Script run by each worker: arguments are the shared memory, the script path, the script and the function
+static const char* BOOTSTRAP = R"(
+import sys, os, json, mmap, numpy
+shmName, path, script, function = sys.argv[1:5]
+# note: the requests use stdin and stdout, the prints of the script go to stderr
+channelIn  = os.fdopen(os.dup(0), 'r')
+channelOut = os.fdopen(os.dup(1), 'w')
+os.dup2(2, 1)
+sys.path.append(path)
+scope = {'__name__': '__markus_worker__'}
+exec(compile(open(script).read(), script, 'exec'), scope)
+func = scope[function]
+shm = mmap.mmap(os.open('/dev/shm/' + shmName.lstrip('/'), os.O_RDWR), 0)
+for line in iter(channelIn.readline, ''):
+    request = json.loads(line)
+    answer = {'timestamp': request['timestamp']}
+    try:
+        shape = (request['rows'], request['cols']) if request['channels'] == 1 else (request['rows'], request['cols'], request['channels'])
+        image = numpy.ndarray(shape, dtype=request['dtype'], buffer=shm, offset=request['offset'])
+        answer['result'] = func(image, request['objects'])
+    except Exception as e:
+        answer['error'] = repr(e)
+    channelOut.write(json.dumps(answer) + '\n')
+    channelOut.flush()
+)";
+
+/// Name of the numpy type of a depth of OpenCV
+const char* numpyType(int x_depth)
+{
+	switch(x_depth)
+	{
+		case CV_8U:  return "uint8";
+		case CV_8S:  return "int8";
+		case CV_16U: return "uint16";
+		case CV_16S: return "int16";
+		case CV_32S: return "int32";
+		case CV_32F: return "float32";
+		case CV_64F: return "float64";
+		default: throw MkException("Unsupported depth of matrix for Python: " + to_string(x_depth), LOC);
+	}
+}
+
+/**
+* @brief Constructor: the shared memory is created and the workers are started
+*
+* @param x_nbWorkers  Number of worker processes
+* @param x_maxSize    Maximal size of images
+* @param x_type       Type of images
+* @param x_python     Python executable
+* @param x_scriptPath Path added to the path of Python
+* @param x_script     File of the script
+* @param x_function   Function of the script called for each image
+* @param x_timeout    Maximal time of the script for one image [s], a worker that exceeds it is restarted (0: no limit)
+*/
+PythonWorkerPool::PythonWorkerPool(int x_nbWorkers, const Size& x_maxSize, int x_type, const string& x_python,
+		const string& x_scriptPath, const string& x_script, const string& x_function, double x_timeout) :
+	m_slotSize(x_maxSize.area() * CV_ELEM_SIZE(x_type)),
+	m_python(x_python),
+	m_scriptPath(x_scriptPath),
+	m_script(x_script),
+	m_function(x_function),
+	m_timeout(static_cast<int64_t>(x_timeout * 1000))
+{
+	if(x_nbWorkers <= 0 || m_slotSize == 0 || x_timeout < 0)
+		throw MkException("Invalid parameters for the pool of Python workers", LOC);
+	static atomic<int> counter(0);
+	m_shmName = "markus_" + to_string(getpid()) + "_" + to_string(counter++);
+	m_shm = bip::shared_memory_object(bip::create_only, m_shmName.c_str(), bip::read_write);
+	try
+	{
+		m_shm.truncate(m_slotSize * x_nbWorkers);
+		m_region = bip::mapped_region(m_shm, bip::read_write);
+
+		m_workers.resize(x_nbWorkers);
+		for(auto& elem : m_workers)
+			Start(elem);
+	}
+	catch(...)
+	{
+		// note: the destructor is not called if the constructor throws
+		for(auto& elem : m_workers)
+			Stop(elem);
+		bip::shared_memory_object::remove(m_shmName.c_str());
+		throw;
+	}
+	LOG_INFO(m_logger, "Started " << x_nbWorkers << " Python workers for script " << m_script);
+}
+
+PythonWorkerPool::~PythonWorkerPool()
+{
+	for(auto& elem : m_workers)
+		Stop(elem);
+	bip::shared_memory_object::remove(m_shmName.c_str());
+}
+
+/**
+* @brief Send an image to the next free worker. If all workers are busy, this waits until one is free (the results
+*        received in between are kept for Collect)
+*
+* @param x_timestamp Timestamp of the image, given back with the result
+* @param x_image     Image, it is copied to the shared memory
+* @param x_objects   Objects, given to the script as a list of dicts
+*/
+void PythonWorkerPool::Submit(TIME_STAMP x_timestamp, const Mat& x_image, const mkjson& x_objects)
+{
+	if(x_image.total() * x_image.elemSize() > m_slotSize)
+		throw MkException("Image is too large for the shared memory of the Python workers", LOC);
+
+	// find a free worker in the ring
+	size_t index = m_workers.size();
+	while(index == m_workers.size())
+	{
+		for(size_t i = 0 ; i < m_workers.size() ; i++)
+		{
+			size_t j = (m_next + i) % m_workers.size();
+			if(!m_workers[j].busy)
+			{
+				index = j;
+				break;
+			}
+		}
+		// note: Poll returns at the latest when a request times out, its worker is then free
+		if(index == m_workers.size())
+			Poll(-1);
+	}
+	m_next = (index + 1) % m_workers.size();
+	Worker& worker(m_workers[index]);
+
+	const size_t offset = index * m_slotSize;
+	Mat slot(x_image.size(), x_image.type(), static_cast<char*>(m_region.get_address()) + offset);
+	x_image.copyTo(slot);
+
+	mkjson request{
+		{"timestamp", x_timestamp},
+		{"rows",      x_image.rows},
+		{"cols",      x_image.cols},
+		{"channels",  x_image.channels()},
+		{"dtype",     numpyType(x_image.depth())},
+		{"offset",    offset},
+		{"objects",   x_objects}
+	};
+	const string line = request.dump() + "\n";
+	worker.busy      = true;
+	worker.timestamp = x_timestamp;
+	worker.deadline  = chrono::steady_clock::now() + m_timeout;
+	m_nbPending++;
+
+	// note: MSG_NOSIGNAL: a worker that crashed must not stop markus with SIGPIPE
+	size_t sent = 0;
+	while(sent < line.size())
+	{
+		ssize_t nb = send(worker.socket, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+		if(nb <= 0)
+		{
+			Restart(worker, "cannot send the request to the Python worker");
+			return;
+		}
+		sent += nb;
+	}
+}
+
+/**
+* @brief Return the results received, ordered by timestamp
+*
+* @param xr_results Results
+* @param x_timeoutMs Maximal time to wait for results if none was received (0: do not wait, -1: wait for a result)
+*/
+void PythonWorkerPool::Collect(vector<Result>& xr_results, int x_timeoutMs)
+{
+	xr_results.clear();
+	if(m_results.empty() && m_nbPending > 0)
+		Poll(x_timeoutMs);
+	// note: also receive results that are already available
+	Poll(0);
+	xr_results.assign(make_move_iterator(m_results.begin()), make_move_iterator(m_results.end()));
+	m_results.clear();
+	sort(xr_results.begin(), xr_results.end(), [](const Result& x_1, const Result& x_2){return x_1.timestamp < x_2.timestamp;});
+}
+
+/// Start the process of a worker, connected by a socket to its standard input and output
+void PythonWorkerPool::Start(Worker& xr_worker)
+{
+	int fds[2];
+	// note: with CLOEXEC, the sockets of a worker are not inherited by the others
+	if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+		throw MkException("Cannot create a socket for a Python worker", LOC);
+
+	// note: arguments are prepared before fork since only few calls are allowed in the child
+	const char* args[] = {m_python.c_str(), "-u", "-c", BOOTSTRAP, m_shmName.c_str(), m_scriptPath.c_str(), m_script.c_str(), m_function.c_str(), nullptr};
+	pid_t pid = fork();
+	if(pid < 0)
+	{
+		close(fds[0]);
+		close(fds[1]);
+		throw MkException("Cannot start a Python worker", LOC);
+	}
+	if(pid == 0)
+	{
+		dup2(fds[1], STDIN_FILENO);
+		dup2(fds[1], STDOUT_FILENO);
+		execvp(args[0], const_cast<char* const*>(args));
+		_exit(127);
+	}
+	close(fds[1]);
+	xr_worker.pid    = pid;
+	xr_worker.socket = fds[0];
+	xr_worker.busy   = false;
+	xr_worker.buffer.clear();
+}
+
+/// Stop the process of a worker
+void PythonWorkerPool::Stop(Worker& xr_worker)
+{
+	if(xr_worker.socket >= 0)
+		close(xr_worker.socket);
+	if(xr_worker.pid > 0)
+	{
+		// note: workers have no state to save, SIGKILL also stops a script that hangs or handles SIGTERM
+		kill(xr_worker.pid, SIGKILL);
+		waitpid(xr_worker.pid, nullptr, 0);
+	}
+	xr_worker.socket = -1;
+	xr_worker.pid    = -1;
+}
+
+/**
+* @brief Wait for data from the busy workers. The workers whose request exceeded the timeout are restarted
+*
+* @param x_timeoutMs Maximal time to wait (-1: until data is received or a request times out)
+*/
+void PythonWorkerPool::Poll(int x_timeoutMs)
+{
+	vector<pollfd> fds;
+	vector<Worker*> workers;
+	const auto now = chrono::steady_clock::now();
+	for(auto& elem : m_workers)
+	{
+		if(!elem.busy)
+			continue;
+		fds.push_back(pollfd{elem.socket, POLLIN, 0});
+		workers.push_back(&elem);
+		if(m_timeout.count() > 0)
+		{
+			// note: the wait ends when the first request times out
+			const int remaining = max<int64_t>(0, chrono::duration_cast<chrono::milliseconds>(elem.deadline - now).count());
+			if(x_timeoutMs < 0 || remaining < x_timeoutMs)
+				x_timeoutMs = remaining;
+		}
+	}
+	if(fds.empty())
+		return;
+	int nb = poll(fds.data(), fds.size(), x_timeoutMs);
+	if(nb < 0 && errno != EINTR)
+		throw MkException("Error while waiting for the Python workers", LOC);
+	for(size_t i = 0 ; i < fds.size() && nb > 0 ; i++)
+	{
+		if(fds[i].revents != 0)
+			Receive(*workers[i]);
+	}
+
+	if(m_timeout.count() == 0)
+		return;
+	for(auto& elem : workers)
+	{
+		if(elem->busy && chrono::steady_clock::now() >= elem->deadline)
+			Restart(*elem, "the Python worker exceeded the timeout of " + to_string(m_timeout.count()) + " ms");
+	}
+}
+
+/// Receive the data of a worker, a result is complete at the end of a line
+void PythonWorkerPool::Receive(Worker& xr_worker)
+{
+	char buffer[4096];
+	ssize_t nb = recv(xr_worker.socket, buffer, sizeof(buffer), 0);
+	if(nb <= 0)
+	{
+		Restart(xr_worker, "the Python worker stopped");
+		return;
+	}
+	xr_worker.buffer.append(buffer, nb);
+
+	size_t pos = 0;
+	while((pos = xr_worker.buffer.find('\n')) != string::npos)
+	{
+		Result result{xr_worker.timestamp, mkjson(), ""};
+		try
+		{
+			mkjson answer = mkjson::parse(xr_worker.buffer.substr(0, pos));
+			result.timestamp = answer.at("timestamp").get<TIME_STAMP>();
+			if(answer.find("error") != answer.end())
+				result.error = answer.at("error").get<string>();
+			else
+				result.value = answer.at("result");
+		}
+		catch(exception& e)
+		{
+			Restart(xr_worker, "invalid answer of the Python worker: " + string(e.what()));
+			return;
+		}
+		xr_worker.buffer.erase(0, pos + 1);
+		m_nbFailures = 0;
+		if(!result.error.empty())
+			LOG_WARN(m_logger, "Error in Python script " << m_script << ": " << result.error);
+		m_results.push_back(std::move(result));
+		xr_worker.busy = false;
+		m_nbPending--;
+	}
+}
+
+/// Restart a worker that failed, its pending request is returned with an error
+void PythonWorkerPool::Restart(Worker& xr_worker, const string& x_reason)
+{
+	LOG_WARN(m_logger, "Restart a Python worker of script " << m_script << ": " << x_reason);
+	if(xr_worker.busy)
+	{
+		m_results.push_back(Result{xr_worker.timestamp, mkjson(), x_reason});
+		xr_worker.busy = false;
+		m_nbPending--;
+	}
+	Stop(xr_worker);
+	m_nbRestarts++;
+	if(++m_nbFailures > MAX_FAILURES_PER_WORKER * static_cast<int>(m_workers.size()))
+		throw MkException("Python workers of script " + m_script + " keep failing: " + x_reason, LOC);
+	Start(xr_worker);
+}
+
+} // namespace mk
@@ -0,0 +1,111 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_PYTHON_WORKER_POOL_H
+#define MK_PYTHON_WORKER_POOL_H
+
+#include <log4cxx/logger.h>
+#include <boost/noncopyable.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <opencv2/core/core.hpp>
+#include <sys/types.h>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include "define.h"
+#include "serialize.h"
+
+namespace mk {
+
+const char* numpyType(int x_depth);
+
+/**
+* @brief A pool of Python processes that run a script outside of markus. Each worker owns a slot of a shared memory
+*        segment: images are copied in the slot and a request is sent through a socket, the result comes back
+*        asynchronously with the timestamp of the image. A worker that crashes or exceeds the timeout is restarted, its
+*        request is returned with an error.
+*
+*        The script must define a function that receives the image (numpy array) and the objects (list of dicts),
+*        its return value must be serializable in JSON.
+*/
+class PythonWorkerPool : boost::noncopyable
+{
+public:
+	/// Result of a request
+	struct Result
+	{
+		TIME_STAMP timestamp;
+		mkjson value;
+		std::string error; // empty if the script succeeded
+	};
+
+	PythonWorkerPool(int x_nbWorkers, const cv::Size& x_maxSize, int x_type, const std::string& x_python,
+		const std::string& x_scriptPath, const std::string& x_script, const std::string& x_function, double x_timeout = 0);
+	virtual ~PythonWorkerPool();
+
+	void Submit(TIME_STAMP x_timestamp, const cv::Mat& x_image, const mkjson& x_objects);
+	void Collect(std::vector<Result>& xr_results, int x_timeoutMs = 0);
+	inline int GetNbWorkers() const {return m_workers.size();}
+	inline int GetNbPending() const {return m_nbPending;}
+	inline uint64_t GetNbRestarts() const {return m_nbRestarts;}
+
+protected:
+	/// A Python process and its connection
+	struct Worker
+	{
+		pid_t pid = -1;
+		int socket = -1;
+		bool busy = false;
+		TIME_STAMP timestamp = 0; // timestamp of the pending request
+		std::chrono::steady_clock::time_point deadline; // of the pending request
+		std::string buffer;       // received data, until a line is complete
+	};
+	void Start(Worker& xr_worker);
+	void Stop(Worker& xr_worker);
+	void Poll(int x_timeoutMs);
+	void Receive(Worker& xr_worker);
+	void Restart(Worker& xr_worker, const std::string& x_reason);
+
+	const size_t m_slotSize;
+	const std::string m_python;
+	const std::string m_scriptPath;
+	const std::string m_script;
+	const std::string m_function;
+	const std::chrono::milliseconds m_timeout;
+	std::string m_shmName;
+	boost::interprocess::shared_memory_object m_shm;
+	boost::interprocess::mapped_region m_region;
+	std::vector<Worker> m_workers;
+	std::deque<Result> m_results;
+	size_t m_next       = 0; // next worker in the ring
+	int m_nbPending     = 0;
+	int m_nbFailures    = 0; // consecutive failures of workers
+	uint64_t m_nbRestarts = 0;
+
+private:
+	static log4cxx::LoggerPtr m_logger;
+};
+
+} // namespace mk
+#endif
@@ -68,6 +68,7 @@ public:
 	void Deserialize(const mkjson& x_json, MkDirectory* xp_dir = nullptr);
 	mkjson Export() const override;
 	inline bool IsConnected() const {return m_cptConnected > 0;}
+	inline int GetNbConnected() const {return m_cptConnected;}
 	inline void SetAsConnected(bool x_val)
 	{
 		if(x_val)
@@ -56,6 +56,7 @@ public:
 	void Deserialize(const mkjson& x_json, MkDirectory* xp_dir = nullptr);
 	void Randomize(unsigned int& xr_seed) override;
 	const cv::Mat& GetImage() const {return m_content;}
+	cv::Mat& RefImage() {return m_content;}
 	void Connect(Stream& xr_stream) override;
 	void Disconnect() override;
 
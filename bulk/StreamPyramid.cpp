@@ -0,0 +1,102 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "StreamPyramid.h"
+#include "util.h"
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+template<> const string StreamPyramid::className = "StreamPyramid";
+
+// Transmit the pyramid to the connected module: only the headers of levels are copied, the images are shared
+
+template<> void StreamPyramid::ConvertInput()
+{
+	if(m_connected == nullptr)
+	{
+		m_content = Pyramid();
+		return;
+	}
+	assert(m_connected->IsConnected());
+
+	// Copy time stamp to output
+	m_timeStamp = GetConnected().GetTimeStamp();
+
+	const StreamPyramid * pstream = dynamic_cast<const StreamPyramid*>(m_connected);
+	if(pstream == nullptr)
+		throw MkException("Stream of pyramid " + GetName() + " is not correctly connected", LOC);
+	m_content = pstream->GetContent();
+}
+
+/// Render : display the first level of the pyramid
+
+template<> void StreamPyramid::RenderTo(Mat& x_output) const
+{
+	x_output.setTo(0);
+	if(m_content.GetNbLevels() == 0)
+		return;
+	Mat resized;
+	resize(m_content.GetLevel(0), resized, x_output.size());
+	if(resized.channels() == 1 && x_output.channels() == 3)
+		cvtColor(resized, x_output, CV_GRAY2BGR);
+	else
+		resized.copyTo(x_output);
+}
+
+/// Query : give info about cursor position
+template<> void StreamPyramid::Query(std::ostream& xr_out, const cv::Point& x_pt) const
+{
+	// check if out of bounds
+	if(!Rect(Point(0, 0), GetSize()).contains(x_pt))
+		return;
+
+	xr_out << m_content.GetNbLevels() << " levels, scale factor " << m_content.GetScaleFactor() << endl;
+	LOG_INFO(m_logger, "Pyramid of " << m_content.GetNbLevels() << " levels with scale factor " << m_content.GetScaleFactor());
+}
+
+/// Randomize the content of the stream
+template<> void StreamPyramid::Randomize(unsigned int& xr_seed)
+{
+	// random image and scale factor
+	Mat image(GetSize(), CV_8UC1);
+	RNG rng(rand_r(&xr_seed));
+	rng.fill(image, RNG::UNIFORM, 0, 255);
+	double scaleFactor = 1.05 + (rand_r(&xr_seed) % 20) / 20.0;
+	m_content.Build(image, scaleFactor, Size(24, 24), 1 + rand_r(&xr_seed) % 30, rand_r(&xr_seed) % 2 == 0);
+}
+
+template<> void StreamPyramid::Serialize(mkjson& rx_json, MkDirectory* xp_dir) const
+{
+	Stream::Serialize(rx_json, xp_dir);
+	to_mkjson(rx_json["pyramid"], m_content);
+}
+
+template<> void StreamPyramid::Deserialize(const mkjson& x_json, MkDirectory* xp_dir)
+{
+	Stream::Deserialize(x_json, xp_dir);
+	from_mkjson(x_json.at("pyramid"), m_content);
+}
+} // namespace mk
@@ -66,19 +66,22 @@ void AddImageToEvent::ProcessFrame()
 		return;
 
 	const Object& obj(m_event.GetObject());
+	vector<future<void>> pending;
 	if(m_saveImage1)
 	{
 		std::stringstream ss1;
 		ss1 << m_currentTimeStamp << "_" << m_event.GetEventName() << "_global_1." << m_param.extension;
-		addExternalImage(m_inputIm1, "globalImage", mp_outputDir->ReserveFile(ss1.str()), m_event);
+		pending.push_back(addExternalImage(m_inputIm1, "globalImage", mp_outputDir->ReserveFile(ss1.str()), m_event, RefContext().RefImageEncoder(), m_param.quality));
 
 		if(obj.width > 0 && obj.height > 0)
 		{
 			std::stringstream ss2;
 			ss2 << m_currentTimeStamp << "_" << m_event.GetEventName() << "_" << obj.GetName()<< obj.GetId() << "_1" << "." << m_param.extension;
 			// cout<<"Save image "<<obj.m_posX<<" "<<obj.m_posY<<endl;
-			addExternalImage((m_inputIm1)(obj.GetRect()), "objectImage", mp_outputDir->ReserveFile(ss2.str()), m_event);
+			pending.push_back(addExternalImage((m_inputIm1)(obj.GetRect()), "objectImage", mp_outputDir->ReserveFile(ss2.str()), m_event, RefContext().RefImageEncoder(), m_param.quality));
 		}
 	}
+	// note: the images are encoded in parallel but must be written before the event is forwarded
+	ImageEncoder::Wait(pending);
 }
 } // namespace mk
@@ -44,12 +44,14 @@ public:
 		{
 			AddParameter(new ParameterString("folder"    ,  "eventsImg", &folder    ,  "Name of the folder to create for images"));
 			AddParameter(new ParameterString("extension" , "jpg"        , &extension , "Extension of the thumbnails. Determines the output format."));
+			AddParameter(new ParameterInt("quality"      , 95, 0, 100 , &quality  , "Quality of the encoding [0-100]. For png it determines the compression level"));
 
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1","CV_8UC3","CV_32FC1","CV_32FC3"]})"_json);
-			RefParameterByName("extension").SetRange(R"({"allowed":["jpg","png"]})"_json);
+			RefParameterByName("extension").SetRange(R"({"allowed":["jpg","png","webp"]})"_json);
 		};
 		std::string folder;
 		std::string extension;
+		int quality;
 	};
 
 	explicit AddImageToEvent(ParameterStructure& xr_params);
@@ -58,15 +58,14 @@ BackgroundSubtractor::~BackgroundSubtractor()
 void BackgroundSubtractor::Reset()
 {
 	Module::Reset();
-	mp_bsub.release();
-	mp_bsub = create(m_param.create);
+	m_stripes.Reset(m_input.size(), m_param.nbStripes, m_param.stripeOverlap, [this](){return create(m_param.create);});
 }
 
 void BackgroundSubtractor::ProcessFrame()
 {
-	mp_bsub->apply(m_input, m_foregroundWithShadows, m_param.learningRate);
+	m_stripes.Apply(m_input, m_foregroundWithShadows, m_param.learningRate);
 	// TODO crashes on Reset. Find out why.
-	// mp_bsub->getBackgroundImage(m_background);
+	// m_stripes.GetBackgroundImage(m_background);
 
 	// Threshold shadows (value=128) to 0
 	threshold(m_foregroundWithShadows, m_foreground, 254, 255, cv::THRESH_BINARY);
@@ -27,6 +27,7 @@
 #include "Module.h"
 #include "CreationFunction.h"
 #include "opencv2/video/background_segm.hpp"
+#include "BackgroundStripes.h"
 
 namespace mk {
 
@@ -56,12 +57,16 @@ public:
 		{
 			AddParameter(new ParameterT<CreationFunction>("create", R"({"name": "BackgroundSubtractorMOG2", "number": 0, "parameters":{}})"_json, &create, "The parameters to pass to the create method method of ORB, BRIEF, ..."));
 			AddParameter(new ParameterDouble("learningRate",	-1, 	-1, 1, &learningRate,	"Learning rate of the model"));
+			AddParameter(new ParameterInt   ("nbStripes",	1, 	1, 64, &nbStripes,	"Number of horizontal stripes processed in parallel, each with its own model"));
+			AddParameter(new ParameterInt   ("stripeOverlap",	8, 	0, 64, &stripeOverlap,	"Number of rows of the neighbouring stripes processed by each model, to avoid seams [pixels]"));
 
 			RefParameterByName("type").SetDefaultAndValue("CV_8UC3");
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC3"]})"_json);
 		};
 		CreationFunction create;
 		double learningRate;
+		int nbStripes;
+		int stripeOverlap;
 	};
 
 	explicit BackgroundSubtractor(ParameterStructure& xr_params);
@@ -89,7 +94,7 @@ protected:
 	cv::Mat m_foregroundWithShadows;
 
 	// state variables
-	cv::Ptr<cv::BackgroundSubtractor> mp_bsub;
+	BackgroundStripes m_stripes;
 };
 
 
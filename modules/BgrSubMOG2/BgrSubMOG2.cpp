@@ -58,14 +58,13 @@ BgrSubMOG2::~BgrSubMOG2()
 void BgrSubMOG2::Reset()
 {
 	Module::Reset();
-	mp_mog2.release();
-	mp_mog2 = createBackgroundSubtractorMOG2(m_param.history, m_param.varThres, m_param.bShadowDetection);
+	m_stripes.Reset(m_input.size(), m_param.nbStripes, m_param.stripeOverlap, [this](){return createBackgroundSubtractorMOG2(m_param.history, m_param.varThres, m_param.bShadowDetection);});
 }
 
 void BgrSubMOG2::ProcessFrame()
 {
-	mp_mog2->apply(m_input, m_foregroundWithShadows, m_param.learningRate);
-	mp_mog2->getBackgroundImage(m_background);
+	m_stripes.Apply(m_input, m_foregroundWithShadows, m_param.learningRate);
+	m_stripes.GetBackgroundImage(m_background);
 
 	// Threshold shadows (value=128) to 0
 	threshold(m_foregroundWithShadows, m_foreground, 254, 255, cv::THRESH_BINARY);
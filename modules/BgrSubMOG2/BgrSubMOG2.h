@@ -26,6 +26,7 @@
 
 #include "Module.h"
 #include "opencv2/video/background_segm.hpp"
+#include "BackgroundStripes.h"
 
 namespace mk {
 
@@ -58,6 +59,8 @@ public:
 			AddParameter(new ParameterFloat("varThres",	16, 	1, 255,	&varThres,	"Threshold on the squared Mahalanobis distance to decide whether it is well described by the background model (selectivity of background) "));
 			AddParameter(new ParameterBool  ("bShadowDetection",	0, 	0, 1, &bShadowDetection,	"Enable shadow detection"));
 			AddParameter(new ParameterDouble("learningRate",	-1, 	-1, 1, &learningRate,	"Learning rate of the model"));
+			AddParameter(new ParameterInt   ("nbStripes",	1, 	1, 64, &nbStripes,	"Number of horizontal stripes processed in parallel, each with its own model"));
+			AddParameter(new ParameterInt   ("stripeOverlap",	8, 	0, 64, &stripeOverlap,	"Number of rows of the neighbouring stripes processed by each model, to avoid seams [pixels]"));
 
 			RefParameterByName("type").SetDefaultAndValue("CV_8UC3");
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC3"]})"_json);
@@ -66,6 +69,8 @@ public:
 		float varThres;
 		bool bShadowDetection;
 		double learningRate;
+		int nbStripes;
+		int stripeOverlap;
 	};
 
 	explicit BgrSubMOG2(ParameterStructure& xr_params);
@@ -93,7 +98,7 @@ protected:
 	cv::Mat m_foregroundWithShadows;
 
 	// state variables
-	cv::Ptr<cv::BackgroundSubtractorMOG2> mp_mog2;
+	BackgroundStripes m_stripes;
 };
 
 
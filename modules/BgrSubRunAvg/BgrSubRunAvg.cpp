@@ -24,6 +24,8 @@
 #include "BgrSubRunAvg.h"
 #include "StreamImage.h"
 #include <opencv2/opencv.hpp>
+#include <type_traits>
+#include <cmath>
 
 // for debug
 #include "util.h"
@@ -39,7 +41,9 @@ BgrSubRunAvg::BgrSubRunAvg(ParameterStructure& xr_params) :
 	m_input(Size(m_param.width, m_param.height), m_param.type),
 	m_background(Size(m_param.width, m_param.height), m_param.type),
 	m_foreground(Size(m_param.width, m_param.height), m_param.type),
+#ifdef MARKUS_DEBUG_STREAMS
 	m_foreground_tmp(Size(m_param.width, m_param.height), m_param.type),
+#endif
 	m_accumulator()
 {
 	AddInputStream(0, new StreamImage("image",             m_input, *this,   "Video input"));
@@ -47,7 +51,9 @@ BgrSubRunAvg::BgrSubRunAvg(ParameterStructure& xr_params) :
 	AddOutputStream(0, new StreamImage("foreground", m_foreground,*this,      "Foreground"));
 	AddOutputStream(1, new StreamImage("background", m_background, *this,		"Background"));
 
+#ifdef MARKUS_DEBUG_STREAMS
 	AddDebugStream(0, new StreamImage("foregroundTmp", m_foreground_tmp,*this,      "Foreground tmp"));
+#endif
 };
 
 
@@ -61,22 +67,99 @@ void BgrSubRunAvg::Reset()
 	m_emptyBackgroundSubtractor = true;
 }
 
+/**
+* @brief Scale of the fixed point representation of the background: images of floats are in [0, 1]
+*/
+template<typename T> inline float fixedPointScale() {return 256;}
+template<> inline float fixedPointScale<float>() {return 65535;}
+
+/// Read the value of the background as float
+template<typename T> inline float readAccumulator(float x_value) {return x_value;}
+template<typename T> inline float readAccumulator(ushort x_value) {return x_value * (1.0 / fixedPointScale<T>());}
+
+/// Store the value of the background
+template<typename T> inline void writeAccumulator(float x_value, float& xr_acc) {xr_acc = x_value;}
+template<typename T> inline void writeAccumulator(float x_value, ushort& xr_acc) {xr_acc = saturate_cast<ushort>(x_value * fixedPointScale<T>());}
+
+/**
+* @brief Update the running average and compute background and foreground in one pass over the pixels
+*
+* T is the type of the image (uchar or float), A is the type of the accumulator (float or ushort for fixed point)
+*/
+template<typename T, typename A> void BgrSubRunAvg::UpdateBackground(const Tile& x_tile)
+{
+	const float alpha  = m_param.backgroundAlpha;
+	// note: images of floats are in [0, 1]
+	const float maxVal = std::is_same<T, float>::value ? 1 : 255;
+	const float thres  = m_param.foregroundThres * maxVal;
+	const T     fg     = saturate_cast<T>(maxVal);
+	const int cols = m_input.cols * m_input.channels();
+
+	for(int i = x_tile.roi.y ; i < x_tile.roi.y + x_tile.roi.height ; i++)
+	{
+		const T* in  = m_input.ptr<T>(i);
+		A*       acc = m_accumulator.ptr<A>(i);
+		T*       bgr = m_background.ptr<T>(i);
+		T*       fgr = m_foreground.ptr<T>(i);
+		for(int j = 0 ; j < cols ; j++)
+		{
+			const float x = in[j];
+			float a = readAccumulator<T>(acc[j]);
+			a += alpha * (x - a);
+			writeAccumulator<T>(a, acc[j]);
+			const T b = saturate_cast<T>(a);
+			bgr[j] = b;
+			fgr[j] = std::abs(x - b) > thres ? fg : 0;
+		}
+	}
+}
+
 void BgrSubRunAvg::ProcessFrame()
 {
-	// cout<<"input "<<m_input->size()<<" "<<m_input->depth();
-	// cout<<"backgr "<<m_background->size()<<" "<<m_background->depth();
+	// note: pixels are independent, the image is processed by tiles in parallel
+	ProcessFrameByTiles();
+}
+
+void BgrSubRunAvg::BeginTiles()
+{
+	const int depth = m_input.depth();
+	if(depth != CV_8U && depth != CV_32F)
+		throw MkException("Unsupported image type in BgrSubRunAvg", LOC);
 	if(m_emptyBackgroundSubtractor)
 	{
 		m_emptyBackgroundSubtractor = false;
-		m_input.convertTo(m_accumulator, CV_32F);
+		if(m_param.fixedPoint)
+			m_input.convertTo(m_accumulator, CV_16U, depth == CV_32F ? fixedPointScale<float>() : fixedPointScale<uchar>());
+		else
+			m_input.convertTo(m_accumulator, CV_32F);
 		m_input.copyTo(m_background);
 	}
+}
 
+void BgrSubRunAvg::ProcessTile(const Tile& x_tile)
+{
 	// Main part of the program
-	accumulateWeighted(m_input, m_accumulator, m_param.backgroundAlpha);
-	m_accumulator.convertTo(m_background, m_background.depth());
+	if(m_input.depth() == CV_8U)
+	{
+		if(m_param.fixedPoint)
+			UpdateBackground<uchar, ushort>(x_tile);
+		else
+			UpdateBackground<uchar, float>(x_tile);
+	}
+	else
+	{
+		if(m_param.fixedPoint)
+			UpdateBackground<float, ushort>(x_tile);
+		else
+			UpdateBackground<float, float>(x_tile);
+	}
+}
+
+void BgrSubRunAvg::EndTiles()
+{
+#ifdef MARKUS_DEBUG_STREAMS
 	absdiff(m_input, m_background, m_foreground_tmp);
-	threshold(m_foreground_tmp, m_foreground, m_param.foregroundThres * 255, 255, cv::THRESH_BINARY);
-};
+#endif
+}
 
 } // namespace mk
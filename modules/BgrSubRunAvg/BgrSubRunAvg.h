@@ -29,7 +29,9 @@
 namespace mk {
 
 /**
-* @brief Perform a background subtraction using a running average
+* @brief Perform a background subtraction using a running average. The background and the foreground are computed
+*        in one pass over the pixels. With fixedPoint the background is stored on 16 bits: the result may then differ
+*        from the floating point background by at most 0.5 / (256 * backgroundAlpha) levels (of 255).
 */
 class BgrSubRunAvg : public Module
 {
@@ -41,12 +43,14 @@ public:
 		{
 			AddParameter(new ParameterFloat("backgroundAlpha",	0.02, 	0, 1,	&backgroundAlpha,	"Defines the speed at which the background adapts"));
 			AddParameter(new ParameterFloat("foregroundThres", 	0.2, 	0, 1,	&foregroundThres,	"Threshold to accept a pixel as foreground"));
+			AddParameter(new ParameterBool("fixedPoint",         false,          &fixedPoint,     "Store the background on 16 bits instead of floats: this halves the memory bandwidth but reduces the precision"));
 
 			RefParameterByName("type").SetDefaultAndValue("CV_32FC3");
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1","CV_8UC3","CV_32FC1","CV_32FC3"]})"_json);
 		};
 		float backgroundAlpha;
 		float foregroundThres;
+		bool fixedPoint;
 	};
 
 	explicit BgrSubRunAvg(ParameterStructure& xr_params);
@@ -54,6 +58,7 @@ public:
 	MKCLASS("BgrSubRunAvg")
 	MKCATEG("BackgroundSubtraction")
 	MKDESCR("Perform a background subtraction using a running average")
+	bool IsFusable() const override {return true;}
 
 private:
 	const Parameters& m_param;
@@ -62,6 +67,10 @@ private:
 protected:
 	void ProcessFrame() override;
 	void Reset() override;
+	void BeginTiles() override;
+	void ProcessTile(const Tile& x_tile) override;
+	void EndTiles() override;
+	template<typename T, typename A> void UpdateBackground(const Tile& x_tile);
 
 	// input
 	cv::Mat m_input;
@@ -70,12 +79,14 @@ protected:
 	cv::Mat m_background;
 	cv::Mat m_foreground;
 
+#ifdef MARKUS_DEBUG_STREAMS
 	// temporary
 	cv::Mat m_foreground_tmp;
+#endif
 
 	// state variables
 	bool m_emptyBackgroundSubtractor;
-	cv::Mat m_accumulator;
+	cv::Mat m_accumulator; // background as float or as 16 bits fixed point
 };
 
 
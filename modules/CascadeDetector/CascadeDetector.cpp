@@ -24,11 +24,15 @@
 #include "CascadeDetector.h"
 #include "StreamImage.h"
 #include "StreamObject.h"
+#include "StreamPyramid.h"
 #include "StreamDebug.h"
 #include "Timer.h"
+#include "config.h"
 
 #include <iostream>
 #include <cstdio>
+#include <climits>
+#include <algorithm>
 #include <opencv2/highgui/highgui.hpp>
 
 
@@ -43,13 +47,17 @@ log4cxx::LoggerPtr CascadeDetector::m_logger(log4cxx::Logger::getLogger("Cascade
 CascadeDetector::CascadeDetector(ParameterStructure& xr_params)
 	: Module(xr_params),
 	  m_param(dynamic_cast<Parameters&>(xr_params)),
-	  m_input(Size(m_param.width, m_param.height), m_param.type)
+	  m_input(Size(m_param.width, m_param.height), m_param.type),
+	  m_mask(Size(m_param.width, m_param.height), CV_8UC1)
 {
 	// Init output images
 	if(! m_cascade.load( m_param.filterFile ) || m_cascade.empty())
 		throw MkException("Impossible to load cascade filter " + m_param.filterFile, LOC);
 
 	AddInputStream(0, new StreamImage("image", m_input, *this, 		"Video input"));
+	AddInputStream(1, new StreamImage("mask", m_mask, *this, 		"Optional mask of the regions to scan (e.g. foreground)"));
+	AddInputStream(2, new StreamObject("objects", m_objects, *this, 	"Optional objects: regions to scan"));
+	AddInputStream(3, new StreamPyramid("pyramid", m_pyramid, *this, 	"Optional pyramid of the input image, shared with other detectors. If connected, its scales are scanned instead of the ones given by scaleFactor"));
 
 	AddOutputStream(0, new StreamObject("detected", m_detectedObjects, *this,	"Detected objects"));
 #ifdef MARKUS_DEBUG_STREAMS
@@ -65,16 +73,35 @@ CascadeDetector::~CascadeDetector()
 void CascadeDetector::Reset()
 {
 	Module::Reset();
+	m_roi.Reset();
+	m_scheduler.Reset();
+	m_sizePrior.Reset(GetSize(), m_param.sizePriorBands, m_param.sizePriorSamples, m_param.sizePriorMargin);
+	if(!m_param.sizePriorFile.empty())
+	{
+		mkconf json;
+		readFromFile(json, m_param.sizePriorFile);
+		from_json(json, m_sizePrior);
+	}
+
+	// note: a cascade classifier cannot be used by two threads at once: load one classifier per worker
+	if(GetInputStreamByName("pyramid").IsConnected() && static_cast<int>(m_cascades.size()) != max(1, getNumThreads()))
+	{
+		m_cascades.resize(max(1, getNumThreads()));
+		for(auto& elem : m_cascades)
+		{
+			if(! elem.load(m_param.filterFile) || elem.empty())
+				throw MkException("Impossible to load cascade filter " + m_param.filterFile, LOC);
+		}
+	}
 }
 
 void CascadeDetector::ProcessFrame()
 {
-	Mat smallImg(m_input);
-	equalizeHist( smallImg, smallImg );
-
-	// Detection
+	// Detection on key frames only, objects are tracked in between
 	std::vector<cv::Rect> detected;
-	m_cascade.detectMultiScale(smallImg, detected, m_param.scaleFactor, m_param.minNeighbors, CV_HAAR_SCALE_IMAGE, Size(m_param.minSide, m_param.minSide));
+	if(!m_scheduler.Process(m_input, m_param.detectionInterval, m_param.maxDetectionInterval, m_param.activityThreshold, GetFps(),
+			[this](vector<Rect>& xr_detected){Detect(xr_detected);}, detected))
+		m_roi.Skip(GetSize());
 
 	m_detectedObjects.clear();
 	const double diagonal = sqrt(m_param.width * m_param.width + m_param.height * m_param.height);
@@ -98,6 +125,147 @@ void CascadeDetector::ProcessFrame()
 		// Draw the rectangle in the input image
 		rectangle(m_debug, obj.GetRect(), Scalar(255, 0, 23)/*colorFromStr(m_param.color)*/, 1, 8, 0 );
 	}
+	for(const auto& elem : m_roi.GetRegions())
+		rectangle(m_debug, elem, Scalar(0, 255, 0), 1, 8, 0);
 #endif
 }
+
+/**
+* @brief Run the detection on the regions of interest
+*
+* @param xr_detected Detected rectangles
+*/
+void CascadeDetector::Detect(vector<Rect>& xr_detected)
+{
+	// Regions to scan: the whole image or the regions given by the mask and objects inputs
+	const Size window = m_cascade.getOriginalWindowSize();
+	m_roi.Select(GetInputStreamByName("mask").IsConnected() ? &m_mask : nullptr, GetInputStreamByName("objects").IsConnected() ? &m_objects : nullptr,
+		GetNbTiles(), m_param.roiMargin, Size(max(window.width, m_param.minSide), max(window.height, m_param.minSide)), GetSize(), m_param.maxRoiRatio);
+
+	// Areas to scan: each region is split in bands with a restricted range of sizes. While the prior is learned, all
+	// sizes are scanned periodically
+	const bool scanAllSizes = m_param.sizePriorSamples > 0 && !m_sizePrior.IsCalibrated()
+		&& m_scheduler.GetNbDetections() % m_param.sizePriorScanInterval == 0;
+	m_areas.clear();
+	std::vector<ScanArea> areas;
+	for(const auto& region : m_roi.GetRegions())
+	{
+		if(scanAllSizes)
+			areas.assign(1, ScanArea{region, Range(region.y, region.y + region.height), m_param.minSide, INT_MAX});
+		else
+			m_sizePrior.Split(region, m_param.minSide, areas);
+		m_areas.insert(m_areas.end(), areas.begin(), areas.end());
+	}
+
+	// Detection
+	if(GetInputStreamByName("pyramid").IsConnected())
+	{
+		DetectOnPyramid(xr_detected);
+	}
+	else
+	{
+		std::vector<cv::Rect> detectedInArea;
+		for(const auto& area : m_areas)
+		{
+			// note: the input is not equalized in place, it is also used for tracking
+			Mat smallImg;
+			equalizeHist(m_input(area.roi), smallImg);
+			const Size maxSize = area.maxSize == INT_MAX ? Size() : Size(area.roi.width, area.maxSize);
+			m_cascade.detectMultiScale(smallImg, detectedInArea, m_param.scaleFactor, m_param.minNeighbors, CV_HAAR_SCALE_IMAGE, Size(m_param.minSide, area.minSize), maxSize);
+			for(const auto& elem : detectedInArea)
+			{
+				// note: objects centered outside of the band are detected with the neighbouring band
+				Rect rect = elem + area.roi.tl();
+				const int center = rect.y + rect.height / 2;
+				if(center >= area.rows.start && center < area.rows.end)
+					xr_detected.push_back(rect);
+			}
+		}
+	}
+
+	// the size of detected objects is learned from scans at all sizes only, otherwise the range could never widen
+	if(all_of(m_areas.begin(), m_areas.end(), [](const ScanArea& x_area){return x_area.maxSize == INT_MAX;}))
+	{
+		for(const auto& elem : xr_detected)
+			m_sizePrior.Add(elem);
+	}
+}
+
+/**
+* @brief Detect on all levels of the pyramid in parallel. Each worker scans every n-th level with its own classifier,
+*        the detections of all levels are then grouped as detectMultiScale does
+*
+* @param xr_detected Detected rectangles, in the coordinates of the input image
+*/
+void CascadeDetector::DetectOnPyramid(vector<Rect>& xr_detected)
+{
+	const size_t nbLevels = m_pyramid.GetNbLevels();
+	m_detectedByLevel.resize(nbLevels);
+	const int nbWorkers = min<int>(m_cascades.size(), nbLevels);
+	parallelForEach(nbWorkers, [this, nbLevels, nbWorkers](int x_worker){
+		for(size_t i = x_worker ; i < nbLevels ; i += nbWorkers)
+			DetectOnLevel(m_cascades.at(x_worker), i);
+	});
+
+	for(const auto& elem : m_detectedByLevel)
+		xr_detected.insert(xr_detected.end(), elem.begin(), elem.end());
+	groupRectangles(xr_detected, m_param.minNeighbors, 0.2);
+}
+
+/**
+* @brief Detect on one level of the pyramid: only the size of the window of the classifier is scanned
+*
+* @param xr_cascade Classifier used by the current worker
+* @param x_level    Index of the level
+*/
+void CascadeDetector::DetectOnLevel(CascadeClassifier& xr_cascade, size_t x_level)
+{
+	vector<Rect>& detected(m_detectedByLevel.at(x_level));
+	detected.clear();
+	const Mat& image(m_pyramid.GetLevel(x_level));
+	const Size window = xr_cascade.getOriginalWindowSize();
+	// note: the pyramid may have a different resolution than the module
+	const double scaleX = static_cast<double>(m_param.width)  / image.cols;
+	const double scaleY = static_cast<double>(m_param.height) / image.rows;
+	if(window.width * scaleX < m_param.minSide || window.height * scaleY < m_param.minSide)
+		return;
+
+	vector<Rect> found;
+	for(const auto& area : m_areas)
+	{
+		// note: only one size of objects is detected on this level
+		const double size = window.height * scaleY;
+		if(size < area.minSize || size > area.maxSize)
+			continue;
+		const Rect& region(area.roi);
+		Rect scaled(cvFloor(region.x / scaleX), cvFloor(region.y / scaleY), cvCeil(region.width / scaleX), cvCeil(region.height / scaleY));
+		scaled &= Rect(Point(0, 0), image.size());
+		if(scaled.width < window.width || scaled.height < window.height)
+			continue;
+		// note: no grouping here (minNeighbors = 0), this is done once for all levels
+		xr_cascade.detectMultiScale(image(scaled), found, 1.1, 0, 0, window, window);
+		for(const auto& elem : found)
+		{
+			Rect rect(cvRound((elem.x + scaled.x) * scaleX), cvRound((elem.y + scaled.y) * scaleY),
+				cvRound(elem.width * scaleX), cvRound(elem.height * scaleY));
+			const int center = rect.y + rect.height / 2;
+			if(center >= area.rows.start && center < area.rows.end)
+				detected.push_back(rect);
+		}
+	}
+}
+
+void CascadeDetector::PrintStatistics(mkconf& xr_result) const
+{
+	Module::PrintStatistics(xr_result);
+	m_roi.PrintStatistics(GetName(), xr_result);
+	m_scheduler.PrintStatistics(GetName(), xr_result);
+	if(m_param.sizePriorSamples > 0 && !m_sizePrior.IsCalibrated())
+	{
+		// note: the learned prior can be used as a calibration file
+		mkjson prior = m_sizePrior;
+		LOG_INFO(m_logger, "Module " << GetName() << ": learned sizes of objects " << oneLine(prior));
+		xr_result["module"][GetName()]["sizePrior"] = prior;
+	}
+}
 } // namespace mk
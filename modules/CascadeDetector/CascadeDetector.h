@@ -27,6 +27,10 @@
 #include "Module.h"
 #include "Parameter.h"
 #include "StreamObject.h"
+#include "Pyramid.h"
+#include "DetectionScheduler.h"
+#include "RegionsOfInterest.h"
+#include "SizePrior.h"
 
 /*! \class CascadeDetector
  *  \brief Module class for detection based on cascade filters (Haar, ...)
@@ -56,6 +60,16 @@ public:
 			AddParameter(new ParameterString("filterFile", "modules/CascadeDetector/lbpcascade_frontalface.xml",  &filterFile, "File with filter data of the detected object"));
 			// AddParameter(new ParameterString("color", "(255,255,255)",		&color,	"Color to draw the output"));
 			AddParameter(new ParameterString("objectLabel", "casc", 			&objectLabel,	"Label to be applied to the objects detected by the cascade filter (e.g. face)"));
+			AddParameter(new ParameterInt("roiMargin", 16, 0, 200, 		&roiMargin,	"Margin added around the regions of interest given by the mask and objects inputs"));
+			AddParameter(new ParameterDouble("maxRoiRatio", 0.5, 0, 1, 	&maxRoiRatio,	"If the regions of interest cover more than this part of the image, the whole image is scanned"));
+			AddParameter(new ParameterInt("detectionInterval", 1, 1, 1000, 	&detectionInterval,	"Number of frames between two detections, in between objects are tracked by template matching (1: detect on all frames)"));
+			AddParameter(new ParameterInt("maxDetectionInterval", 25, 1, 1000, &maxDetectionInterval, "If fps is set, the interval between detections is increased up to this value to meet the fps"));
+			AddParameter(new ParameterDouble("activityThreshold", 0, 0, 1, 	&activityThreshold,	"Fraction of the image changed since the last detection that triggers a new detection (0: disabled)"));
+			AddParameter(new ParameterString("sizePriorFile", "", 		&sizePriorFile,	"Optional calibration file with the range of sizes of objects in function of their row (format of sizePrior in the statistics). Scales outside the range are not scanned"));
+			AddParameter(new ParameterInt("sizePriorSamples", 0, 0, 10000, 	&sizePriorSamples,	"Learn the range of sizes of objects in function of their row: number of detections in a band before its scales are restricted (0: disabled)"));
+			AddParameter(new ParameterInt("sizePriorBands", 8, 1, 100, 	&sizePriorBands,	"Number of horizontal bands of the size prior"));
+			AddParameter(new ParameterDouble("sizePriorMargin", 1.5, 1, 10, 	&sizePriorMargin,	"Factor applied to the range of sizes of the size prior, to accept smaller and larger objects"));
+			AddParameter(new ParameterInt("sizePriorScanInterval", 10, 1, 1000, 	&sizePriorScanInterval,	"While the size prior is learned: number of detections between two scans at all sizes. The prior is only learned from these scans"));
 
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1"]})"_json);
 			RefParameterByName("type").SetDefaultAndValue("CV_8UC1");
@@ -94,6 +108,16 @@ public:
 		double scaleFactor;
 		std::string filterFile;
 		std::string objectLabel;
+		int roiMargin;
+		double maxRoiRatio;
+		int detectionInterval;
+		int maxDetectionInterval;
+		double activityThreshold;
+		std::string sizePriorFile;
+		int sizePriorSamples;
+		int sizePriorBands;
+		double sizePriorMargin;
+		int sizePriorScanInterval;
 	};
 
 	explicit CascadeDetector(ParameterStructure& xr_params);
@@ -109,16 +133,31 @@ private:
 protected:
 	void Reset() override;
 	void ProcessFrame() override;
+	void PrintStatistics(mkconf& xr_result) const override;
+	void Detect(std::vector<cv::Rect>& xr_detected);
+	void DetectOnPyramid(std::vector<cv::Rect>& xr_detected);
+	void DetectOnLevel(cv::CascadeClassifier& xr_cascade, size_t x_level);
 
 	// state
 	cv::CascadeClassifier m_cascade;
+	std::vector<cv::CascadeClassifier> m_cascades; // one classifier per worker, to scan the levels of the pyramid in parallel
+	DetectionScheduler m_scheduler;
+	SizePrior m_sizePrior;
 
 	// input
 	cv::Mat m_input;
+	cv::Mat m_mask;
+	std::vector<Object> m_objects;
+	Pyramid m_pyramid;
 
 	// output
 	std::vector<Object> m_detectedObjects;
 
+	// temporary
+	RegionsOfInterest m_roi;
+	std::vector<ScanArea> m_areas;
+	std::vector<std::vector<cv::Rect>> m_detectedByLevel;
+
 	// debug
 #ifdef MARKUS_DEBUG_STREAMS
 	cv::Mat m_debug;
@@ -0,0 +1,276 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "DescriptorMatcher.h"
+#include "FeatureOpenCv.h"
+#include "FeatureVector.h"
+#include "config.h"
+#include <opencv2/features2d/features2d.hpp>
+#include <algorithm>
+
+namespace mk {
+using namespace cv;
+using namespace std;
+
+log4cxx::LoggerPtr DescriptorMatcher::m_logger(log4cxx::Logger::getLogger("DescriptorMatcher"));
+
+DescriptorMatcher::DescriptorMatcher(ParameterStructure& xr_params) :
+	Module(xr_params),
+	m_param(dynamic_cast<Parameters&>(xr_params))
+{
+	// note: descriptors can also be vectors of floats
+	mkjson req;
+	req["features"][m_param.feature]["type"] = "FeatureBinaryDescriptor";
+	AddInputStream(0, new StreamObject("objects", m_objectsIn, *this, "Objects with descriptors", req));
+
+	AddOutputStream(0, new StreamObject("matched", m_objectsOut, *this, "Matched objects, with the features matchId, matchDistance and matchScore"));
+}
+
+DescriptorMatcher::~DescriptorMatcher()
+{
+}
+
+void DescriptorMatcher::Reset()
+{
+	Module::Reset();
+	mp_index.release();
+	m_indexed = Mat();
+	m_indexedEntries.clear();
+	m_pending = Mat();
+	m_pendingEntries.clear();
+	m_history.clear();
+	m_framesSinceRebuild = 0;
+	m_descriptorType     = -1;
+	m_descriptorSize     = 0;
+	m_nbQueries          = 0;
+	m_nbMatches          = 0;
+
+	if(!m_param.galleryFile.empty())
+	{
+		// the gallery is indexed once
+		mkconf json;
+		readFromFile(json, m_param.galleryFile);
+		vector<Object> gallery;
+		from_mkjson(json, gallery);
+		vector<size_t> indices;
+		ExtractDescriptors(gallery, m_indexed, indices, m_indexedEntries);
+		RebuildIndex();
+		LOG_INFO(m_logger, "Indexed " << m_indexed.rows << " descriptors of the gallery " << m_param.galleryFile);
+	}
+}
+
+void DescriptorMatcher::ProcessFrame()
+{
+	Mat queries;
+	vector<size_t> indices;
+	vector<Entry> entries;
+	ExtractDescriptors(m_objectsIn, queries, indices, entries);
+
+	// Find the two best candidates of each query in the index and in the descriptors added since the last rebuild
+	vector<vector<Candidate>> candidates(queries.rows);
+	if(queries.rows > 0)
+	{
+		SearchIndex(queries, candidates);
+		SearchPending(queries, candidates);
+	}
+
+	m_objectsOut.clear();
+	for(int i = 0 ; i < queries.rows ; i++)
+	{
+		auto& cands(candidates[i]);
+		if(cands.empty())
+			continue;
+		sort(cands.begin(), cands.end(), [](const Candidate& x_1, const Candidate& x_2){return x_1.distance < x_2.distance;});
+		const Candidate& best(cands.front());
+
+		// ratio test with the best candidate of another object
+		const Candidate* second = nullptr;
+		for(size_t j = 1 ; j < cands.size() && second == nullptr ; j++)
+		{
+			if(cands[j].entry->id < 0 || cands[j].entry->id != best.entry->id)
+				second = &cands[j];
+		}
+		if(second != nullptr && best.distance > m_param.ratio * second->distance)
+			continue;
+
+		const float distance = NormalizedDistance(best, entries[i].norm, queries.cols);
+		if(distance > m_param.maxDistance)
+			continue;
+
+		Object obj(m_objectsIn[indices[i]]);
+		obj.AddFeature("matchId", new FeatureInt(best.entry->id));
+		obj.AddFeature("matchDistance", new FeatureFloat(distance));
+		obj.AddFeature("matchScore", new FeatureFloat(second == nullptr || second->distance == 0 ? 1 : 1 - best.distance / second->distance));
+		m_objectsOut.push_back(obj);
+	}
+	m_nbQueries += queries.rows;
+	m_nbMatches += m_objectsOut.size();
+
+	if(!m_param.galleryFile.empty())
+		return;
+
+	// Add the descriptors of the current frame to the gallery. They are searched by brute force until the next rebuild
+	if(queries.rows > 0)
+	{
+		m_pending.push_back(queries);
+		m_pendingEntries.insert(m_pendingEntries.end(), entries.begin(), entries.end());
+	}
+	m_history.push_back(make_pair(queries, entries));
+	while(static_cast<int>(m_history.size()) > m_param.historyFrames)
+		m_history.pop_front();
+
+	// note: the index may contain descriptors older than historyFrames until it is rebuilt
+	if(++m_framesSinceRebuild >= m_param.rebuildInterval)
+	{
+		mp_index.release();
+		m_indexed = Mat();
+		m_indexedEntries.clear();
+		for(const auto& elem : m_history)
+		{
+			m_indexed.push_back(elem.first);
+			m_indexedEntries.insert(m_indexedEntries.end(), elem.second.begin(), elem.second.end());
+		}
+		RebuildIndex();
+	}
+}
+
+/**
+* @brief Extract the descriptors of a list of objects. Objects without descriptor are ignored
+*
+* @param x_objects      Objects
+* @param xr_descriptors Descriptors, one per row
+* @param xr_indices     Index of the object of each descriptor
+* @param xr_entries     Entries of the objects
+*/
+void DescriptorMatcher::ExtractDescriptors(const vector<Object>& x_objects, Mat& xr_descriptors, vector<size_t>& xr_indices, vector<Entry>& xr_entries)
+{
+	xr_descriptors = Mat();
+	xr_indices.clear();
+	xr_entries.clear();
+
+	for(size_t i = 0 ; i < x_objects.size() ; i++)
+	{
+		if(!x_objects[i].HasFeature(m_param.feature))
+			continue;
+		const Feature& feat(x_objects[i].GetFeature(m_param.feature));
+		Mat row;
+		if(const auto* binary = dynamic_cast<const FeatureBinaryDescriptor*>(&feat))
+			row = Mat(binary->value.bytes, false).reshape(1, 1);
+		else if(const auto* vect = dynamic_cast<const FeatureVectorFloat*>(&feat))
+			row = Mat(vect->values, false).reshape(1, 1);
+		else
+			throw MkException("Feature " + m_param.feature + " is not a binary descriptor or a vector of floats", LOC);
+		if(row.cols == 0)
+			continue;
+
+		// all descriptors must be of the same type
+		if(m_descriptorType == -1)
+		{
+			m_descriptorType = row.type();
+			m_descriptorSize = row.cols;
+		}
+		else if(row.type() != m_descriptorType || row.cols != m_descriptorSize)
+			throw MkException("Descriptors of different types or sizes cannot be matched", LOC);
+
+		xr_descriptors.push_back(row);
+		xr_indices.push_back(i);
+		// note: keypoints (see Feature2D) are matched to the object that contains them
+		const int id = x_objects[i].HasFeature("parent") ? dynamic_cast<const FeatureInt&>(x_objects[i].GetFeature("parent")).value : x_objects[i].GetId();
+		// note: the norm is only needed to normalize L2 distances
+		xr_entries.push_back(Entry{id, m_descriptorType == CV_8U ? 0 : static_cast<float>(cv::norm(row, NORM_L2))});
+	}
+}
+
+/// Rebuild the index on the current descriptors. The pending descriptors are now part of the index
+void DescriptorMatcher::RebuildIndex()
+{
+	mp_index.release();
+	m_pending = Mat();
+	m_pendingEntries.clear();
+	m_framesSinceRebuild = 0;
+	if(m_indexed.rows == 0)
+		return;
+
+	if(m_indexed.depth() == CV_8U)
+		mp_index = makePtr<flann::Index>(m_indexed, flann::LshIndexParams(12, 20, 2), cvflann::FLANN_DIST_HAMMING);
+	else
+		mp_index = makePtr<flann::Index>(m_indexed, flann::KDTreeIndexParams(4), cvflann::FLANN_DIST_L2);
+	LOG_DEBUG(m_logger, "Index rebuilt with " << m_indexed.rows << " descriptors");
+}
+
+/// Search the two nearest neighbours of each query in the index
+void DescriptorMatcher::SearchIndex(const Mat& x_queries, vector<vector<Candidate>>& xr_candidates) const
+{
+	if(mp_index.empty())
+		return;
+	const int knn = min(2, m_indexed.rows);
+	Mat indices, dists;
+	mp_index->knnSearch(x_queries, indices, dists, knn, flann::SearchParams(m_param.checks));
+	// note: distances are integers for Hamming and squared distances for L2
+	dists.convertTo(dists, CV_32F);
+	if(m_indexed.depth() != CV_8U)
+		cv::sqrt(dists, dists);
+
+	for(int i = 0 ; i < x_queries.rows ; i++)
+	{
+		for(int j = 0 ; j < knn ; j++)
+		{
+			int index = indices.at<int>(i, j);
+			if(index >= 0 && index < m_indexed.rows)
+				xr_candidates[i].push_back(Candidate{dists.at<float>(i, j), &m_indexedEntries[index]});
+		}
+	}
+}
+
+/// Search the two nearest neighbours of each query in the descriptors added since the last rebuild, by brute force
+void DescriptorMatcher::SearchPending(const Mat& x_queries, vector<vector<Candidate>>& xr_candidates) const
+{
+	if(m_pending.rows == 0)
+		return;
+	BFMatcher matcher(m_pending.depth() == CV_8U ? NORM_HAMMING : NORM_L2);
+	vector<vector<DMatch>> matches;
+	matcher.knnMatch(x_queries, m_pending, matches, 2);
+	for(const auto& elem : matches)
+	{
+		for(const auto& match : elem)
+			xr_candidates.at(match.queryIdx).push_back(Candidate{match.distance, &m_pendingEntries.at(match.trainIdx)});
+	}
+}
+
+/// Distance of a candidate in [0, 1]: fraction of different bits for binary descriptors, relative to the norms otherwise
+float DescriptorMatcher::NormalizedDistance(const Candidate& x_candidate, float x_queryNorm, int x_descriptorSize) const
+{
+	if(m_descriptorType == CV_8U)
+		return x_candidate.distance / (8 * x_descriptorSize);
+	float norms = x_queryNorm + x_candidate.entry->norm;
+	return norms == 0 ? 0 : x_candidate.distance / norms;
+}
+
+void DescriptorMatcher::PrintStatistics(mkconf& xr_result) const
+{
+	Module::PrintStatistics(xr_result);
+	double ratio = m_nbQueries > 0 ? static_cast<double>(m_nbMatches) / m_nbQueries : 0;
+	LOG_INFO(m_logger, "Module " << GetName() << ": " << m_nbMatches << " matches for " << m_nbQueries << " descriptors");
+	xr_result["module"][GetName()]["matchedRatio"] = ratio;
+}
+} // namespace mk
@@ -0,0 +1,119 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef DESCRIPTOR_MATCHER_H
+#define DESCRIPTOR_MATCHER_H
+
+#include <deque>
+#include <opencv2/flann/flann.hpp>
+#include "Module.h"
+#include "StreamObject.h"
+
+
+namespace mk {
+/**
+* @brief Match the descriptors of objects (e.g. keypoints) with the ones of previous frames or of a gallery. The
+*        descriptors are searched in an approximate nearest neighbour index (LSH for binary descriptors, kd-trees
+*        otherwise).
+*/
+class DescriptorMatcher : public Module
+{
+public:
+	class Parameters : public Module::Parameters
+	{
+	public:
+		explicit Parameters(const std::string& x_name) : Module::Parameters(x_name)
+		{
+			AddParameter(new ParameterString("feature",      "descriptor", &feature,         "Name of the feature containing the descriptor (binary or vector of floats)"));
+			AddParameter(new ParameterString("galleryFile",  "",           &galleryFile,     "File containing a gallery of objects with descriptors (JSON). If empty, objects are matched with the ones of previous frames"));
+			AddParameter(new ParameterInt("historyFrames",   10,  1, 1000, &historyFrames,   "Number of previous frames in the gallery, if no gallery file is given"));
+			AddParameter(new ParameterInt("rebuildInterval", 10,  1, 1000, &rebuildInterval, "Number of frames between two rebuilds of the index. Descriptors added in between are searched by brute force"));
+			AddParameter(new ParameterInt("checks",          32,  1, 1024, &checks,          "Number of checks of the approximate search (higher: more precise but slower)"));
+			AddParameter(new ParameterDouble("ratio",        0.8, 0, 1,    &ratio,           "Maximal ratio between the distance to the best match and to the second best match of another object. 1 to disable"));
+			AddParameter(new ParameterDouble("maxDistance",  0.25, 0, 1,   &maxDistance,     "Maximal normalized distance of a match"));
+		};
+		std::string feature;
+		std::string galleryFile;
+		int historyFrames;
+		int rebuildInterval;
+		int checks;
+		double ratio;
+		double maxDistance;
+	};
+
+	explicit DescriptorMatcher(ParameterStructure& xr_params);
+	~DescriptorMatcher() override;
+	MKCLASS("DescriptorMatcher")
+	MKCATEG("KeyPoints")
+	MKDESCR("Match the descriptors of objects with the ones of previous frames or of a gallery")
+
+private:
+	const Parameters& m_param;
+	static log4cxx::LoggerPtr m_logger;
+
+protected:
+	/// An object whose descriptor is searched
+	struct Entry
+	{
+		int id;
+		float norm; // L2 norm of the descriptor, to normalize distances
+	};
+	/// A candidate match of a query
+	struct Candidate
+	{
+		float distance;
+		const Entry* entry;
+	};
+
+	void Reset() override;
+	void ProcessFrame() override;
+	void PrintStatistics(mkconf& xr_result) const override;
+	void ExtractDescriptors(const std::vector<Object>& x_objects, cv::Mat& xr_descriptors, std::vector<size_t>& xr_indices, std::vector<Entry>& xr_entries);
+	void RebuildIndex();
+	void SearchIndex(const cv::Mat& x_queries, std::vector<std::vector<Candidate>>& xr_candidates) const;
+	void SearchPending(const cv::Mat& x_queries, std::vector<std::vector<Candidate>>& xr_candidates) const;
+	float NormalizedDistance(const Candidate& x_candidate, float x_queryNorm, int x_descriptorSize) const;
+
+	// input
+	std::vector<Object> m_objectsIn;
+
+	// output
+	std::vector<Object> m_objectsOut;
+
+	// state
+	cv::Mat m_indexed;                            // descriptors in the index, one per row. Must not change while the index exists
+	std::vector<Entry> m_indexedEntries;
+	cv::Ptr<cv::flann::Index> mp_index;
+	cv::Mat m_pending;                            // descriptors added since the last rebuild of the index
+	std::vector<Entry> m_pendingEntries;
+	std::deque<std::pair<cv::Mat, std::vector<Entry>>> m_history; // descriptors of previous frames
+	int m_framesSinceRebuild = 0;
+	int m_descriptorType     = -1;
+	int m_descriptorSize     = 0;
+	uint64_t m_nbQueries     = 0;
+	uint64_t m_nbMatches     = 0;
+};
+
+
+} // namespace mk
+#endif
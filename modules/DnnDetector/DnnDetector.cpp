@@ -0,0 +1,145 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "DnnDetector.h"
+#include "StreamImage.h"
+#include "StreamObject.h"
+#include "StreamDebug.h"
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+log4cxx::LoggerPtr DnnDetector::m_logger(log4cxx::Logger::getLogger("DnnDetector"));
+
+DnnDetector::DnnDetector(ParameterStructure& xr_params) :
+	Module(xr_params),
+	m_param(dynamic_cast<Parameters&>(xr_params)),
+	m_input(Size(m_param.width, m_param.height), m_param.type)
+{
+	AddInputStream(0, new StreamImage("image", m_input, *this,       "Video input"));
+	AddInputStream(1, new StreamObject("objects", m_objects, *this,  "Optional objects: regions to process, each one is resized to the input of the network"));
+
+	AddOutputStream(0, new StreamObject("detected", m_detectedObjects, *this, "Detected objects, with their class and confidence"));
+#ifdef MARKUS_DEBUG_STREAMS
+	m_debug = Mat(Size(m_param.width, m_param.height), CV_8UC3);
+	AddDebugStream(0, new StreamDebug("debug", m_debug, *this, ""));
+#endif
+
+	m_isUnitTestingEnabled = false; // a trained network is needed
+}
+
+DnnDetector::~DnnDetector()
+{
+}
+
+void DnnDetector::Reset()
+{
+	Module::Reset();
+	// note: the worker is shared with the other modules that use the same network
+	mp_worker = InferenceWorker::Get(InferenceWorker::Settings{m_param.modelFile, m_param.configFile, Size(m_param.inputWidth, m_param.inputHeight),
+		m_param.scaleFactor, m_param.mean, m_param.swapRB, m_param.maxBatchSize, m_param.maxLatency});
+}
+
+void DnnDetector::ProcessFrame()
+{
+	if(m_input.channels() == 1)
+		cvtColor(m_input, m_color, CV_GRAY2BGR);
+	else
+		m_color = m_input;
+
+	// Regions to process: the whole image or the objects
+	m_regions.clear();
+	if(GetInputStreamByName("objects").IsConnected())
+	{
+		for(const auto& elem : m_objects)
+		{
+			Rect rect = elem.GetRect() & Rect(Point(0, 0), m_color.size());
+			if(rect.area() > 0)
+				m_regions.push_back(rect);
+		}
+	}
+	else m_regions.push_back(Rect(Point(0, 0), m_color.size()));
+
+	// note: all regions are queued before waiting, so that they are processed in the same batch
+	m_results.clear();
+	for(const auto& elem : m_regions)
+		m_results.push_back(mp_worker->Push(m_color(elem)));
+	// note: if no other module uses the network, there is nothing to wait for to complete the batch
+	if(mp_worker.use_count() == 1)
+		mp_worker->Submit();
+
+	m_detectedObjects.clear();
+	const double diagonal = sqrt(m_param.width * m_param.width + m_param.height * m_param.height);
+	for(size_t i = 0 ; i < m_regions.size() ; i++)
+	{
+		const Rect& region(m_regions[i]);
+		Mat detections = m_results[i].get();
+		if(detections.cols != 7)
+			throw MkException("The network of DnnDetector must have a detection output", LOC);
+
+		for(int j = 0 ; j < detections.rows ; j++)
+		{
+			const float* row = detections.ptr<float>(j);
+			const int classIndex = cvRound(row[1]);
+			if(row[2] < m_param.confidenceThreshold || (m_param.classIndex >= 0 && classIndex != m_param.classIndex))
+				continue;
+			// note: coordinates are relative to the region
+			Point tl(cvRound(region.x + row[3] * region.width), cvRound(region.y + row[4] * region.height));
+			Point br(cvRound(region.x + row[5] * region.width), cvRound(region.y + row[6] * region.height));
+			Rect rect = Rect(tl, br) & region;
+			if(rect.area() == 0)
+				continue;
+
+			Object obj(m_param.objectLabel, rect);
+			obj.AddFeature("x"          , new FeatureFloat(obj.posX   / diagonal));
+			obj.AddFeature("y"          , new FeatureFloat(obj.posY   / diagonal));
+			obj.AddFeature("width"      , new FeatureFloat(obj.width  / diagonal));
+			obj.AddFeature("height"     , new FeatureFloat(obj.height / diagonal));
+			obj.AddFeature("class"      , new FeatureFloat(classIndex));
+			obj.AddFeature("confidence" , new FeatureFloat(row[2]));
+			m_detectedObjects.push_back(obj);
+		}
+	}
+
+#ifdef MARKUS_DEBUG_STREAMS
+	m_color.copyTo(m_debug);
+	for(const auto& elem : m_regions)
+		rectangle(m_debug, elem, Scalar(0, 255, 0), 1, 8, 0);
+	for(const auto& obj : m_detectedObjects)
+		rectangle(m_debug, obj.GetRect(), Scalar(255, 0, 23), 1, 8, 0);
+#endif
+}
+
+void DnnDetector::PrintStatistics(mkconf& xr_result) const
+{
+	Module::PrintStatistics(xr_result);
+	if(mp_worker == nullptr || mp_worker->GetNbBatches() == 0)
+		return;
+	// note: the worker may be shared, the statistics are the ones of all modules
+	double batchSize = static_cast<double>(mp_worker->GetNbImages()) / mp_worker->GetNbBatches();
+	LOG_INFO(m_logger, "Module " << GetName() << ": the shared worker processed " << mp_worker->GetNbImages() << " images with an average batch size of " << batchSize);
+	xr_result["module"][GetName()]["averageBatchSize"] = batchSize;
+}
+} // namespace mk
@@ -0,0 +1,112 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef DNN_DETECTOR_H
+#define DNN_DETECTOR_H
+
+#include <future>
+#include "Module.h"
+#include "StreamObject.h"
+#include "InferenceWorker.h"
+
+namespace mk {
+/**
+* @brief Detect objects with a neural network (e.g. SSD) on CPU. The images, or the regions given by the objects input,
+*        are processed by batches in a worker shared by all modules with the same network.
+*/
+class DnnDetector : public Module
+{
+public:
+	class Parameters : public Module::Parameters
+	{
+	public:
+		explicit Parameters(const std::string& x_name) : Module::Parameters(x_name)
+		{
+			AddParameter(new ParameterString("modelFile",  "",                    &modelFile,           "File of the trained network (Caffe, TensorFlow, Torch or Darknet)"));
+			AddParameter(new ParameterString("configFile", "",                    &configFile,          "Optional file with the description of the network (e.g. .prototxt)"));
+			AddParameter(new ParameterInt("inputWidth",    300, 1, 2048,          &inputWidth,          "Width of the input of the network"));
+			AddParameter(new ParameterInt("inputHeight",   300, 1, 2048,          &inputHeight,         "Height of the input of the network"));
+			AddParameter(new ParameterDouble("scaleFactor", 0.007843, 0, 1000,    &scaleFactor,         "Factor applied to pixel values, after subtracting the mean"));
+			AddParameter(new ParameterDouble("mean",       127.5, 0, 255,         &mean,                "Mean subtracted to pixel values"));
+			AddParameter(new ParameterBool("swapRB",       false,                 &swapRB,              "Swap the red and blue channels"));
+			AddParameter(new ParameterDouble("confidenceThreshold", 0.5, 0, 1,    &confidenceThreshold, "Minimal confidence of a detection"));
+			AddParameter(new ParameterInt("classIndex",    -1, -1, 10000,         &classIndex,          "Only keep the objects of this class (-1: all classes)"));
+			AddParameter(new ParameterString("objectLabel", "dnn",                &objectLabel,         "Label to be applied to the detected objects"));
+			AddParameter(new ParameterInt("maxBatchSize",  8, 1, 256,             &maxBatchSize,        "Maximal number of images processed together by the shared worker"));
+			AddParameter(new ParameterDouble("maxLatency", 0.02, 0, 1,            &maxLatency,          "Maximal time waited to complete a batch with the images of other modules using the same network [s]"));
+
+			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1","CV_8UC3"]})"_json);
+			RefParameterByName("type").SetDefaultAndValue("CV_8UC3");
+		};
+		std::string modelFile;
+		std::string configFile;
+		int inputWidth;
+		int inputHeight;
+		double scaleFactor;
+		double mean;
+		bool swapRB;
+		double confidenceThreshold;
+		int classIndex;
+		std::string objectLabel;
+		int maxBatchSize;
+		double maxLatency;
+	};
+
+	explicit DnnDetector(ParameterStructure& xr_params);
+	~DnnDetector() override;
+	MKCLASS("DnnDetector")
+	MKCATEG("Other")
+	MKDESCR("Detect objects with a neural network, frames and regions of different modules are processed by batches")
+
+private:
+	const Parameters& m_param;
+	static log4cxx::LoggerPtr m_logger;
+
+protected:
+	void Reset() override;
+	void ProcessFrame() override;
+	void PrintStatistics(mkconf& xr_result) const override;
+
+	// state
+	std::shared_ptr<InferenceWorker> mp_worker;
+
+	// input
+	cv::Mat m_input;
+	std::vector<Object> m_objects;
+
+	// output
+	std::vector<Object> m_detectedObjects;
+
+	// temporary
+	cv::Mat m_color;
+	std::vector<cv::Rect> m_regions;
+	std::vector<std::future<cv::Mat>> m_results;
+
+	// debug
+#ifdef MARKUS_DEBUG_STREAMS
+	cv::Mat m_debug;
+#endif
+};
+
+} // namespace mk
+#endif
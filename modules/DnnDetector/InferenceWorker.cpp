@@ -0,0 +1,160 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "InferenceWorker.h"
+#include "MkException.h"
+#include "define.h"
+#include <sstream>
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+log4cxx::LoggerPtr InferenceWorker::m_logger(log4cxx::Logger::getLogger("InferenceWorker"));
+mutex InferenceWorker::m_registryMutex;
+map<string, weak_ptr<InferenceWorker>> InferenceWorker::m_registry;
+
+InferenceWorker::InferenceWorker(const Settings& x_settings) :
+	m_settings(x_settings),
+	m_queue(x_settings.maxBatchSize, x_settings.maxLatency, 4 * x_settings.maxBatchSize, [this](vector<Request>& xr_batch){Infer(xr_batch);})
+{
+	m_net = dnn::readNet(m_settings.modelFile, m_settings.configFile);
+	if(m_net.empty())
+		throw MkException("Impossible to load the network " + m_settings.modelFile + " " + m_settings.configFile, LOC);
+	m_net.setPreferableBackend(dnn::DNN_BACKEND_OPENCV);
+	m_net.setPreferableTarget(dnn::DNN_TARGET_CPU);
+}
+
+/**
+* @brief Return the worker of a network, it is created if no other module uses it
+*
+* @param x_settings Settings of the network
+*
+* @return The worker
+*/
+shared_ptr<InferenceWorker> InferenceWorker::Get(const Settings& x_settings)
+{
+	stringstream key;
+	key << x_settings.modelFile << "|" << x_settings.configFile << "|" << x_settings.inputSize << "|"
+		<< x_settings.scaleFactor << "|" << x_settings.mean << "|" << x_settings.swapRB;
+
+	unique_lock<mutex> lock(m_registryMutex);
+	// note: remove the workers of networks that are not used anymore
+	for(auto it = m_registry.begin() ; it != m_registry.end() ; )
+	{
+		if(it->second.expired())
+			it = m_registry.erase(it);
+		else
+			++it;
+	}
+	shared_ptr<InferenceWorker> worker = m_registry[key.str()].lock();
+	if(worker == nullptr)
+	{
+		LOG_INFO(m_logger, "Create an inference worker for network " << key.str());
+		worker = make_shared<InferenceWorker>(x_settings);
+		m_registry[key.str()] = worker;
+	}
+	return worker;
+}
+
+/**
+* @brief Queue an image for inference. The image must stay valid until the result is available
+*
+* @param x_image Image (CV_8UC3)
+*
+* @return The output of the network for this image
+*/
+future<Mat> InferenceWorker::Push(const Mat& x_image)
+{
+	Request request{x_image, promise<Mat>()};
+	future<Mat> result = request.result.get_future();
+	m_queue.Push(std::move(request));
+	return result;
+}
+
+/// Run the network on a batch of images, in the thread of the queue
+void InferenceWorker::Infer(vector<Request>& xr_batch)
+{
+	try
+	{
+		m_images.clear();
+		for(const auto& elem : xr_batch)
+			m_images.push_back(elem.image);
+		Mat blob = dnn::blobFromImages(m_images, m_settings.scaleFactor, m_settings.inputSize,
+			Scalar::all(m_settings.mean), m_settings.swapRB, false);
+		m_net.setInput(blob);
+		Mat output = m_net.forward();
+		m_results.assign(xr_batch.size(), Mat());
+		SplitOutput(output, m_results);
+		for(size_t i = 0 ; i < xr_batch.size() ; i++)
+			xr_batch[i].result.set_value(m_results[i]);
+	}
+	catch(...)
+	{
+		// note: the error is given to each module waiting for its result
+		for(auto& elem : xr_batch)
+		{
+			try
+			{
+				elem.result.set_exception(current_exception());
+			}
+			catch(future_error&) {} // the result was already set
+		}
+	}
+}
+
+/**
+* @brief Route the output of the network to each image of the batch
+*
+* @param x_output   Output of the network for the batch
+* @param xr_results Output for each image: the rows of detections (image index, class, confidence, left, top, right, bottom)
+*                   for a detection network, the flattened output otherwise
+*/
+void InferenceWorker::SplitOutput(const Mat& x_output, vector<Mat>& xr_results) const
+{
+	const int nb = xr_results.size();
+	if(x_output.dims == 4 && x_output.size[0] == 1 && x_output.size[1] == 1 && x_output.size[3] == 7)
+	{
+		// detection output: all detections of the batch, the first column is the index of the image
+		Mat rows(x_output.size[2], 7, CV_32F, const_cast<uchar*>(x_output.ptr()));
+		for(auto& elem : xr_results)
+			elem.create(0, 7, CV_32F);
+		for(int i = 0 ; i < rows.rows ; i++)
+		{
+			const int index = cvRound(rows.at<float>(i, 0));
+			if(index >= 0 && index < nb)
+				xr_results[index].push_back(rows.row(i));
+		}
+	}
+	else if(x_output.dims >= 2 && x_output.size[0] == nb)
+	{
+		// one output per image
+		// note: the output of the network is continuous
+		Mat flat(nb, x_output.total() / nb, x_output.type(), const_cast<uchar*>(x_output.ptr()));
+		for(int i = 0 ; i < nb ; i++)
+			xr_results[i] = flat.row(i).clone();
+	}
+	else throw MkException("Unexpected size of the output of the network", LOC);
+}
+
+} // namespace mk
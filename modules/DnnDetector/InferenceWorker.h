@@ -0,0 +1,92 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_INFERENCE_WORKER_H
+#define MK_INFERENCE_WORKER_H
+
+#include <log4cxx/logger.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/dnn.hpp>
+#include <boost/noncopyable.hpp>
+#include <future>
+#include <memory>
+#include <map>
+#include "BatchQueue.h"
+
+namespace mk {
+
+/**
+* @brief Run a neural network on images by batches, in a background thread. A worker is shared by all modules using
+*        the same network: requests of different modules (e.g. different cameras) and different regions are grouped
+*        in the same batch. A batch is run when it is full, when the maximal latency has elapsed or when it is submitted
+*        (e.g. by the only module that uses the network).
+*/
+class InferenceWorker : boost::noncopyable
+{
+public:
+	/// Settings of the network. The ones of the batches are given by the first module that uses the worker
+	struct Settings
+	{
+		std::string modelFile;
+		std::string configFile;
+		cv::Size inputSize;
+		double scaleFactor;
+		double mean;
+		bool swapRB;
+		int maxBatchSize;
+		double maxLatency;   // [s]
+	};
+
+	explicit InferenceWorker(const Settings& x_settings);
+	static std::shared_ptr<InferenceWorker> Get(const Settings& x_settings);
+	std::future<cv::Mat> Push(const cv::Mat& x_image);
+	inline void Submit() {m_queue.Submit();}
+
+	inline uint64_t GetNbImages() const {return m_queue.GetNbWritten();}
+	inline uint64_t GetNbBatches() const {return m_queue.GetNbBatches();}
+
+protected:
+	/// An image to process and the promise of the output of the network
+	struct Request
+	{
+		cv::Mat image;
+		std::promise<cv::Mat> result;
+	};
+	void Infer(std::vector<Request>& xr_batch);
+	void SplitOutput(const cv::Mat& x_output, std::vector<cv::Mat>& xr_results) const;
+
+	const Settings m_settings;
+	cv::dnn::Net m_net;
+	std::vector<cv::Mat> m_images;
+	std::vector<cv::Mat> m_results;
+	BatchQueue<Request> m_queue; // note: must be destroyed first, since its thread uses the network
+
+	static std::mutex m_registryMutex;
+	static std::map<std::string, std::weak_ptr<InferenceWorker>> m_registry;
+
+private:
+	static log4cxx::LoggerPtr m_logger;
+};
+
+} // namespace mk
+#endif
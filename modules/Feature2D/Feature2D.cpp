@@ -63,8 +63,18 @@ void Feature2D::Reset()
 	//	cout<<*it<<endl;
 
 	Module::Reset();
-	mp_detector.release();
-	mp_detector = create(m_param.create);
+	// note: detectors are not guaranteed to be thread safe: create one per worker
+	m_detectors.resize(max(1, getNumThreads()));
+	for(auto& elem : m_detectors)
+	{
+		elem.release();
+		elem = create(m_param.create);
+	}
+
+	// FeatureBinaryDescriptor compares single bits: descriptors made of 2-bit cells (e.g. ORB with WTA_K 3 or 4) would
+	// not be compared with the distance they were designed for
+	if(m_param.computeFeatures && m_detectors.front()->defaultNorm() == NORM_HAMMING2)
+		throw MkException("Descriptors with a 2-bit Hamming norm (e.g. ORB with WTA_K > 2) are not supported", LOC);
 
 	/*
 	mp_descriptor.release();
@@ -84,72 +94,28 @@ void Feature2D::ProcessFrame()
 #ifdef MARKUS_DEBUG_STREAMS
 	cvtColor(m_input, m_debug, CV_GRAY2RGB);
 #endif
-	//compute each object to find point of interest
+	// Process the objects in parallel: each worker uses its own detector
+	const size_t nbObjects = m_objectsIn.size();
+	const size_t nbWorkers = min(m_detectors.size(), nbObjects);
+	m_keyPoints.resize(nbObjects);
+	m_objectsByInput.resize(nbObjects);
+	parallelForEach(nbWorkers, [this, nbObjects, nbWorkers](int x_worker){
+		for(size_t i = x_worker ; i < nbObjects ; i += nbWorkers)
+			ProcessObject(*m_detectors.at(x_worker), i);
+	});
+
 	m_objectsOut.clear();
-	for(auto& obj1 : m_objectsIn)
+	for(size_t i = 0 ; i < nbObjects ; i++)
 	{
-		if(obj1.width < 8 || obj1.height < 8)
-		{
-			LOG_WARN(m_logger, "Object has insufficient size: "<<obj1.width<<"x"<<obj1.height);
-			continue;
-		}
-
-		obj1.Intersect(m_input);
-
-		//compute point of interest and add it to m_objectsOut
-		//this cause unit test fail
-		Mat subImage(m_input, obj1.GetRect());
-		vector<KeyPoint> pointsOfInterest;
-
-		mp_detector->detect(subImage, pointsOfInterest);
-		Mat descriptors;
-		if(m_param.computeFeatures)
-		{
-			mp_detector->compute(m_input, pointsOfInterest, descriptors);
-			assert(descriptors.rows == static_cast<int>(pointsOfInterest.size()));
-		}
-
-		//Mat subImage(m_input,obj1.GetRect());
-		//mp_detector->detect(subImage, pointsOfInterest);
-
-		int i = 0;
-
-		// For each keypoint create an output object
-		for(const auto& kp : pointsOfInterest)
-		{
-			// Create object from keypoint
-			Object obj("keypoint");
-			obj.posX = kp.pt.x + obj1.posX - obj1.width  / 2; // - 5;
-			obj.posY = kp.pt.y + obj1.posY - obj1.height / 2; // - 5;
-			obj.width  = kp.size;
-			obj.height = kp.size;
-			obj.Intersect(m_input);
-			obj.AddFeature("keypoint", new FeatureKeyPoint(kp));
-			obj.AddFeature("parent", new FeatureInt(obj1.GetId()));
-
-			if(m_param.computeFeatures)
-			{
-				// Add descriptor
-				if(descriptors.type() != CV_32FC1)
-				{
-					descriptors.convertTo(descriptors, CV_32FC1);
-				}
-				vector<float> vect(descriptors.cols, 0);
-				descriptors.row(i).copyTo(vect);
-				obj.AddFeature("descriptor", new FeatureVectorFloat(vect));
-			}
-
-			m_objectsOut.push_back(obj);
-			i++;
-		}
+		m_objectsOut.insert(m_objectsOut.end(), m_objectsByInput[i].begin(), m_objectsByInput[i].end());
 
 #ifdef MARKUS_DEBUG_STREAMS
 		// Scalar color = Scalar(22, 88, 255);
 		// drawKeypoints(m_debug, pointsOfInterest, m_debug, color);
 
-		for(const auto& elem : pointsOfInterest)
+		for(const auto& elem : m_keyPoints[i])
 		{
-			Point2d point = Point2d(elem.pt.x, elem.pt.y) + obj1.TopLeft();
+			Point2d point = Point2d(elem.pt.x, elem.pt.y) + m_objectsIn[i].TopLeft();
 			Scalar color = Scalar(22, 88, elem.response);
 			circle(m_debug, point, elem.size, color);
 			line(m_debug, point, point + Point2d(
@@ -159,7 +125,92 @@ void Feature2D::ProcessFrame()
 		}
 #endif
 	}
+}
+
+/**
+* @brief Detect the keypoints of an object and compute their descriptors
+*
+* @param xr_detector Detector used by the current worker
+* @param x_index     Index of the incoming object
+*/
+void Feature2D::ProcessObject(cv::Feature2D& xr_detector, size_t x_index)
+{
+	Object& obj1(m_objectsIn.at(x_index));
+	vector<KeyPoint>& pointsOfInterest(m_keyPoints.at(x_index));
+	vector<Object>& objectsOut(m_objectsByInput.at(x_index));
+	pointsOfInterest.clear();
+	objectsOut.clear();
+
+	if(obj1.width < 8 || obj1.height < 8)
+	{
+		LOG_WARN(m_logger, "Object has insufficient size: "<<obj1.width<<"x"<<obj1.height);
+		return;
+	}
+
+	obj1.Intersect(m_input);
+
+	//compute point of interest and add it to m_objectsOut
+	const Rect rect(obj1.GetRect());
+	xr_detector.detect(m_input(rect), pointsOfInterest);
+
+	Mat descriptors;
+	if(m_param.computeFeatures)
+	{
+		// The descriptors are computed on a view of the image around the object, the margin gives the context of the
+		// keypoints close to the border. Keypoints without enough context may be removed by the descriptor.
+		Rect view(rect.x - m_param.descriptorMargin, rect.y - m_param.descriptorMargin,
+			rect.width + 2 * m_param.descriptorMargin, rect.height + 2 * m_param.descriptorMargin);
+		view &= Rect(Point(0, 0), m_input.size());
+		const Point2f offset(rect.tl() - view.tl());
+		for(auto& elem : pointsOfInterest)
+			elem.pt += offset;
+		xr_detector.compute(m_input(view), pointsOfInterest, descriptors);
+		for(auto& elem : pointsOfInterest)
+			elem.pt -= offset;
+		assert(descriptors.rows == static_cast<int>(pointsOfInterest.size()));
+	}
+
+	int i = 0;
+
+	// For each keypoint create an output object
+	for(const auto& kp : pointsOfInterest)
+	{
+		// Create object from keypoint
+		Object obj("keypoint");
+		obj.posX = kp.pt.x + obj1.posX - obj1.width  / 2; // - 5;
+		obj.posY = kp.pt.y + obj1.posY - obj1.height / 2; // - 5;
+		obj.width  = kp.size;
+		obj.height = kp.size;
+		obj.Intersect(m_input);
+		obj.AddFeature("keypoint", new FeatureKeyPoint(kp));
+		obj.AddFeature("parent", new FeatureInt(obj1.GetId()));
+
+		if(m_param.computeFeatures)
+		{
+			// Add descriptor: binary descriptors (ORB, BRISK, AKAZE, ...) are kept in their native 8-bit form
+			if(descriptors.depth() == CV_8U && xr_detector.defaultNorm() == NORM_HAMMING)
+			{
+				BinaryDescriptor desc;
+				descriptors.row(i).copyTo(desc.bytes);
+				obj.AddFeature("descriptor", new FeatureBinaryDescriptor(desc));
+			}
+			else if(descriptors.depth() == CV_8U)
+			{
+				vector<uchar> vect(descriptors.cols, 0);
+				descriptors.row(i).copyTo(vect);
+				obj.AddFeature("descriptor", new FeatureVectorUChar(vect));
+			}
+			else
+			{
+				vector<float> vect(descriptors.cols, 0);
+				descriptors.row(i).convertTo(vect, CV_32F);
+				obj.AddFeature("descriptor", new FeatureVectorFloat(vect));
+			}
+		}
 
+		objectsOut.push_back(obj);
+		i++;
+	}
 }
 
 } // namespace mk
@@ -93,6 +93,7 @@ public:
 		{
 			AddParameter(new ParameterT<CreationFunction>("create", R"({"name": "ORB", "number": 0, "parameters":{}})"_json, &create, "The parameters to pass to the create method method of ORB, BRIEF, ..."));
 			AddParameter(new ParameterT<bool>("computeFeatures", false, &computeFeatures, "Compute the features associated with the keypoints."));
+			AddParameter(new ParameterInt("descriptorMargin", 64, 0, 256, &descriptorMargin, "Margin around each object, used as context to compute the descriptors of its keypoints"));
 
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1"]})"_json);
 			RefParameterByName("width").SetRange(R"({"min":64, "max":6400})"_json);
@@ -100,6 +101,7 @@ public:
 		};
 		CreationFunction create;
 		bool computeFeatures;
+		int descriptorMargin;
 	};
 	MKCLASS("Feature2D")
 	MKCATEG("KeyPoints")
@@ -117,6 +119,7 @@ private:
 protected:
 	void ProcessFrame() override;
 	void Reset() override;
+	void ProcessObject(cv::Feature2D& xr_detector, size_t x_index);
 
 	// input
 	cv::Mat m_input;
@@ -126,9 +129,13 @@ protected:
 	std::vector <Object> m_objectsOut;
 
 	// state variables
-	cv::Ptr<cv::Feature2D>     mp_detector;
+	std::vector<cv::Ptr<cv::Feature2D>> m_detectors; // one detector per worker, objects are processed in parallel
 	// cv::Ptr<cv::DescriptorExtractor> mp_descriptor;
 
+	// temporary
+	std::vector<std::vector<cv::KeyPoint>> m_keyPoints;   // keypoints of each incoming object
+	std::vector<std::vector<Object>>       m_objectsByInput; // output objects of each incoming object
+
 #ifdef MARKUS_DEBUG_STREAMS
 	cv::Mat m_debug;
 #endif
@@ -70,7 +70,8 @@ void GroundTruthReader::Reset()
 	trackedObj.clear();
 
 	CLEAN_DELETE(mp_annotationReader);
-	m_assFile = (m_param.file.substr(m_param.file.find_last_of(".") + 1) == "ass");
+	const string name = uncompressedFileName(m_param.file);
+	m_assFile = (name.substr(name.find_last_of(".") + 1) == "ass");
 	if(m_assFile)
 	{
 		const double diagonal = sqrt(m_param.width * m_param.width + m_param.height * m_param.height);
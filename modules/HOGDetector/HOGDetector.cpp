@@ -24,6 +24,7 @@
 #include "HOGDetector.h"
 #include "StreamImage.h"
 #include "StreamObject.h"
+#include "StreamPyramid.h"
 #include "StreamDebug.h"
 #include "Timer.h"
 
@@ -38,9 +39,13 @@ log4cxx::LoggerPtr HOGDetector::m_logger(log4cxx::Logger::getLogger("HOGDetector
 
 HOGDetector::HOGDetector(ParameterStructure& xr_params)
 	: Module(xr_params), m_param(dynamic_cast<Parameters&>(xr_params)),
-	  m_input(Size(m_param.width, m_param.height), m_param.type)
+	  m_input(Size(m_param.width, m_param.height), m_param.type),
+	  m_mask(Size(m_param.width, m_param.height), CV_8UC1)
 {
 	AddInputStream(0, new StreamImage("image", m_input, *this, 		"Video input"));
+	AddInputStream(1, new StreamImage("mask", m_mask, *this, 		"Optional mask of the regions to scan (e.g. foreground)"));
+	AddInputStream(2, new StreamObject("objects", m_objects, *this, 	"Optional objects: regions to scan"));
+	AddInputStream(3, new StreamPyramid("pyramid", m_pyramid, *this, 	"Optional pyramid of the input image, shared with other detectors. If connected, its scales are scanned instead of the ones given by scaleFactor"));
 
 	AddOutputStream(0, new StreamObject("detected", m_detectedObjects, /*colorFromStr(m_param.color),*/ *this,	"Detected objects"));
 #ifdef MARKUS_DEBUG_STREAMS
@@ -57,17 +62,18 @@ void HOGDetector::Reset()
 {
 	Module::Reset();
 	m_hog.setSVMDetector(HOGDescriptor::getDefaultPeopleDetector());
+	m_roi.Reset();
+	m_scheduler.Reset();
 }
 
 // This method launches the thread
 void HOGDetector::ProcessFrame()
 {
-	Mat smallImg(m_input);
-	// equalizeHist( smallImg, smallImg );
-
+	// Detection on key frames only, objects are tracked in between
 	std::vector<cv::Rect> detected;
-
-	m_hog.detectMultiScale(smallImg, detected, 0, Size(8,8), Size(32,32), m_param.scaleFactor, 2);
+	if(!m_scheduler.Process(m_input, m_param.detectionInterval, m_param.maxDetectionInterval, m_param.activityThreshold, GetFps(),
+			[this](vector<Rect>& xr_detected){Detect(xr_detected);}, detected))
+		m_roi.Skip(GetSize());
 
 	const double diagonal = sqrt(m_param.width * m_param.width + m_param.height * m_param.height);
 	m_detectedObjects.clear();
@@ -91,7 +97,96 @@ void HOGDetector::ProcessFrame()
 		// Draw the rectangle in the input image
 		rectangle(m_debug, elem.GetRect(), Scalar(255, 0, 33), 1, 8, 0 );
 	}
+	for(const auto& elem : m_roi.GetRegions())
+		rectangle(m_debug, elem, Scalar(0, 255, 0), 1, 8, 0);
 #endif
 }
 
+/**
+* @brief Run the detection on the regions of interest
+*
+* @param xr_detected Detected rectangles
+*/
+void HOGDetector::Detect(vector<Rect>& xr_detected)
+{
+	// Regions to scan: the whole image or the regions given by the mask and objects inputs
+	m_roi.Select(GetInputStreamByName("mask").IsConnected() ? &m_mask : nullptr, GetInputStreamByName("objects").IsConnected() ? &m_objects : nullptr,
+		GetNbTiles(), m_param.roiMargin, m_hog.winSize, GetSize(), m_param.maxRoiRatio);
+
+	// Detection
+	if(GetInputStreamByName("pyramid").IsConnected())
+	{
+		DetectOnPyramid(xr_detected);
+	}
+	else
+	{
+		std::vector<cv::Rect> detectedInRegion;
+		for(const auto& region : m_roi.GetRegions())
+		{
+			Mat smallImg(m_input(region));
+			// equalizeHist( smallImg, smallImg );
+			m_hog.detectMultiScale(smallImg, detectedInRegion, 0, Size(8,8), Size(32,32), m_param.scaleFactor, 2);
+			for(const auto& elem : detectedInRegion)
+				xr_detected.push_back(elem + region.tl());
+		}
+	}
+}
+
+/**
+* @brief Detect on all levels of the pyramid in parallel, the detections of all levels are then grouped as
+*        detectMultiScale does
+*
+* @param xr_detected Detected rectangles, in the coordinates of the input image
+*/
+void HOGDetector::DetectOnPyramid(vector<Rect>& xr_detected)
+{
+	m_detectedByLevel.resize(m_pyramid.GetNbLevels());
+	// note: the detection method of HOGDescriptor is const and can be called by several threads
+	parallelForEach(m_pyramid.GetNbLevels(), [this](int i){DetectOnLevel(i);});
+
+	for(const auto& elem : m_detectedByLevel)
+		xr_detected.insert(xr_detected.end(), elem.begin(), elem.end());
+	groupRectangles(xr_detected, 2, 0.2);
+}
+
+/**
+* @brief Detect on one level of the pyramid: only the size of the window of the descriptor is scanned
+*
+* @param x_level    Index of the level
+*/
+void HOGDetector::DetectOnLevel(size_t x_level)
+{
+	vector<Rect>& detected(m_detectedByLevel.at(x_level));
+	detected.clear();
+	const Mat& image(m_pyramid.GetLevel(x_level));
+	// note: the pyramid may have a different resolution than the module
+	const double scaleX = static_cast<double>(m_param.width)  / image.cols;
+	const double scaleY = static_cast<double>(m_param.height) / image.rows;
+	if(m_hog.winSize.width * scaleX < m_param.minSide || m_hog.winSize.height * scaleY < m_param.minSide)
+		return;
+
+	vector<Point> found;
+	vector<double> weights;
+	for(const auto& region : m_roi.GetRegions())
+	{
+		Rect scaled(cvFloor(region.x / scaleX), cvFloor(region.y / scaleY), cvCeil(region.width / scaleX), cvCeil(region.height / scaleY));
+		scaled &= Rect(Point(0, 0), image.size());
+		if(scaled.width < m_hog.winSize.width || scaled.height < m_hog.winSize.height)
+			continue;
+		m_hog.detect(image(scaled), found, weights, 0, Size(8,8), Size(32,32));
+		for(const auto& elem : found)
+		{
+			detected.push_back(Rect(cvRound((elem.x + scaled.x) * scaleX), cvRound((elem.y + scaled.y) * scaleY),
+				cvRound(m_hog.winSize.width * scaleX), cvRound(m_hog.winSize.height * scaleY)));
+		}
+	}
+}
+
+void HOGDetector::PrintStatistics(mkconf& xr_result) const
+{
+	Module::PrintStatistics(xr_result);
+	m_roi.PrintStatistics(GetName(), xr_result);
+	m_scheduler.PrintStatistics(GetName(), xr_result);
+}
+
 } // namespace mk
@@ -28,6 +28,9 @@
 #include "Module.h"
 #include "Parameter.h"
 #include "StreamObject.h"
+#include "Pyramid.h"
+#include "DetectionScheduler.h"
+#include "RegionsOfInterest.h"
 
 namespace mk {
 /*! \class HOGDetector
@@ -48,6 +51,11 @@ public:
 			AddParameter(new ParameterFloat("scaleFactor", 1.2, 1, 2, 	&scaleFactor,	"Scale factor for scanning (higher: less sensitive)"));
 			// "File with filter data of the detected object"));
 			AddParameter(new ParameterString("objectLabel", "hog", 			&objectLabel,	"Label to be applied to the objects detected by the cascade filter (e.g. face)"));
+			AddParameter(new ParameterInt("roiMargin", 16, 0, 200, 		&roiMargin,	"Margin added around the regions of interest given by the mask and objects inputs"));
+			AddParameter(new ParameterDouble("maxRoiRatio", 0.5, 0, 1, 	&maxRoiRatio,	"If the regions of interest cover more than this part of the image, the whole image is scanned"));
+			AddParameter(new ParameterInt("detectionInterval", 1, 1, 1000, 	&detectionInterval,	"Number of frames between two detections, in between objects are tracked by template matching (1: detect on all frames)"));
+			AddParameter(new ParameterInt("maxDetectionInterval", 25, 1, 1000, &maxDetectionInterval, "If fps is set, the interval between detections is increased up to this value to meet the fps"));
+			AddParameter(new ParameterDouble("activityThreshold", 0, 0, 1, 	&activityThreshold,	"Fraction of the image changed since the last detection that triggers a new detection (0: disabled)"));
 
 			// Limit size to accelerate unit tests
 			RefParameterByName("width").SetDefaultAndValue(320);
@@ -61,6 +69,11 @@ public:
 		int minSide;
 		float scaleFactor;
 		std::string objectLabel;
+		int roiMargin;
+		double maxRoiRatio;
+		int detectionInterval;
+		int maxDetectionInterval;
+		double activityThreshold;
 	};
 
 	explicit HOGDetector(ParameterStructure& xr_params);
@@ -76,16 +89,28 @@ private:
 protected:
 	void Reset() override;
 	void ProcessFrame() override;
+	void PrintStatistics(mkconf& xr_result) const override;
+	void Detect(std::vector<cv::Rect>& xr_detected);
+	void DetectOnPyramid(std::vector<cv::Rect>& xr_detected);
+	void DetectOnLevel(size_t x_level);
 
 	// state
 	cv::HOGDescriptor m_hog;
+	DetectionScheduler m_scheduler;
 
 	// input
 	cv::Mat m_input;
+	cv::Mat m_mask;
+	std::vector<Object> m_objects;
+	Pyramid m_pyramid;
 
 	// output
 	std::vector<Object> m_detectedObjects;
 
+	// temporary
+	RegionsOfInterest m_roi;
+	std::vector<std::vector<cv::Rect>> m_detectedByLevel;
+
 	// debug
 #ifdef MARKUS_DEBUG_STREAMS
 	cv::Mat m_debug;
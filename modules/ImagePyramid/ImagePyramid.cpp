@@ -0,0 +1,51 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "ImagePyramid.h"
+#include "StreamImage.h"
+#include "StreamPyramid.h"
+
+namespace mk {
+using namespace cv;
+
+log4cxx::LoggerPtr ImagePyramid::m_logger(log4cxx::Logger::getLogger("ImagePyramid"));
+
+ImagePyramid::ImagePyramid(ParameterStructure& xr_params) :
+	Module(xr_params),
+	m_param(dynamic_cast<Parameters&>(xr_params)),
+	m_input(Size(m_param.width, m_param.height), m_param.type)
+{
+	AddInputStream(0, new StreamImage("image", m_input, *this, "Video input"));
+
+	AddOutputStream(0, new StreamPyramid("pyramid", m_pyramid, *this, "Pyramid of scaled images"));
+}
+
+ImagePyramid::~ImagePyramid()
+{
+}
+
+void ImagePyramid::ProcessFrame()
+{
+	m_pyramid.Build(m_input, m_param.scaleFactor, Size(m_param.minSide, m_param.minSide), m_param.maxLevels, m_param.equalize);
+}
+} // namespace mk
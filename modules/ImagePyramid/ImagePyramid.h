@@ -0,0 +1,79 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef IMAGE_PYRAMID_H
+#define IMAGE_PYRAMID_H
+
+#include "Module.h"
+#include "Pyramid.h"
+
+
+namespace mk {
+/**
+* @brief Build a pyramid of scaled images once per frame. The pyramid can be shared by several detectors
+*/
+class ImagePyramid : public Module
+{
+public:
+	class Parameters : public Module::Parameters
+	{
+	public:
+		explicit Parameters(const std::string& x_name) : Module::Parameters(x_name)
+		{
+			AddParameter(new ParameterDouble("scaleFactor", 1.2, 1.01, 2, &scaleFactor, "Ratio between the sizes of two consecutive levels"));
+			AddParameter(new ParameterInt("minSide",    24,  1, 500,      &minSide,     "Minimal side of the smallest level"));
+			AddParameter(new ParameterInt("maxLevels",  32,  1, 100,      &maxLevels,   "Maximal number of levels"));
+			AddParameter(new ParameterBool("equalize",  true,             &equalize,    "Equalize the histogram of the image before building the pyramid"));
+
+			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1"]})"_json);
+			RefParameterByName("type").SetDefaultAndValue("CV_8UC1");
+		};
+		double scaleFactor;
+		int minSide;
+		int maxLevels;
+		bool equalize;
+	};
+
+	explicit ImagePyramid(ParameterStructure& xr_params);
+	~ImagePyramid() override;
+	MKCLASS("ImagePyramid")
+	MKCATEG("Image")
+	MKDESCR("Build a pyramid of scaled images, to be shared by several detectors")
+
+private:
+	const Parameters& m_param;
+	static log4cxx::LoggerPtr m_logger;
+
+protected:
+	void ProcessFrame() override;
+
+	// input
+	cv::Mat m_input;
+
+	// output
+	Pyramid m_pyramid;
+};
+
+
+} // namespace mk
+#endif
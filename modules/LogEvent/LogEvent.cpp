@@ -61,7 +61,8 @@ void LogEvent::Reset()
 
 	CLEAN_DELETE(mp_annotationWriter);
 	mp_annotationWriter = new AnnotationFileWriter();
-	mp_annotationWriter->Open(RefContext().RefOutputDir().ReserveFile(m_param.file, m_nbReset));
+	m_annotationFile = RefContext().RefOutputDir().ReserveFile(m_param.file + AnnotationFileWriter::CompressedExtension(m_param.compression), m_nbReset);
+	mp_annotationWriter->Open(m_annotationFile, m_param.compression, m_param.compressionLevel);
 	m_saveImage1 = m_inputStreams.at("image")->IsConnected();
 	m_saveImage2 = m_inputStreams.at("mask")->IsConnected();
 
@@ -75,6 +76,8 @@ void LogEvent::ProcessFrame()
 		// Log the change in event
 		SaveImage(m_event);
 		WriteEvent();
+		// note: images must be written before the event is notified
+		ImageEncoder::Wait(m_pending);
 		// LOG_EVENT(m_logger, m_event.GetEventName());
 		m_event.Notify(GetContext());
 	}
@@ -90,7 +93,7 @@ void LogEvent::WriteEvent()
 }
 
 /// Save related images
-void LogEvent::SaveImage(Event& xr_event) const
+void LogEvent::SaveImage(Event& xr_event)
 {
 	const Object& obj(xr_event.GetObject());
 
@@ -98,14 +101,14 @@ void LogEvent::SaveImage(Event& xr_event) const
 	{
 		std::stringstream ss1;
 		ss1 << m_currentTimeStamp << "_" << xr_event.GetEventName() << "_global_1." << m_param.extension;
-		addExternalImage(m_inputIm1, "globalImage", mp_outputDir->ReserveFile(ss1.str()), xr_event);
+		m_pending.push_back(addExternalImage(m_inputIm1, "globalImage", mp_outputDir->ReserveFile(ss1.str()), xr_event, RefContext().RefImageEncoder(), m_param.quality));
 
 		if(obj.width > 0 && obj.height > 0)
 		{
 			std::stringstream ss2;
 			ss2 << m_currentTimeStamp << "_" << xr_event.GetEventName() << "_" << obj.GetName()<< obj.GetId() << "_1" << "." << m_param.extension;
 			// cout<<"Save image "<<obj.m_posX<<" "<<obj.m_posY<<endl;
-			addExternalImage((m_inputIm1)(obj.GetRect()), "objectImage", mp_outputDir->ReserveFile(ss2.str()), xr_event);
+			m_pending.push_back(addExternalImage((m_inputIm1)(obj.GetRect()), "objectImage", mp_outputDir->ReserveFile(ss2.str()), xr_event, RefContext().RefImageEncoder(), m_param.quality));
 		}
 	}
 
@@ -113,14 +116,14 @@ void LogEvent::SaveImage(Event& xr_event) const
 	{
 		std::stringstream ss1;
 		ss1 << m_currentTimeStamp << "_" << xr_event.GetEventName() << "_global_2." << m_param.extension;
-		addExternalImage(m_inputIm2, "globalMask", mp_outputDir->ReserveFile(ss1.str()), xr_event);
+		m_pending.push_back(addExternalImage(m_inputIm2, "globalMask", mp_outputDir->ReserveFile(ss1.str()), xr_event, RefContext().RefImageEncoder(), m_param.quality));
 
 		if(obj.width > 0 && obj.height > 0)
 		{
 			std::stringstream ss2;
 			ss2 << m_currentTimeStamp << "_" << xr_event.GetEventName() << "_" << obj.GetName()<< obj.GetId() << "_2" << "." << m_param.extension;
 			// cout<<"Save image "<<obj.m_posX<<" "<<obj.m_posY<<endl;
-			addExternalImage((m_inputIm2)(obj.GetRect()), "objectMask",  mp_outputDir->ReserveFile(ss2.str()), xr_event);
+			m_pending.push_back(addExternalImage((m_inputIm2)(obj.GetRect()), "objectMask",  mp_outputDir->ReserveFile(ss2.str()), xr_event, RefContext().RefImageEncoder(), m_param.quality));
 		}
 	}
 }
@@ -128,7 +131,7 @@ void LogEvent::SaveImage(Event& xr_event) const
 /// Compare the events previously detected with the ground truth file
 void LogEvent::CompareWithGroundTruth()
 {
-	if(m_param.gtCommand.empty())
+	if(m_param.gtCommand.empty() || m_annotationFile.empty())
 		return;
 	try
 	{
@@ -136,7 +139,7 @@ void LogEvent::CompareWithGroundTruth()
 		if(!m_param.gtFile.empty())
 			dir.Cp(m_param.gtFile);
 		stringstream cmd;
-		cmd<< m_param.gtCommand << " " << RefContext().RefOutputDir().GetPath() << "/" << m_param.file;
+		cmd<< m_param.gtCommand << " " << m_annotationFile;
 		if(m_param.gtFile.empty())
 			cmd<< " empty.srt"; // trick: give unexistant file as param
 		else
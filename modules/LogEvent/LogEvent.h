@@ -49,8 +49,11 @@ public:
 		{
 			AddParameter(new ParameterString("file"        , "event.%d.srt", &file      ,  "Name of the .srt file without extension"));
 			AddParameter(new ParameterDouble("duration"    , 5, 0, 600    , &duration  ,  "Duration of the event for logging in .srt file"));
+			AddParameter(new ParameterString("compression" , "none"       , &compression, "Compress the .srt file on the fly. The extension of the compression is added to the file name"));
+			AddParameter(new ParameterInt("compressionLevel", -1, -1, 9   , &compressionLevel, "Level of compression [1-9] for gzip, block size for bzip2. -1 for default"));
 			AddParameter(new ParameterString("folder"      , "events_img" , &folder    ,  "Name of the folder to create for images"));
 			AddParameter(new ParameterString("extension"   , "jpg"        , &extension ,  "Extension of the thumbnails. Determines the output format."));
+			AddParameter(new ParameterInt("quality"      , 95, 0, 100 , &quality  , "Quality of the encoding [0-100]. For png it determines the compression level"));
 
 			// The 4 gt_ parameters are only used for evaluation vs ground truth file
 			AddParameter(new ParameterString("gtCommand"  , ""           , &gtCommand ,  "The command to use for comparison with ground truthi, e.g. \"tools/evaluation/analyse_events.py -d 0 -t 8 -e intrusion\""));
@@ -59,11 +62,15 @@ public:
 
 			RefParameterByName("type").SetDefaultAndValue("CV_8UC3");
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1","CV_8UC3"]})"_json);
-			RefParameterByName("extension").SetRange(R"({"allowed":["jpg","png"]})"_json);
+			RefParameterByName("extension").SetRange(R"({"allowed":["jpg","png","webp"]})"_json);
+			RefParameterByName("compression").SetRange(R"({"allowed":["none","gzip","bzip2"]})"_json);
 		}
 		std::string file;
 		double duration;
+		std::string compression;
+		int compressionLevel;
 		std::string extension;
+		int quality;
 		std::string folder;
 		std::string gtCommand;
 		std::string gtFile;
@@ -83,7 +90,7 @@ private:
 protected:
 	void ProcessFrame() override;
 	void Reset() override;
-	void SaveImage(Event& xr_event) const;
+	void SaveImage(Event& xr_event);
 	bool IsInputProcessed() const override;
 	void WriteEvent();
 	void CompareWithGroundTruth();
@@ -96,7 +103,9 @@ protected:
 	// temporary
 	bool m_saveImage1 = false;
 	bool m_saveImage2 = false;
+	std::vector<std::future<void>> m_pending; // images being written
 	AnnotationFileWriter* mp_annotationWriter;
+	std::string m_annotationFile; // file written by the annotation writer, with path
 	std::unique_ptr<MkDirectory> mp_outputDir;
 };
 
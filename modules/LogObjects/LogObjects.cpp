@@ -43,34 +43,17 @@ LogObjects::LogObjects(ParameterStructure& xr_params)
 
 LogObjects::~LogObjects()
 {
-	Compress();
 	CLEAN_DELETE(mp_annotationWriter);
 }
 
-void LogObjects::Compress()
-{
-	if(!m_param.compress)
-		return;
-	string tarFile = RefContext().RefOutputDir().ReserveFile(m_param.file + ".%d.tar.bz", m_nbReset);
-	LOG_INFO(m_logger, "Compress objects to " << tarFile);
-	try
-	{
-		// Compress file and remove
-		SYSTEM("tar --remove-files -cjf " + tarFile + " -C " + RefContext().RefOutputDir().GetPath() + " " + m_param.file);
-	}
-	catch(MkException& e)
-	{
-		LOG_ERROR(m_logger, "Error while compressing objects");
-	}
-}
-
 void LogObjects::Reset()
 {
 	Module::Reset();
 
 	CLEAN_DELETE(mp_annotationWriter);
 	mp_annotationWriter = new AnnotationFileWriter();
-	mp_annotationWriter->Open(RefContext().RefOutputDir().ReserveFile(m_param.file, m_nbReset));
+	mp_annotationWriter->Open(RefContext().RefOutputDir().ReserveFile(m_param.file + AnnotationFileWriter::CompressedExtension(m_param.compression), m_nbReset),
+		m_param.compression, m_param.compressionLevel);
 }
 
 void LogObjects::ProcessFrame()
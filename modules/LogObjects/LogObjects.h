@@ -26,7 +26,6 @@
 
 #include "Module.h"
 #include "StreamObject.h"
-#include <fstream>
 #include "AnnotationFileWriter.h"
 
 
@@ -44,10 +43,14 @@ public:
 		explicit Parameters(const std::string& x_name) : Module::Parameters(x_name)
 		{
 			AddParameter(new ParameterString("file"   , "objects.%d.srt" , &file , "Name of the .srt file without extension"));
-			AddParameter(new ParameterBool("compress" , false            , &compress , "Compress the result as a tar.gz"));
+			AddParameter(new ParameterString("compression", "none"       , &compression      , "Compress the file on the fly. The extension of the compression is added to the file name"));
+			AddParameter(new ParameterInt("compressionLevel", -1, -1, 9   , &compressionLevel , "Level of compression [1-9] for gzip, block size for bzip2. -1 for default"));
+
+			RefParameterByName("compression").SetRange(R"({"allowed":["none","gzip","bzip2"]})"_json);
 		}
 		std::string file;
-		bool compress;
+		std::string compression;
+		int compressionLevel;
 	};
 
 	explicit LogObjects(ParameterStructure& xr_params);
@@ -56,8 +59,6 @@ public:
 	MKCATEG("Output")
 	MKDESCR("Read a stream of objects and log data to a text file")
 
-	void Compress();
-
 private:
 	const Parameters& m_param;
 	static log4cxx::LoggerPtr m_logger;
@@ -70,7 +71,6 @@ protected:
 	std::vector <Object> m_objectsIn;
 
 	// temporary
-	std::ofstream m_outputFile;
 	AnnotationFileWriter* mp_annotationWriter;
 };
 
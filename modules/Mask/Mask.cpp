@@ -59,9 +59,16 @@ void Mask::Reset()
 
 void Mask::ProcessFrame()
 {
-	threshold(m_mask, m_mask, 128, 255, THRESH_BINARY_INV);
-	m_input.copyTo(m_output, m_mask);
+	ProcessFrameByTiles();
 	// cvAnd(m_input, m_mask, m_output);
 };
 
+void Mask::ProcessTile(const Tile& x_tile)
+{
+	// note: the input image is written directly to m_output, pixels outside the mask are set to zero
+	Mat mask(m_mask(x_tile.roi));
+	threshold(mask, mask, 128, 255, THRESH_BINARY_INV);
+	m_output(x_tile.roi).setTo(Scalar::all(0), mask);
+}
+
 } // namespace mk
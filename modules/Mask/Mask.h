@@ -49,6 +49,7 @@ public:
 	MKCLASS("Mask")
 	MKCATEG("Image")
 	MKDESCR("Apply a binary mask to an image input")
+	bool IsFusable() const override {return true;}
 
 private:
 	const Parameters& m_param;
@@ -57,6 +58,7 @@ private:
 protected:
 	void ProcessFrame() override;
 	void Reset() override;
+	void ProcessTile(const Tile& x_tile) override;
 
 	// input
 	cv::Mat m_input;
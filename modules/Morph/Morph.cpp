@@ -54,6 +54,30 @@ void Morph::Reset()
 
 void Morph::ProcessFrame()
 {
-	morphologyEx(m_input, m_output, m_param.oper, m_element, Point(-1,-1), m_param.iterations);
+	ProcessFrameByTiles();
 };
+
+int Morph::GetTileHalo() const
+{
+	// note: each tile is processed with a halo large enough for all passes of the operator (opening, closing, ... use 2 passes)
+	int passes = (m_param.oper == MORPH_ERODE || m_param.oper == MORPH_DILATE) ? 1 : 2;
+	return passes * m_param.iterations * m_param.kernelSize;
+}
+
+void Morph::BeginTiles()
+{
+	m_tileBuffers.resize(GetNbTiles());
+}
+
+void Morph::ProcessTile(const Tile& x_tile)
+{
+	if(x_tile.halo == x_tile.roi)
+	{
+		morphologyEx(m_input(x_tile.roi), m_output(x_tile.roi), m_param.oper, m_element, Point(-1,-1), m_param.iterations);
+		return;
+	}
+	Mat& buffer(m_tileBuffers.at(x_tile.index));
+	morphologyEx(m_input(x_tile.halo), buffer, m_param.oper, m_element, Point(-1,-1), m_param.iterations);
+	buffer(x_tile.Local()).copyTo(m_output(x_tile.roi));
+}
 } // namespace mk
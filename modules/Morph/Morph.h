@@ -58,6 +58,7 @@ public:
 	MKCLASS("Morph")
 	MKCATEG("Image")
 	MKDESCR("Apply a morphological operator to an image")
+	bool IsFusable() const override {return true;}
 
 private:
 	const Parameters& m_param;
@@ -66,6 +67,9 @@ private:
 protected:
 	void ProcessFrame() override;
 	void Reset() override;
+	int GetTileHalo() const override;
+	void BeginTiles() override;
+	void ProcessTile(const Tile& x_tile) override;
 
 	// input
 	cv::Mat m_input;
@@ -75,6 +79,7 @@ protected:
 
 	// temporary
 	cv::Mat m_element;
+	std::vector<cv::Mat> m_tileBuffers;
 };
 
 
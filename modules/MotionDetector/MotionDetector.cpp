@@ -27,6 +27,8 @@
 #include "StreamState.h"
 #include "StreamEvent.h"
 #include "StreamNum.h"
+#include "StreamObject.h"
+#include "FeatureVector.h"
 
 #include <opencv2/highgui/highgui.hpp>
 
@@ -53,6 +55,8 @@ MotionDetector::MotionDetector(ParameterStructure& xr_params)
 	AddOutputStream(1, new StreamEvent("motion", m_event,  *this, 	"Motion is detected"));
 	mp_streamValues = new StreamNum<double>("value", m_value,  *this,      "Scalar representing the motion level");
 	AddOutputStream(2, mp_streamValues);
+	AddOutputStream(3, new StreamObject("zones", m_zones, *this, "Zones of the grid, with the motion level and the level of each channel as features"));
+	AddOutputStream(4, new StreamObject("global", m_global, *this, "Area where motion is measured, with the motion level and the level of each channel as features"));
 
 #ifdef MARKUS_DEBUG_STREAMS
 	m_debug = Mat(Size(m_param.width, m_param.height), CV_8UC3);
@@ -68,6 +72,35 @@ void MotionDetector::Reset()
 {
 	Module::Reset();
 	m_state = false;
+
+	// Compute the mask and the zones
+	m_mask = Mat();
+	if(m_param.mask.Size() > 0)
+	{
+		m_mask = Mat::zeros(m_input.size(), CV_8UC1);
+		m_param.mask.DrawMask(m_mask, Scalar(255));
+	}
+	m_area = Rect(Point(0, 0), m_input.size());
+	if(!m_mask.empty())
+	{
+		vector<Point> points;
+		findNonZero(m_mask, points);
+		m_area = points.empty() ? Rect() : boundingRect(points);
+	}
+	m_blocks.clear();
+	m_blockPixels.clear();
+	for(int i = 0 ; i < m_param.gridRows ; i++)
+	{
+		for(int j = 0 ; j < m_param.gridCols ; j++)
+		{
+			int x1 = j * m_input.cols / m_param.gridCols;
+			int y1 = i * m_input.rows / m_param.gridRows;
+			int x2 = (j + 1) * m_input.cols / m_param.gridCols;
+			int y2 = (i + 1) * m_input.rows / m_param.gridRows;
+			m_blocks.push_back(Rect(x1, y1, x2 - x1, y2 - y1));
+			m_blockPixels.push_back(m_mask.empty() ? m_blocks.back().area() : countNonZero(m_mask(m_blocks.back())));
+		}
+	}
 #ifdef MARKUS_DEBUG_STREAMS
 	m_debug.setTo(m_colorPlotBack);
 #endif
@@ -75,19 +108,39 @@ void MotionDetector::Reset()
 
 void MotionDetector::ProcessFrame()
 {
-	vector<Mat> channels;
-	split(m_input, channels);
-	m_value = 0;
-
+	// note: the sums are computed on the interleaved channels of each zone. The zones cover the image: this is one pass
+	const int    nbChannels = m_input.channels();
+	const double scale      = m_input.depth() == CV_8U ? 1.0 / 255 : 1.0;
+	Scalar total    = Scalar::all(0);
+	int    nbPixels = 0;
 	m_event.Clean();
+	m_zones.clear();
+	m_global.clear();
+	vector<float> channels(nbChannels);
 
-	for(int i = 0 ; i < m_input.channels() ; i++)
+	for(size_t i = 0 ; i < m_blocks.size() ; i++)
 	{
-		Scalar m = mean(channels[i]);
-		m /= 255.0;
-		m_value += sum(m)[i];
+		const Rect& rect(m_blocks[i]);
+		const int count = m_blockPixels[i];
+		Scalar blockSum = Scalar::all(0);
+		if(count > 0)
+			blockSum = m_mask.empty() ? sum(m_input(rect)) : mean(m_input(rect), m_mask(rect)) * count;
+		total    += blockSum;
+		nbPixels += count;
+
+		double level = count > 0 ? scale * (blockSum[0] + blockSum[1] + blockSum[2] + blockSum[3]) / (count * nbChannels) : 0;
+		for(int c = 0 ; c < nbChannels ; c++)
+			channels[c] = count > 0 ? scale * blockSum[c] / count : 0;
+		m_zones.push_back(Object("zone", rect));
+		m_zones.back().AddFeature("motion", new FeatureFloat(level));
+		m_zones.back().AddFeature("channels", new FeatureVectorFloat(channels));
 	}
-	m_value /= m_input.channels();
+	m_value = nbPixels > 0 ? scale * (total[0] + total[1] + total[2] + total[3]) / (nbPixels * nbChannels) : 0;
+	for(int c = 0 ; c < nbChannels ; c++)
+		channels[c] = nbPixels > 0 ? scale * total[c] / nbPixels : 0;
+	m_global.push_back(Object("motion", m_area));
+	m_global.back().AddFeature("motion", new FeatureFloat(m_value));
+	m_global.back().AddFeature("channels", new FeatureVectorFloat(channels));
 	bool oldState = m_state;
 	m_state = (m_value >= m_param.motionThres);
 	if(m_state == true && oldState == false)
@@ -28,10 +28,13 @@
 #include "Parameter.h"
 #include "Event.h"
 #include "StreamNum.h"
+#include "Object.h"
+#include "Polygon.h"
 
 namespace mk {
 /**
-* @brief Detect motion from an image where pixel value represents motion
+* @brief Detect motion from an image where pixel value represents motion. The motion level can be restricted to a
+*        polygon and measured on a grid of blocks (zones), in the same pass over the image.
 */
 class MotionDetector : public Module
 {
@@ -44,6 +47,9 @@ public:
 		{
 			AddParameter(new ParameterFloat("motionThres" , 0.1 , 0 , 1 , &motionThres , "Threshold for motion analysis"));
 			AddParameter(new ParameterBool("propagate"    , true        , &propagate   , "Threshold for motion analysis"));
+			AddParameter(new ParameterT<Polygon>("mask"   , Polygon()   , &mask, "Polygon where motion is measured. If empty the full image is used"));
+			AddParameter(new ParameterInt("gridCols"      , 1, 1, 64    , &gridCols    , "Number of columns of zones where the motion level is measured"));
+			AddParameter(new ParameterInt("gridRows"      , 1, 1, 64    , &gridRows    , "Number of rows of zones where the motion level is measured"));
 
 			RefParameterByName("width").SetRange(R"({"min":32, "max":6400})"_json);
 			RefParameterByName("height").SetRange(R"({"min":24, "max":4800})"_json);
@@ -51,6 +57,9 @@ public:
 
 		float motionThres;
 		bool propagate;
+		Polygon mask;
+		int gridCols;
+		int gridRows;
 	};
 
 	explicit MotionDetector(ParameterStructure& xr_params);
@@ -76,6 +85,14 @@ protected:
 	bool   m_state;
 	Event  m_event;
 	double m_value;
+	std::vector<Object> m_zones;
+	std::vector<Object> m_global;
+
+	// state
+	cv::Mat m_mask;                   // empty if no polygon
+	cv::Rect m_area;                  // bounding rectangle of the mask
+	std::vector<cv::Rect> m_blocks;   // one rectangle per zone
+	std::vector<int> m_blockPixels;   // number of pixels inside the mask for each zone
 
 	// temp
 	StreamNum<double>* mp_streamValues = nullptr;
@@ -62,7 +62,8 @@ void OpticalFlowKeyPoints::Reset()
 {
 	Module::Reset();
 	m_lastPoints.clear();
-	m_lastImg = Mat();
+	m_pyramid.clear();
+	m_lastPyramid.clear();
 }
 
 void OpticalFlowKeyPoints::ProcessFrame()
@@ -82,37 +83,26 @@ void OpticalFlowKeyPoints::ProcessFrame()
 		pointsIn.push_back(elem.Center());
 	}
 
-	// If just initialized
-	if(m_lastImg.empty())
-	{
-		m_input.copyTo(m_lastImg);
-		m_lastPoints = pointsIn;
-	}
-	else
+	// The pyramid of the current image is built only once: it is used for both directions of the flow
+	// and becomes the pyramid of the last image at the next frame
+	buildOpticalFlowPyramid(m_input, m_pyramid, Size(m_param.winSide, m_param.winSide), m_param.maxLevel);
+
+	// Nothing to track if just initialized
+	if(!m_lastPyramid.empty())
 	{
-		vector<uchar> status;
-		vector<float> err;
 		// cornerSubPix(m_input, pointsIn, subPixWinSize, Size(-1,-1), termcrit);
-		vector<Point2f> pointsOut;
-
-		// match points of the old point list with the current image
-		// the matching keypoints correspond with the old points !
-		// calcOpticalFlowPyrLK(m_lastImg, m_input, m_lastPoints, pointsOut, status, err, Size(m_param.winSide, m_param.winSide), m_param.maxLevel);
-
-		// match points of the current point list with the old image
-		// in some way we compute optical flow in reverse: we inverted previous and next lists of points compared to standard usage
-		calcOpticalFlowPyrLK(m_input, m_lastImg, pointsIn, pointsOut, status, err, Size(m_param.winSide, m_param.winSide), m_param.maxLevel);
+		TrackPoints(pointsIn);
 
 #ifdef MARKUS_DEBUG_STREAMS
 		//draw a line between this to point to show the OF of these points
 		adjustChannels(m_input, m_debug);
 		int cpt = 0;
-		for(size_t i = 0 ; i < status.size() ; i++)
+		for(size_t i = 0 ; i < m_status.size() ; i++)
 		{
-			if(status[i] == 1)
+			if(m_status[i] == 1)
 			{
 				//point have been found draw it in green
-				line(m_debug, pointsIn[i], pointsOut[i], Scalar(12, 233, 0));
+				line(m_debug, pointsIn[i], m_pointsOut[i], Scalar(12, 233, 0));
 				ellipse(m_debug, RotatedRect(pointsIn[i], Size(3, 3), 0), Scalar(33, 233, 0));
 				cpt++;
 			}
@@ -121,9 +111,55 @@ void OpticalFlowKeyPoints::ProcessFrame()
 #endif
 	}
 
-	// swap(m_input, m_lastImg);
-	// swap(m_lastPoints, pointsIn);
-	m_input.copyTo(m_lastImg);
+	// note: swapping the pyramids avoids a copy, the buffers of the old pyramid are reused at the next frame
+	swap(m_pyramid, m_lastPyramid);
 	m_lastPoints = pointsIn;
 }
+
+/**
+* @brief Compute the optical flow of the points. The points are split in chunks that are tracked in parallel,
+*        the forward-backward check of a chunk is done by the same worker and reuses the same pyramids
+*
+* @param x_points Points of the current image
+*/
+void OpticalFlowKeyPoints::TrackPoints(const vector<Point2f>& x_points)
+{
+	const int nb = x_points.size();
+	const int nbChunks = min(GetNbTiles(), nb);
+	const Size winSize(m_param.winSide, m_param.winSide);
+	m_pointsOut.resize(nb);
+	m_status.resize(nb);
+
+	parallelForEach(nbChunks, [&](int x_chunk){
+		const int begin = nb * x_chunk / nbChunks;
+		const int end   = nb * (x_chunk + 1) / nbChunks;
+		vector<Point2f> pointsIn(x_points.begin() + begin, x_points.begin() + end);
+		vector<Point2f> pointsOut;
+		vector<uchar> status;
+		vector<float> err;
+
+		// match points of the old point list with the current image
+		// the matching keypoints correspond with the old points !
+		// calcOpticalFlowPyrLK(m_lastPyramid, m_pyramid, m_lastPoints, pointsOut, status, err, winSize, m_param.maxLevel);
+
+		// match points of the current point list with the old image
+		// in some way we compute optical flow in reverse: we inverted previous and next lists of points compared to standard usage
+		calcOpticalFlowPyrLK(m_pyramid, m_lastPyramid, pointsIn, pointsOut, status, err, winSize, m_param.maxLevel);
+
+		if(m_param.forwardBackward)
+		{
+			// track the points back to the current image: a point is only kept if it comes back to its position
+			vector<Point2f> pointsBack;
+			vector<uchar> statusBack;
+			calcOpticalFlowPyrLK(m_lastPyramid, m_pyramid, pointsOut, pointsBack, statusBack, err, winSize, m_param.maxLevel);
+			for(size_t i = 0 ; i < status.size() ; i++)
+			{
+				if(statusBack[i] == 0 || norm(pointsBack[i] - pointsIn[i]) > m_param.maxForwardBackwardError)
+					status[i] = 0;
+			}
+		}
+		copy(pointsOut.begin(), pointsOut.end(), m_pointsOut.begin() + begin);
+		copy(status.begin(), status.end(), m_status.begin() + begin);
+	});
+}
 } // namespace mk
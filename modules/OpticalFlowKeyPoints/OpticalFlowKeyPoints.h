@@ -43,11 +43,15 @@ public:
 		{
 			AddParameter(new ParameterInt("winSide",  21, 3, 255, &winSide, "Side of the square window used as search window at each pyramid level"));
 			AddParameter(new ParameterInt("maxLevel",  3, 0, 12, &maxLevel, "0-based maximal pyramid level number; if set to 0, pyramids are not used (single level), if set to 1, two levels are used, and so on; if pyramids are passed to input then algorithm will use as many levels as pyramids have but no more than maxLevel"));
+			AddParameter(new ParameterBool("forwardBackward", false, &forwardBackward, "Check the optical flow by tracking the points back to the current frame"));
+			AddParameter(new ParameterDouble("maxForwardBackwardError", 1, 0, 100, &maxForwardBackwardError, "Maximal distance between a point and its position after tracking forward and backward [pixels]"));
 
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1","CV_8UC3"]})"_json);
 		};
 		int winSide;
 		int maxLevel;
+		bool forwardBackward;
+		double maxForwardBackwardError;
 		// TermCriteria criteria=TermCriteria(TermCriteria::COUNT+TermCriteria::EPS, 30, 0.01)
 		// int flags=0
 		// double minEigThreshold=1e-4
@@ -66,6 +70,7 @@ private:
 protected:
 	void Reset() override;
 	void ProcessFrame() override;
+	void TrackPoints(const std::vector<cv::Point2f>& x_points);
 
 	// input
 	cv::Mat m_input;
@@ -74,10 +79,15 @@ protected:
 	// output
 	// std::vector <Object> m_keyPointsOut;
 
-	//last img used to compute OF
-	cv::Mat                  m_lastImg;
+	// pyramids of the current and of the last image used to compute OF
+	std::vector<cv::Mat>     m_pyramid;
+	std::vector<cv::Mat>     m_lastPyramid;
 	std::vector<cv::Point2f> m_lastPoints;
 
+	// temporary
+	std::vector<cv::Point2f> m_pointsOut;
+	std::vector<uchar>       m_status;
+
 #ifdef MARKUS_DEBUG_STREAMS
 	cv::Mat m_debug;
 #endif
@@ -0,0 +1,110 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "PythonScript.h"
+#include "StreamImage.h"
+#include "StreamObject.h"
+
+namespace mk {
+using namespace std;
+using namespace cv;
+using namespace boost::python;
+
+log4cxx::LoggerPtr PythonScript::m_logger(log4cxx::Logger::getLogger("PythonScript"));
+
+PythonScript::PythonScript(ParameterStructure& xr_params) :
+	ModulePython(xr_params),
+	m_param(dynamic_cast<Parameters&>(xr_params)),
+	m_input(Size(m_param.width, m_param.height), m_param.type)
+{
+	AddInputStream(0, new StreamImage("image",    m_input,     *this, "Video input"));
+	AddInputStream(1, new StreamObject("objects", m_objectsIn, *this, "Optional objects given to the function"));
+
+	AddOutputStream(0, new StreamEvent("event", m_event, *this, "Event with the value returned by the function (external info \"result\")"));
+
+	m_isUnitTestingEnabled = false; // numpy is needed
+}
+
+PythonScript::~PythonScript()
+{
+}
+
+void PythonScript::Reset()
+{
+	ModulePython::Reset();
+	m_event.Clean();
+	m_results.clear();
+
+	// note: the results of the requests sent before the reset are discarded
+	vector<PythonWorkerPool::Result> results;
+	while(mp_pool != nullptr && mp_pool->GetNbPending() > 0)
+		mp_pool->Collect(results, -1);
+}
+
+void PythonScript::ProcessFrame()
+{
+	mkjson objects;
+	to_mkjson(objects, m_objectsIn);
+	if(mp_pool != nullptr)
+	{
+		mp_pool->Submit(m_currentTimeStamp, m_input, objects);
+		vector<PythonWorkerPool::Result> results;
+		mp_pool->Collect(results);
+		m_results.insert(m_results.end(), results.begin(), results.end());
+	}
+	else Call(objects);
+
+	// note: errors were logged by the pool
+	m_event.Clean();
+	while(!m_results.empty() && !m_results.front().error.empty())
+		m_results.pop_front();
+	if(m_results.empty())
+		return;
+	m_event.Raise(m_param.eventName, m_currentTimeStamp, m_results.front().timestamp);
+	m_event.AddExternalInfo("result", m_results.front().value);
+	m_results.pop_front();
+}
+
+/**
+* @brief Call the function in the interpreter of markus
+*
+* @param x_objects Objects, given to the function as a list of dicts
+*/
+void PythonScript::Call(const mkjson& x_objects)
+{
+	ScopedGil gil;
+	try
+	{
+		object json = import("json");
+		object result = m_pyGlobals[m_param.function](m_input, json.attr("loads")(x_objects.dump()));
+		const string value = extract<string>(json.attr("dumps")(result));
+		m_results.push_back(PythonWorkerPool::Result{m_currentTimeStamp, mkjson::parse(value), ""});
+	}
+	catch(error_already_set&)
+	{
+		PyErr_Print();
+		throw MkException("Error in function " + m_param.function + " of Python script " + m_param.script, LOC);
+	}
+}
+
+} // namespace mk
@@ -0,0 +1,82 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef PYTHON_SCRIPT_H
+#define PYTHON_SCRIPT_H
+
+#include <deque>
+#include "ModulePython.h"
+#include "StreamEvent.h"
+
+
+namespace mk {
+/**
+* @brief Call a function of a Python script with the image and the objects of each frame. The value returned by the
+*        function is given with an event. With worker processes, the results are returned asynchronously: the event
+*        has the timestamp of the frame of the result.
+*/
+class PythonScript : public ModulePython
+{
+public:
+	class Parameters : public ModulePython::Parameters
+	{
+	public:
+		explicit Parameters(const std::string& x_name) : ModulePython::Parameters(x_name)
+		{
+			AddParameter(new ParameterString("eventName", "python", &eventName, "Name of the event raised with the value returned by the function"));
+
+			RefParameterByName("scriptPath").SetDefaultAndValue("modules/PythonScript");
+			RefParameterByName("script").SetDefaultAndValue("modules/PythonScript/script.py");
+		}
+		std::string eventName;
+	};
+
+	explicit PythonScript(ParameterStructure& xr_params);
+	~PythonScript() override;
+	MKCLASS("PythonScript")
+	MKCATEG("Other")
+	MKDESCR("Call a function of a Python script with the image and the objects, the value returned is given with an event")
+
+private:
+	const Parameters& m_param;
+	static log4cxx::LoggerPtr m_logger;
+
+protected:
+	void Reset() override;
+	void ProcessFrame() override;
+	void Call(const mkjson& x_objects);
+
+	// input
+	cv::Mat m_input;
+	std::vector<Object> m_objectsIn;
+
+	// output
+	Event m_event;
+
+	// state
+	std::deque<PythonWorkerPool::Result> m_results; // results not given yet, one event is raised per frame
+};
+
+
+} // namespace mk
+#endif
@@ -0,0 +1,4 @@
+# Example of script for the module PythonScript: the function is called with the image (numpy array) and the objects
+# (list of dicts), its return value must be serializable in JSON
+def process(image, objects):
+    return {'mean': float(image.mean()), 'nbObjects': len(objects)}
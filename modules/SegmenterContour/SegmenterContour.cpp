@@ -49,10 +49,6 @@ SegmenterContour::SegmenterContour(ParameterStructure& xr_params) :
 	m_debug = Mat(Size(m_param.width, m_param.height), CV_8UC3);
 	AddDebugStream(0, new StreamDebug("blobs", m_debug, *this,	"Blobs"));
 #endif
-
-	// Decide which features to compute
-	m_computeFitEllipse = m_param.features.find("ellipse_");
-	m_computeMinRect    = m_param.features.find("minrect_");
 }
 
 SegmenterContour::~SegmenterContour()
@@ -62,195 +58,194 @@ SegmenterContour::~SegmenterContour()
 void SegmenterContour::Reset()
 {
 	Module::Reset();
-	split(m_param.features, ',', m_featureNames);
-	m_computeMoment = false;
-	m_computeHuMoment = false;
+	m_diagonal = sqrt(m_param.width * m_param.width + m_param.height * m_param.height);
+	m_fullArea = m_param.width * m_param.height;
+	CompilePlan();
+}
 
-	for(const auto& name : m_featureNames)
+/**
+* @brief Compile the list of features into a plan: the intermediates (moments, ellipse, ...) needed by the features
+*        are computed once per contour and each feature is then a simple function of these
+*/
+void SegmenterContour::CompilePlan()
+{
+	typedef std::function<double(const Object&, const ContourData&)> Compute;
+	const map<string, pair<int, Compute>> table = {
+		{"x",              {0,          [this](const Object& x_obj, const ContourData&){return x_obj.posX / m_diagonal;}}},
+		{"y",              {0,          [this](const Object& x_obj, const ContourData&){return x_obj.posY / m_diagonal;}}},
+		{"width",          {0,          [this](const Object& x_obj, const ContourData&){return x_obj.width / m_diagonal;}}},
+		{"height",         {0,          [this](const Object& x_obj, const ContourData&){return x_obj.height / m_diagonal;}}},
+		{"area",           {AREA,       [this](const Object&, const ContourData& x_data){return x_data.area / m_fullArea;}}},
+		// note: 180 is the max possible angle
+		{"ellipse_angle",  {ELLIPSE,    [](const Object&, const ContourData& x_data){return x_data.ellipse.angle / 180.0;}}},
+		{"ellipse_cos",    {ELLIPSE,    [](const Object&, const ContourData& x_data){return cos(x_data.ellipse.angle * M_PI / 180.0);}}},
+		{"ellipse_sin",    {ELLIPSE,    [](const Object&, const ContourData& x_data){return sin(x_data.ellipse.angle * M_PI / 180.0);}}},
+		{"ellipse_width",  {ELLIPSE,    [this](const Object&, const ContourData& x_data){return x_data.ellipse.size.width / m_diagonal;}}},
+		{"ellipse_height", {ELLIPSE,    [this](const Object&, const ContourData& x_data){return x_data.ellipse.size.height / m_diagonal;}}},
+		{"ellipse_ratio",  {ELLIPSE,    [](const Object&, const ContourData& x_data){
+			return x_data.ellipse.size.height == 0 ? 0 : static_cast<double>(x_data.ellipse.size.width) / x_data.ellipse.size.height;}}},
+		{"moment_00",      {MOMENTS,    [](const Object&, const ContourData& x_data){return x_data.moments.m00;}}},
+		{"moment_11",      {MOMENTS,    [](const Object&, const ContourData& x_data){return x_data.moments.mu11 / pow(x_data.moments.m00, 2);}}},
+		{"moment_02",      {MOMENTS,    [](const Object&, const ContourData& x_data){return x_data.moments.mu02 / pow(x_data.moments.m00, 2);}}},
+		{"moment_20",      {MOMENTS,    [](const Object&, const ContourData& x_data){return x_data.moments.mu20 / pow(x_data.moments.m00, 2);}}},
+		{"solidity",       {AREA | HULL_AREA, [](const Object&, const ContourData& x_data){
+			return x_data.hullArea == 0 ? 0 : x_data.area / x_data.hullArea;}}}
+	};
+
+	vector<string> names;
+	split(m_param.features, ',', names);
+	m_plan.clear();
+	m_intermediates = 0;
+	for(const auto& name : names)
 	{
-		if (!m_computeMoment)
-			m_computeMoment = (name.find("moment") != string::npos);
-
-		if (!m_computeHuMoment && (m_computeHuMoment  = (name.find("hu_moment") != string::npos)))
+		if(name.empty())
+			continue;
+		// hu moments: hu_moment_1 to hu_moment_7
+		if(name.size() == 11 && name.compare(0, 10, "hu_moment_") == 0 && name[10] >= '1' && name[10] <= '7')
 		{
-			break;
+			int index = name[10] - '1';
+			m_plan.push_back(FeatureStep{name, [index](const Object&, const ContourData& x_data){return x_data.hu[index];}});
+			m_intermediates |= MOMENTS | HU_MOMENTS;
+			continue;
 		}
+		auto it = table.find(name);
+		if(it == table.end())
+			throw MkException("Unknown feature " + name + " in SegmenterContour", LOC);
+		m_plan.push_back(FeatureStep{name, it->second.second});
+		m_intermediates |= it->second.first;
 	}
+#ifdef MARKUS_DEBUG_STREAMS
+	// note: the ellipses are drawn on the debug stream
+	m_intermediates |= ELLIPSE;
+#endif
 }
 
-/// Process the frame
-void SegmenterContour::ProcessFrame()
+/**
+* @brief Compute the intermediates needed by the plan for one contour
+*
+* @param x_contour       Contour
+* @param xr_data         Intermediates of the contour, the bounding rectangle must already be set
+* @param x_intermediates Intermediates to compute
+*/
+void SegmenterContour::ComputeIntermediates(const vector<Point>& x_contour, ContourData& xr_data, int x_intermediates) const
 {
-	// Mat threshold_output;
-	vector<vector<Point> > contours;
-	vector<Vec4i> hierarchy;
-
-	/// Detect edges using Threshold
-	// threshold(m_input, threshold_output, thresh, 255, THRESH_BINARY);
-	/// Find contours
-	findContours(m_input, contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE, Point(0, 0));
-
+	if(x_intermediates & AREA)
+		xr_data.area = contourArea(x_contour);
+	if(x_intermediates & HULL_AREA)
+	{
+		vector<Point> hull;
+		convexHull(x_contour, hull);
+		xr_data.hullArea = contourArea(hull);
+	}
+	if(x_intermediates & ELLIPSE)
+		xr_data.ellipse = x_contour.size() >= 5 ? fitEllipse(x_contour) : RotatedRect();
+	if(x_intermediates & MOMENTS)
+		xr_data.moments = moments(x_contour);
+	if(x_intermediates & HU_MOMENTS)
+		HuMoments(xr_data.moments, xr_data.hu);
+}
 
-	m_regions.clear();
-#ifdef MARKUS_DEBUG_STREAMS
-	m_debug.setTo(0);
-#endif
-	const double diagonal = sqrt(m_input.rows * m_input.rows + m_input.cols * m_input.cols);
-	const double fullArea = m_input.rows * m_input.cols;
+/**
+* @brief Compute the intermediates of a blob found by labeling: area and moments come from the statistics of the
+*        labeling (they are computed on pixels). The contour is only extracted if a feature needs it
+*
+* @param x_index Index of the blob
+* @param xr_data Intermediates of the blob, the bounding rectangle must already be set
+*/
+void SegmenterContour::ComputeBlobIntermediates(int x_index, ContourData& xr_data)
+{
+	const Blob& blob(m_labeling.GetBlobs()[x_index]);
+	xr_data.area = blob.m00;
+	if(m_intermediates & MOMENTS)
+		xr_data.moments = blob.Moments();
+	if(m_intermediates & HU_MOMENTS)
+		HuMoments(xr_data.moments, xr_data.hu);
+
+	vector<Point>& contour(m_contours[x_index]);
+	contour.clear();
+	if((m_intermediates & (ELLIPSE | HULL_AREA)) == 0)
+		return;
+	m_labeling.GetContour(x_index, contour);
+	ComputeIntermediates(contour, xr_data, m_intermediates & ELLIPSE);
+	if(m_intermediates & HULL_AREA)
+	{
+		// note: the hull is measured in pixels, as the area of the blob
+		vector<Point> hull;
+		convexHull(contour, hull);
+		Mat mask = Mat::zeros(xr_data.rect.size(), CV_8UC1);
+		fillPoly(mask, vector<vector<Point>>{hull}, Scalar(255), 8, 0, -xr_data.rect.tl());
+		xr_data.hullArea = countNonZero(mask);
+	}
+}
 
+/// Process the frame
+void SegmenterContour::ProcessFrame()
+{
+	const bool labeling = m_param.method == "labeling";
+	int nb = 0;
+	if(labeling)
+	{
+		/// Label connected components by stripes in parallel
+		m_labeling.Label(m_input, GetNbTiles(), (m_intermediates & HU_MOMENTS) != 0);
+		nb = static_cast<int>(m_labeling.GetBlobs().size());
+		m_contours.resize(nb);
+	}
+	else
+	{
+		/// Find contours
+		vector<Vec4i> hierarchy;
+		findContours(m_input, m_contours, hierarchy, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE, Point(0, 0));
+		nb = static_cast<int>(m_contours.size());
+	}
 
-	/// Extract features
-	for(unsigned int i = 0; i< contours.size(); i++)
+	/// Extract features: contours are independent and processed in parallel
+	m_data.resize(nb);
+	m_candidates.assign(nb, Object(m_param.objectLabel));
+	m_isKept.assign(nb, 0);
+	parallelForEach(nb, [this, labeling](int i)
 	{
-		Rect rect = boundingRect(contours[i]);
-		if(rect.width >= m_param.minWidth && rect.height >= m_param.minHeight)
+		ContourData& data(m_data[i]);
+		data.rect = labeling ? m_labeling.GetBlobs()[i].rect : boundingRect(m_contours[i]);
+		if(data.rect.width < m_param.minWidth || data.rect.height < m_param.minHeight)
 		{
-			RotatedRect minEllipse;
-			/// Find the rotated rectangles and ellipses for each contour
-			if(contours[i].size() >= 5)
-				minEllipse = fitEllipse(Mat(contours[i]));
-			// RotatedRect minRect = minAreaRect(Mat(contours[i]));
-
-			// contour
-#ifdef MARKUS_DEBUG_STREAMS
-			Scalar color = Scalar(m_rng.uniform(0, 255), m_rng.uniform(0,255), m_rng.uniform(0,255));
-			drawContours(m_debug, contours, i, color, 1, 8, vector<Vec4i>(), 0, Point());
-#endif
-
-
-			Object obj(m_param.objectLabel, rect);
-
-			// Extract moments only if necessary
-			Moments mom;
-			double m00_scaled;
-			double hu[7];
-
-			if (m_computeMoment)
-			{
-				mom = moments(contours[i]);
-				m00_scaled = mom.m00;
-
-				if (m_computeHuMoment)	// if computeHuMoment is true, computeMoment is already true
-					HuMoments(mom,hu);
-			}
-
-
-			// Add the possible features
-			for(const auto& name : m_featureNames)
-			{
-				if(name == "x")
-				{
-					obj.AddFeature("x", obj.posX / diagonal);
-				}
-				else if(name == "y")
-				{
-					obj.AddFeature("y", obj.posY / diagonal);
-				}
-				else if(name == "width")
-				{
-					obj.AddFeature("width", obj.width / diagonal);
-				}
-				else if(name == "height")
-				{
-					obj.AddFeature("height", obj.height / diagonal);
-				}
-				else if(name == "area")
-				{
-					obj.AddFeature("area", contourArea(contours[i]) / fullArea);
-				}
-				else if(name == "ellipse_angle")
-				{
-					obj.AddFeature("ellipse_angle", minEllipse.angle / 180.0); // 180 is the max possible angle
-				}
-				else if(name == "ellipse_cos")
-				{
-					obj.AddFeature("ellipse_cos", cos(minEllipse.angle * M_PI / 180.0)); // [-1..1]
-				}
-				else if(name == "ellipse_sin")
-				{
-					obj.AddFeature("ellipse_sin", sin(minEllipse.angle * M_PI / 180.0)); // [0..1]
-				}
-				else if(name == "ellipse_width")
-				{
-					obj.AddFeature("ellipse_width", static_cast<double>(minEllipse.size.width) / diagonal);
-				}
-				else if(name == "ellipse_height")
-				{
-					obj.AddFeature("ellipse_height", static_cast<double>(minEllipse.size.height)  / diagonal);
-				}
-				else if(name == "ellipse_ratio")
-				{
-					obj.AddFeature("ellipse_ratio", minEllipse.size.height == 0 ? 0 : static_cast<double>(minEllipse.size.width) / minEllipse.size.height);
-				}
-				else if(name == "moment_00")
-				{
-					obj.AddFeature("moment_00", m00_scaled);
-				}
-				else if(name == "moment_11")
-				{
-					obj.AddFeature("moment_11", mom.mu11/pow(m00_scaled, 2));
-				}
-				else if(name == "moment_02")
-				{
-					obj.AddFeature("moment_02", mom.mu02/pow(m00_scaled, 2));
-				}
-				else if(name == "moment_20")
-				{
-					obj.AddFeature("moment_20", mom.mu20/pow(m00_scaled, 2));
-				}
-				else if(name == "hu_moment_1")
-				{
-					obj.AddFeature("hu_moment_1", hu[0]);
-				}
-				else if(name == "hu_moment_2")
-				{
-					obj.AddFeature("hu_moment_2", hu[1]);
-				}
-				else if(name == "hu_moment_3")
-				{
-					obj.AddFeature("hu_moment_3", hu[2]);
-				}
-				else if(name == "hu_moment_4")
-				{
-					obj.AddFeature("hu_moment_4", hu[3]);
-				}
-				else if(name == "hu_moment_5")
-				{
-					obj.AddFeature("hu_moment_5", hu[4]);
-				}
-				else if(name == "hu_moment_6")
-				{
-					obj.AddFeature("hu_moment_6", hu[5]);
-				}
-				else if(name == "hu_moment_7")
-				{
-					obj.AddFeature("hu_moment_7", hu[6]);
-				}
-				else if(name == "solidity")
-				{
-					vector<Point> ptConvexHull;
-					convexHull(contours[i],ptConvexHull);
-					obj.AddFeature("solidity", contourArea(contours[i]) / contourArea(ptConvexHull));
-				}
-			}
+			m_contours[i].clear();
+			return;
+		}
+		if(labeling)
+			ComputeBlobIntermediates(i, data);
+		else
+			ComputeIntermediates(m_contours[i], data, m_intermediates);
+
+		Object& obj(m_candidates[i]);
+		obj = Object(m_param.objectLabel, data.rect);
+		for(const auto& step : m_plan)
+			obj.AddFeature(step.name, step.compute(obj, data));
+		m_isKept[i] = 1;
+	});
+
+	// note: objects are kept in the order of the contours
+	m_regions.clear();
+	for(int i = 0 ; i < nb ; i++)
+	{
+		if(m_isKept[i])
+			m_regions.push_back(m_candidates[i]);
+	}
 
 #ifdef MARKUS_DEBUG_STREAMS
-			// ellipse
-			if(m_computeFitEllipse && minEllipse.size.width != 0
-					&& minEllipse.center.x > 0 && minEllipse.center.y > 0
-					&& minEllipse.center.x < m_debug.cols && minEllipse.center.y < m_debug.rows) // note: extra conditions are present to avoid a segfault
-				ellipse(m_debug, minEllipse, color, 2, 8);
-#endif
-			// rotated rectangle
-			/*Point2f rect_points[4]; minRect[i].points(rect_points);
-			for(int j = 0; j < 4; j++)
-				line(*m_debug, rect_points[j], rect_points[(j+1)%4], color, 1, 8);
-			*/
-			m_regions.push_back(obj);
-		}
+	m_debug.setTo(0);
+	for(int i = 0 ; i < nb ; i++)
+	{
+		if(!m_isKept[i] || m_contours[i].empty())
+			continue;
+		Scalar color = Scalar(m_rng.uniform(0, 255), m_rng.uniform(0,255), m_rng.uniform(0,255));
+		drawContours(m_debug, m_contours, i, color, 1, 8, vector<Vec4i>(), 0, Point());
+		const RotatedRect& minEllipse(m_data[i].ellipse);
+		if(minEllipse.size.width != 0
+				&& minEllipse.center.x > 0 && minEllipse.center.y > 0
+				&& minEllipse.center.x < m_debug.cols && minEllipse.center.y < m_debug.rows) // note: extra conditions are present to avoid a segfault
+			ellipse(m_debug, minEllipse, color, 2, 8);
 	}
+#endif
 }
 
-
-
 } // namespace mk
@@ -26,6 +26,7 @@
 
 #include "Module.h"
 #include "StreamObject.h"
+#include "ConnectedComponents.h"
 
 namespace mk {
 /**
@@ -42,7 +43,8 @@ public:
 			AddParameter(new ParameterInt(   "minWidth",  0, 	 0, MAX_WIDTH,  &minWidth,	"Minimal width of an object to segment."));
 			AddParameter(new ParameterInt(   "minHeight", 0, 	 0, MAX_HEIGHT, &minHeight,	"Minimal height of an object to segment."));
 			AddParameter(new ParameterString("objectLabel",         "object",             &objectLabel,"Label to be applied to the objects detected by the cascade filter (e.g. face)"));
-			AddParameter(new ParameterString("features",     "x,y,width,height",           &features,   "List of features to extract, separated with ',' possible: x,y,width,height,area,ellipse_{angle,cos,sin,ratio,width,height}, moment_{00,11,20,02}, hu_moment_{1-7}"));
+			AddParameter(new ParameterString("method",       "contours",                   &method,     "Segmentation method: contours (with findContours) or labeling (connected components labeled in parallel, area and moments are computed on pixels and contours only for the features that need them)"));
+			AddParameter(new ParameterString("features",     "x,y,width,height",           &features,   "List of features to extract, separated with ',' possible: x,y,width,height,area,ellipse_{angle,cos,sin,ratio,width,height}, moment_{00,11,20,02}, hu_moment_{1-7}, solidity"));
 
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1"]})"_json); //,CV_32SC1]");
 			RefParameterByName("features").SetRange(R"({"allowed":[
@@ -53,10 +55,12 @@ public:
 									"hu_moment_1,hu_moment_2,hu_moment_3,hu_moment_4,hu_moment_5,hu_moment_6,hu_moment_7",
 									"solidity"
 								]})"_json);
+			RefParameterByName("method").SetRange(R"({"allowed":["contours","labeling"]})"_json);
 		};
 		std::string objectLabel;
 		int minWidth;
 		int minHeight;
+		std::string method;
 		std::string features;
 	};
 
@@ -70,8 +74,36 @@ private:
 	static log4cxx::LoggerPtr m_logger;
 
 protected:
+	/// Intermediate results of a contour, shared by several features
+	enum Intermediate
+	{
+		AREA       = 1,
+		HULL_AREA  = 2,
+		ELLIPSE    = 4,
+		MOMENTS    = 8,
+		HU_MOMENTS = 16
+	};
+	struct ContourData
+	{
+		cv::Rect        rect;
+		double          area     = 0;
+		double          hullArea = 0;
+		cv::RotatedRect ellipse;
+		cv::Moments     moments;
+		double          hu[7]    = {0};
+	};
+	/// One step of the plan: compute one feature from the object and the intermediates of its contour
+	struct FeatureStep
+	{
+		std::string name;
+		std::function<double(const Object&, const ContourData&)> compute;
+	};
+
 	void ProcessFrame() override;
 	void Reset() override;
+	void CompilePlan();
+	void ComputeIntermediates(const std::vector<cv::Point>& x_contour, ContourData& xr_data, int x_intermediates) const;
+	void ComputeBlobIntermediates(int x_index, ContourData& xr_data);
 
 	// input
 	cv::Mat m_input;
@@ -80,11 +112,15 @@ protected:
 	std::vector<Object> m_regions;
 
 	// temporary
-	std::vector<std::string> m_featureNames;
-	bool m_computeFitEllipse;
-	bool m_computeMinRect;
-	bool m_computeMoment;
-	bool m_computeHuMoment;
+	std::vector<FeatureStep> m_plan;  // features to compute, compiled at reset
+	int m_intermediates = 0;          // intermediates needed by the plan
+	double m_diagonal   = 0;
+	double m_fullArea   = 0;
+	std::vector<std::vector<cv::Point>> m_contours;
+	ConnectedComponents m_labeling;
+	std::vector<ContourData> m_data;
+	std::vector<Object> m_candidates;
+	std::vector<char> m_isKept;
 
 	// debug
 #ifdef MARKUS_DEBUG_STREAMS
@@ -66,9 +66,12 @@ void SlitCam::ProcessFrame()
 	m_position %= m_input.cols;
 	int x = m_input.cols / 2;
 	assert(aperture < x);
-	for(int i = 0; i < aperture ; i++)
-		if(m_position + i < m_input.cols)
-			m_output.col(m_position + i) = m_input.col(x/* + i*/) * 1;
+	ProcessTiles([&](const Tile& x_tile)
+	{
+		for(int i = 0; i < aperture ; i++)
+			if(m_position + i < m_input.cols)
+				m_input(Rect(x/* + i*/, x_tile.roi.y, 1, x_tile.roi.height)).copyTo(m_output(Rect(m_position + i, x_tile.roi.y, 1, x_tile.roi.height)));
+	});
 }
 
 } // namespace mk
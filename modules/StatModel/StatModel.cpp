@@ -28,6 +28,7 @@
 #include "StreamObject.h"
 // #include "StreamDebug.h"
 #include "util.h"
+#include "FeatureStd.h"
 
 #include <opencv2/ml.hpp>
 
@@ -97,81 +98,56 @@ void StatModel::Reset()
 		mp_statModel = SVM::load(m_param.modelFile);
 	}
 	split(m_param.features, ',', m_featureNames);
+	if(m_featureNames.empty())
+		throw MkException("No feature given to the model", LOC);
 
-	m_dataLength = 0;
-	m_samples    = Mat();
-	m_responses  = Mat();
-	m_row        = Mat();
-
+	// note: the file is named after the module, several models can store samples in the same directory
+	m_store.Reset(m_featureNames.size(), m_param.chunkSize, m_param.maxChunksInMemory,
+		m_param.maxChunksInMemory > 0 ? RefContext().RefOutputDir().ReserveFile(GetName() + ".samples.bin") : "");
+	m_predictor.SetModel(mp_statModel);
 }
 
 void StatModel::ProcessFrame()
 {
-	for(auto& obj: m_objects)
+	if(m_objects.empty())
+		return;
+
+	// note: objects without response are predicted but not stored
+	BatchPredictor::ExtractSamples(m_objects, m_featureNames, m_param.response, m_samples, m_responses);
+	for(int i = 0 ; i < m_responses.rows ; i++)
 	{
-		if(m_dataLength == 0)
+		if(m_responses.at<int>(i) < 0)
 		{
-			// prepare sample matrix
-			m_dataLength = m_featureNames.size();
-			if(m_dataLength == 0)
-				throw MkException("Data has size zero", LOC);
-			m_samples   = Mat(0, m_dataLength, CV_32FC1);
-			m_responses = Mat(0, 1, CV_32SC1);
-			m_row = Mat(1, m_dataLength, CV_32FC1);
-			m_row.setTo(0);
+			if(m_param.train)
+				throw MkException("Object has no response feature " + m_param.response, LOC);
+			continue;
 		}
+		m_store.Append(m_samples.row(i), m_responses.row(i));
+	}
 
-		// append data
-		int i = 0;
-		assert(static_cast<int>(m_featureNames.size()) == m_row.cols);
-		for(const auto& name : m_featureNames)
-		{
-			float dat = dynamic_cast<const FeatureFloat&>(obj.GetFeature(name)).value;
-			// cout << "res feat " << res << endl;
-			m_row.at<float>(0, i) = dat;
-			i++;
-		}
-		// if(m_param.train) {
-			m_samples.push_back(m_row);
-			// int response = dynamic_cast<const FeatureFloat&>(obj.GetFeature("x")).value + dynamic_cast<const FeatureFloat&>(obj.GetFeature("y")).value > 0.5;
-			// int response = dynamic_cast<const FeatureFloat&>(obj.GetFeature("x")).value + dynamic_cast<const FeatureFloat&>(obj.GetFeature("x")).value > 0.5;
-		float res = dynamic_cast<const FeatureFloat&>(obj.GetFeature(m_param.response)).value;
-        m_responses.push_back(static_cast<int32_t>(res > 0.4));
-// cout << "row " << m_row<< " res " << m_responses<< endl;
-			                        
-			// m_responses.push_back(response);
-			// m_responses.push_back(dynamic_cast<const FeatureFloat&>(obj.GetFeature("x")).value > 0.1 ? 1 : 0);
-		// } else {
-			// float res = 2; // TODO dynamic_cast<const FeatureFloat&>(obj.GetFeature(m_param.response)).value;
-			// obj.AddFeature("label", res);
-		// }
-		if(!m_param.train) {
-			Mat est;
-			cout << "predict " << mp_statModel->predict(m_row, est/*, StatModel::RAW_OUTPUT*/) << " ";
-			cout << est  << endl;
-		}
+	if(!m_param.train)
+	{
+		// predict all objects of the frame at once
+		m_predictor.Predict(m_samples, m_results);
+		for(size_t i = 0 ; i < m_objects.size() ; i++)
+			m_objects[i].AddFeature(m_param.prediction, new FeatureFloat(m_results.at<float>(i)));
 	}
 }
 
 
 void StatModel::TrainModel()
 {
-	if(m_samples.empty())
+	if(m_store.IsEmpty())
 		return;
 
-	cout << "Samples" << m_samples << endl;
-	cout << "Responses" << m_responses << endl;
-	Ptr<TrainData> data = TrainData::create(m_samples, ml::ROW_SAMPLE, m_responses); //, InputArray varIdx=noArray(), InputArray sampleIdx=noArray(), InputArray sampleWeights=noArray(), InputArray varType=noArray());
-	bool is_trained = mp_statModel.dynamicCast<SVM>()->train(data, 10);
-
-	cout << "trained" << is_trained << endl;
-
-	if(!is_trained)
-	{
+	Mat samples, responses;
+	m_store.Load(samples, responses, m_param.maxTrainSamples);
+	LOG_INFO(m_logger, "Train model with " << samples.rows << " samples out of " << m_store.GetNbRows());
+	Ptr<TrainData> data = TrainData::create(samples, ml::ROW_SAMPLE, responses);
+	if(!mp_statModel->train(data, 10))
 		throw MkException("Unable to train model", LOC);
-	}
 
-	float err = mp_statModel->calcError(data, true, m_responses);
+	float err = mp_statModel->calcError(data, true, noArray());
 	LOG_INFO(m_logger, "Error of model on train data: " << err << "%");
 
 	string modelFile = RefContext().RefOutputDir().ReserveFile("model.data");
@@ -180,15 +156,17 @@ void StatModel::TrainModel()
 
 void StatModel::TestModel()
 {
-	if(m_samples.empty())
+	if(m_store.IsEmpty())
 		return;
 
-	cout << "Samples" << m_samples << endl;
-	cout << "Responses" << m_responses << endl;
-	Ptr<TrainData> data = TrainData::create(m_samples, ROW_SAMPLE, m_responses); //, InputArray varIdx=noArray(), InputArray sampleIdx=noArray(), InputArray sampleWeights=noArray(), InputArray varType=noArray());
-	
-	float err = mp_statModel->calcError(data, true, m_responses);
-	LOG_INFO(m_logger, "Error of model on test data: " << err << "%");
+	Mat samples, responses, results;
+	m_store.Load(samples, responses, 0);
+	m_predictor.Predict(samples, results);
+
+	int nbErrors = 0;
+	for(int i = 0 ; i < samples.rows ; i++)
+		nbErrors += results.at<float>(i) != responses.at<int>(i);
+	LOG_INFO(m_logger, "Error of model on test data: " << 100.0 * nbErrors / samples.rows << "%");
 }
 
 } // namespace mk
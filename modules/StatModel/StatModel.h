@@ -29,6 +29,8 @@
 #include "Parameter.h"
 #include "StreamObject.h"
 #include "ParameterEnumT.h"
+#include "BatchPredictor.h"
+#include "SampleStore.h"
 
 namespace mk {
 /*! \class StatModel
@@ -55,6 +57,10 @@ public:
 			AddParameter(new ParameterString("modelFile", "model.data", &modelFile, "Path to the model file for testing"));
 			AddParameter(new ParameterString("features", "x", &features, "List of features to use from the object. Separated by a comma."));
 			AddParameter(new ParameterString("response", "y", &response, "Name of the response feature to train with."));
+			AddParameter(new ParameterString("prediction", "prediction", &prediction, "Name of the feature added to objects with the prediction, when testing"));
+			AddParameter(new ParameterInt("chunkSize", 1024, 1, 1000000, &chunkSize, "Number of samples per chunk of the training set"));
+			AddParameter(new ParameterInt("maxChunksInMemory", 0, 0, 100000, &maxChunksInMemory, "Number of chunks of samples kept in memory, older chunks are written to a file (0: no limit)"));
+			AddParameter(new ParameterInt("maxTrainSamples", 0, 0, INT_MAX, &maxTrainSamples, "Maximal number of samples to train with, if more samples were collected they are sub-sampled (0: no limit)"));
 
 			/*
 			AddParameter(new ParameterEnumT<cv::ml::SVM::KernelTypes>("kernelType", cv::ml::SVM::KernelTypes::LINEAR, &kernelType, "SVM kernel type"));
@@ -70,6 +76,10 @@ public:
 		std::string modelFile;
 		std::string features;
 		std::string response;
+		std::string prediction;
+		int chunkSize;
+		int maxChunksInMemory;
+		int maxTrainSamples;
 		int kernelType;
 
 		CreationFunction create;
@@ -94,9 +104,8 @@ protected:
 
 	// state
 	cv::Ptr<cv::ml::StatModel> mp_statModel;
-	cv::Mat m_samples;
-	cv::Mat m_responses;
-	size_t m_dataLength = 0;
+	SampleStore m_store;
+	BatchPredictor m_predictor;
 
 	// input and output
 	std::vector<Object> m_objects;
@@ -105,7 +114,9 @@ protected:
 
 	// temp
 	std::vector<std::string> m_featureNames;
-	cv::Mat m_row;
+	cv::Mat m_samples;
+	cv::Mat m_responses;
+	cv::Mat m_results;
 
 	// debug
 #ifdef MARKUS_DEBUG_STREAMS
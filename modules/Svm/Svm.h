@@ -24,10 +24,7 @@
 #ifndef SVM_H
 #define SVM_H
 
-#include "Module.h"
-#include "Parameter.h"
-#include "StreamObject.h"
-#include "ParameterEnumT.h"
+#include "StatModel/StatModel.h"
 
 namespace mk {
 /*! \class Svm
@@ -36,23 +33,18 @@ namespace mk {
  */
 
 /**
-* @brief Classify objects by using a SVM on its features
+* @brief Classify objects by using a SVM on its features. The samples are stored, trained and predicted as in StatModel
 */
-class Svm : public Module
+class Svm : public StatModel
 {
 public:
-	class Parameters : public Module::Parameters
+	class Parameters : public StatModel::Parameters
 	{
 
 	public:
 		explicit Parameters(const std::string& x_name) :
-			Module::Parameters(x_name)
+			StatModel::Parameters(x_name)
 		{
-			AddParameter(new ParameterBool("train", true   , &train, "True if in training mode"));
-			AddParameter(new ParameterString("modelFile", "model.data", &modelFile, "Path to the model file for testing"));
-			AddParameter(new ParameterString("features", "x", &features, "List of features to use from the object. Separated by a comma."));
-			AddParameter(new ParameterString("response", "y", &response, "Name of the response feature to train with."));
-
 			AddParameter(new ParameterEnumT<cv::ml::SVM::KernelTypes>("kernelType", cv::ml::SVM::KernelTypes::LINEAR, &kernelType, "SVM kernel type"));
 			AddParameter(new ParameterDouble("gamma", 0, 0, 1, &gamma, "SVM gamma. For SVM::POLY, SVM::RBF, SVM::SIGMOID or SVM::CHI2."));
 			AddParameter(new ParameterDouble("coef0", 0, 0, 1, &coef0, "SVM coef0. For SVM::POLY or SVM::SIGMOID.."));
@@ -61,11 +53,6 @@ public:
 			AddParameter(new ParameterDouble("nu", 0.5, 0, 1, &nu, "SVM nu. For SVM::NU_SVC, SVM::ONE_CLASS or SVM::NU_SVR."));
 			AddParameter(new ParameterDouble("p", 0.1, 0, 1, &p, "SVM p. For SVM::EPS_SVR."));
 		}
-		bool train;
-		std::string modelFile;
-		std::string features;
-		std::string response;
-		int kernelType;
 
 		// svm
 		double gamma;
@@ -81,38 +68,7 @@ public:
 	MKCLASS("Svm")
 	MKDESCR("Classify objects by using a SVM on its features")
 	MKCATEG("Classifier")
-
-private:
-	void TrainModel();
-	void TestModel();
-
-	const Parameters& m_param;
-	static log4cxx::LoggerPtr m_logger;
-
-protected:
-	void Reset() override;
-	void ProcessFrame() override;
-
-	// state
-	cv::Ptr<cv::ml::SVM> mp_statModel;
-	cv::Mat m_samples;
-	cv::Mat m_responses;
-	size_t m_dataLength = 0;
-
-	// input and output
-	std::vector<Object> m_objects;
-
-	// output
-
-	// temp
-	std::vector<std::string> m_featureNames;
-	cv::Mat m_row;
-
-	// debug
-#ifdef MARKUS_DEBUG_STREAMS
-#endif
 };
 
 } // namespace mk
 #endif
-
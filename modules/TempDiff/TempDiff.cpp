@@ -23,6 +23,8 @@
 
 #include "TempDiff.h"
 #include "StreamImage.h"
+#include <algorithm>
+#include <cmath>
 
 // for debug
 #include "util.h"
@@ -37,9 +39,8 @@ TempDiff::TempDiff(ParameterStructure& xr_params) :
 	Module(xr_params),
 	m_param(dynamic_cast<Parameters&>(xr_params)),
 	m_input(Size(m_param.width, m_param.height), m_param.type),
-	m_temporalDiff(Size(m_param.width, m_param.height), CV_8UC1),
+	m_temporalDiff(Size(m_param.width, m_param.height), CV_8UC1)
 	// m_output(Size(m_param.width, m_param.height), m_param.type),
-	m_lastImg(Size(m_param.width, m_param.height), m_param.type)
 {
 	AddInputStream(0, new StreamImage("image", m_input, *this,             "Video input"));
 	AddOutputStream(0, new StreamImage("tempDiff", m_temporalDiff, *this, "Temporal difference"));
@@ -48,26 +49,89 @@ TempDiff::TempDiff(ParameterStructure& xr_params) :
 void TempDiff::Reset()
 {
 	Module::Reset();
-	m_tmp = Mat(Size(m_input.cols, m_input.rows), m_input.depth(), m_input.channels());
-	m_emptyTemporalDiff = true;
+	m_history.resize(m_param.nbFrames);
+	for(auto& elem : m_history)
+		elem.create(m_input.size(), m_input.type());
+	m_temporalDiff.create(m_input.size(), CV_MAKETYPE(m_input.depth(), 1));
+	m_nbStored = 0;
+	m_last     = m_param.nbFrames - 1;
 }
 
-void TempDiff::ProcessFrame()
+/**
+* @brief Compute the maximal absolute difference with the frames in history, in one pass. Color images are converted to
+*        gray levels with the same weights as cv::cvtColor
+*/
+template<typename T> void TempDiff::Difference(const Tile& x_tile)
 {
-	// Main part of the program
-	if(m_emptyTemporalDiff)
-	{
-		m_input.copyTo(m_lastImg);
-		m_emptyTemporalDiff = false;
-	}
-	else
+	const int channels = m_input.channels();
+	const int cols     = m_input.cols;
+	const int nb       = m_nbStored;
+	const T* prev[8];
+	assert(nb <= 8);
+
+	for(int i = x_tile.roi.y ; i < x_tile.roi.y + x_tile.roi.height ; i++)
 	{
-		subtract(m_input, m_lastImg, m_tmp);
-		absdiff(m_input,  m_lastImg, m_tmp);
-		adjustChannels(m_tmp, m_temporalDiff);
+		const T* in  = m_input.ptr<T>(i);
+		T*       out = m_temporalDiff.ptr<T>(i);
+		for(int k = 0 ; k < nb ; k++)
+			prev[k] = m_history[k].ptr<T>(i);
 
-		m_input.copyTo(m_lastImg);
+		if(channels == 1)
+		{
+			for(int j = 0 ; j < cols ; j++)
+			{
+				float diff = 0;
+				for(int k = 0 ; k < nb ; k++)
+					diff = std::max(diff, std::abs(static_cast<float>(in[j]) - prev[k][j]));
+				out[j] = saturate_cast<T>(diff);
+			}
+		}
+		else
+		{
+			assert(channels == 3);
+			for(int j = 0 ; j < cols ; j++)
+			{
+				float diff[3] = {0, 0, 0};
+				for(int k = 0 ; k < nb ; k++)
+					for(int c = 0 ; c < 3 ; c++)
+						diff[c] = std::max(diff[c], std::abs(static_cast<float>(in[3 * j + c]) - prev[k][3 * j + c]));
+				// note: channels are BGR
+				out[j] = saturate_cast<T>(0.114f * diff[0] + 0.587f * diff[1] + 0.299f * diff[2]);
+			}
+		}
 	}
+}
+
+void TempDiff::ProcessFrame()
+{
+	ProcessFrameByTiles();
 };
 
+void TempDiff::BeginTiles()
+{
+	if(m_input.depth() != CV_8U && m_input.depth() != CV_32F)
+		throw MkException("Unsupported image type in TempDiff", LOC);
+	if(m_nbStored > 0)
+		m_temporalDiff.create(m_input.size(), CV_MAKETYPE(m_input.depth(), 1));
+}
+
+void TempDiff::ProcessTile(const Tile& x_tile)
+{
+	// Main part of the program
+	if(m_nbStored == 0)
+		return;
+	if(m_input.depth() == CV_8U)
+		Difference<uchar>(x_tile);
+	else
+		Difference<float>(x_tile);
+}
+
+void TempDiff::EndTiles()
+{
+	// Keep the current frame: the oldest buffer of history is given to the input, it will be overwritten by the next frame
+	m_last = (m_last + 1) % m_param.nbFrames;
+	std::swap(m_input, m_history[m_last]);
+	m_nbStored = std::min(m_nbStored + 1, m_param.nbFrames);
+}
+
 } // namespace mk
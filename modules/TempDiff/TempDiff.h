@@ -29,7 +29,8 @@
 
 namespace mk {
 /**
-* @brief Perform temporal differencing: compare frame with previous frame by subtraction
+* @brief Perform temporal differencing: compare frame with previous frame by subtraction. If more than one previous frame
+*        is kept, the result is the maximum of the differences with each previous frame.
 */
 class TempDiff : public Module
 {
@@ -39,14 +40,18 @@ public:
 	public:
 		explicit Parameters(const std::string& x_name) : Module::Parameters(x_name)
 		{
+			AddParameter(new ParameterInt("nbFrames", 1, 1, 8, &nbFrames, "Number of previous frames to compare the current frame with"));
+
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1","CV_8UC3","CV_32FC1","CV_32FC3"]})"_json);
 		};
+		int nbFrames;
 	};
 
 	explicit TempDiff(ParameterStructure& xr_params);
 	MKCLASS("TempDiff")
 	MKCATEG("Image")
 	MKDESCR("Perform temporal differencing: compare frame with previous frame by subtraction")
+	bool IsFusable() const override {return true;}
 
 private:
 	const Parameters& m_param;
@@ -55,6 +60,10 @@ private:
 protected:
 	void ProcessFrame() override;
 	void Reset() override;
+	void BeginTiles() override;
+	void ProcessTile(const Tile& x_tile) override;
+	void EndTiles() override;
+	template<typename T> void Difference(const Tile& x_tile);
 
 	// input
 	cv::Mat m_input;
@@ -63,11 +72,9 @@ protected:
 	cv::Mat m_temporalDiff;
 
 	// state
-	cv::Mat m_lastImg;
-	bool m_emptyTemporalDiff;
-
-	// temporary
-	cv::Mat m_tmp;
+	std::vector<cv::Mat> m_history; // previous frames: buffers are swapped with the input, not copied
+	int m_nbStored;                 // number of frames in history
+	int m_last;                     // index of the last frame in history
 };
 
 
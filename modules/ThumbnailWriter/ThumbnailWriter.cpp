@@ -22,7 +22,6 @@
 -------------------------------------------------------------------------------------*/
 
 #include "ThumbnailWriter.h"
-#include <fstream>
 #include "StreamImage.h"
 #include "util.h"
 #include "Manager.h"
@@ -46,6 +45,14 @@ ThumbnailWriter::ThumbnailWriter(ParameterStructure& xr_params):
 
 ThumbnailWriter::~ThumbnailWriter()
 {
+	try
+	{
+		ImageEncoder::Wait(m_pending);
+	}
+	catch(exception& e)
+	{
+		LOG_ERROR(m_logger, "Error while writing thumbnails: " << e.what());
+	}
 }
 
 
@@ -78,10 +85,15 @@ bool replaceExpr(string& rx_name, const map<string,FeaturePtr>& x_features)
 void ThumbnailWriter::Reset()
 {
 	Module::Reset();
+	ImageEncoder::Wait(m_pending);
 }
 
 void ThumbnailWriter::ProcessFrame()
 {
+	// note: files of the previous frame are written while the current frame is being processed, errors are raised here
+	ImageEncoder::Wait(m_pending);
+
+	ImageEncoder& encoder(RefContext().RefImageEncoder());
 	int cpt = 0;
 	for(auto & elem : m_objectsIn)
 	{
@@ -96,16 +108,9 @@ void ThumbnailWriter::ProcessFrame()
 		ss2 << m_currentTimeStamp << "_" << elem.GetName()<< elem.GetId() << "_" << cpt << ".json";
 		MkDirectory dir(folderName, RefContext().RefOutputDir(), RefContext().RefOutputDir().DirExists(folderName));
 
-		string fileName = dir.ReserveFile(ss2.str());
-		ofstream of(fileName);
-		if(!of.is_open())
-		{
-			throw MkException("Impossible to create file " + ss2.str(), LOC);
-		}
 		LOG_DEBUG(m_logger, "Write object to " << ss2.str());
 		mkjson json(elem);
-		of << multiLine(json);
-		of.close();
+		m_pending.push_back(encoder.Write(multiLine(json), dir.ReserveFile(ss2.str())));
 
 
 		// For each object save a thumbnail
@@ -119,14 +124,14 @@ void ThumbnailWriter::ProcessFrame()
 		}*/
 		std::stringstream ss1;
 		ss1 << m_currentTimeStamp << "_" << elem.GetName()<< elem.GetId() << "_" << cpt << "." << m_param.extension;
-		imwrite(dir.ReserveFile(ss1.str()), (m_input)(rect));
+		m_pending.push_back(encoder.Encode((m_input)(rect), m_param.extension, m_param.quality, dir.ReserveFile(ss1.str())));
 
 		// For each object save a thumbnail
 		if(m_inputStreams.at("image2")->IsConnected())
 		{
 			std::stringstream ss3;
 			ss3 << m_currentTimeStamp << "_" << elem.GetName()<< elem.GetId() << "_" << cpt << "_mask." << m_param.extension;
-			imwrite(dir.ReserveFile(ss3.str()), (m_input2)(rect));
+			m_pending.push_back(encoder.Encode((m_input2)(rect), m_param.extension, m_param.quality, dir.ReserveFile(ss3.str())));
 		}
 
 		cpt++;
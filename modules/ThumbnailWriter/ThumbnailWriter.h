@@ -44,12 +44,14 @@ public:
 		{
 			AddParameter(new ParameterString("folder"    , "thumbs" , &folder    , "Name of the folder to create with path. Use %{feature} to separate by feature"));
 			AddParameter(new ParameterString("extension"  , "jpg"        , &extension , "Extension of the thumbnails. Determines the output format."));
+			AddParameter(new ParameterInt("quality"      , 95, 0, 100 , &quality  , "Quality of the encoding [0-100]. For png it determines the compression level"));
 
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1","CV_8UC3","CV_32FC1","CV_32FC3"]})"_json);
-			RefParameterByName("extension").SetRange(R"({"allowed":["jpg","png"]})"_json);
+			RefParameterByName("extension").SetRange(R"({"allowed":["jpg","png","webp"]})"_json);
 		};
 		std::string folder;
 		std::string extension;
+		int quality;
 	};
 
 	explicit ThumbnailWriter(ParameterStructure& xr_params);
@@ -70,6 +72,9 @@ protected:
 	cv::Mat m_input;
 	cv::Mat m_input2;
 	std::vector <Object> m_objectsIn;
+
+	// state
+	std::vector<std::future<void>> m_pending; // files of the last frame being written
 };
 
 } // namespace mk
@@ -22,7 +22,6 @@
 -------------------------------------------------------------------------------------*/
 
 #include "VideoFileBufferWriter.h"
-#include <thread>
 #include "StreamState.h"
 #include "StreamEvent.h"
 #include "util.h"
@@ -35,12 +34,14 @@ using namespace cv;
 
 log4cxx::LoggerPtr VideoFileBufferWriter::m_logger(log4cxx::Logger::getLogger("VideoFileBufferWriter"));
 
+// Maximal number of jobs waiting for the writing thread: if the queue is full the processing waits
+#define MAX_QUEUED_JOBS 100
+// Estimation of the compression ratio of JPEG, used to allocate the buffer
+#define ESTIMATED_JPEG_RATIO 12
+
 VideoFileBufferWriter::VideoFileBufferWriter(ParameterStructure& xr_params):
 	VideoFileWriter(xr_params),
-	m_param(dynamic_cast<Parameters&>(xr_params)),
-	m_buffer1(m_param.bufferFramesBefore),
-	m_buffer2(m_param.bufferFramesBefore + 100),
-	m_threadIsWorking(false)
+	m_param(dynamic_cast<Parameters&>(xr_params))
 {
 	// AddInputStream(0, new StreamImage("image", m_input, *this,   "Video input"));
 	AddInputStream(1, new StreamState("trigger", m_trigger, *this,  "Trigger to start/stop of the recording (e.g. motion)"));
@@ -56,15 +57,17 @@ VideoFileBufferWriter::VideoFileBufferWriter(ParameterStructure& xr_params):
 VideoFileBufferWriter::~VideoFileBufferWriter()
 {
 	CloseFile();
+	// note: the remaining jobs are written before the thread exits
+	mp_queue.reset();
 }
 
+/**
+* @brief Wait until all frames are written by the writing thread
+*/
 void VideoFileBufferWriter::WaitForThread() const
 {
-	while(m_threadIsWorking)
-	{
-		LOG_WARN(m_logger, "Thread is still working. Waiting 0.1 sec.");
-		usleep(100000);
-	}
+	if(mp_queue != nullptr)
+		mp_queue->Flush();
 }
 
 void VideoFileBufferWriter::Reset()
@@ -72,21 +75,35 @@ void VideoFileBufferWriter::Reset()
 	// note: we do not want to call the Reset of VideoFileWriter since the video file is opened later
 	Module::Reset();
 	CloseFile();
-	m_buffer1.clear();
-	m_buffer2.clear();
+	mp_queue.reset();
+
+	// Allocate the buffer of encoded frames
+	size_t capacity = 0;
+	if(m_param.bufferFramesBefore > 0)
+	{
+		capacity = m_param.bufferMemory > 0 ? static_cast<size_t>(m_param.bufferMemory * 1024 * 1024)
+			: static_cast<size_t>(m_param.bufferFramesBefore) * m_param.width * m_param.height * 3 / ESTIMATED_JPEG_RATIO;
+	}
+	m_ring.Reset(capacity, m_param.bufferFramesBefore);
+	LOG_DEBUG(m_logger, "Allocated " << capacity / 1024 << " kB of buffer for " << m_param.bufferFramesBefore << " frames");
+	m_writing = false;
+	{
+		lock_guard<mutex> lock(m_mutexImages);
+		m_freeImages.clear();
+	}
+	mp_queue.reset(new BatchQueue<Job>(1, 0, MAX_QUEUED_JOBS, [this](vector<Job>& xr_jobs){WriteJobs(xr_jobs);}));
 }
 
 void VideoFileBufferWriter::CloseFile()
 {
-	// finalize
-	WaitForThread();
-	if(!m_writer.isOpened())
-		m_writer.release();
-	if (m_eraseFile && !m_fileName.empty())
+	// finalize: the file is closed (and erased) by the writing thread
+	if(mp_queue != nullptr && !m_fileName.empty())
 	{
-		LOG_DEBUG(m_logger, "Delete file "<<m_fileName);
-		if (remove(m_fileName.c_str()) != 0)
-			LOG_WARN(m_logger, "Error deleting temporary video file named " << m_fileName);
+		Job job;
+		job.type     = Job::CLOSE;
+		job.fileName = m_fileName;
+		job.erase    = m_eraseFile;
+		mp_queue->Push(std::move(job));
 	}
 	m_recording  = false;
 	m_eraseFile  = !m_param.keepAllRecordings;
@@ -97,12 +114,9 @@ void VideoFileBufferWriter::OpenNewFile()
 {
 	if(m_param.fourcc.size() != 4)
 		throw MkException("Error in parameter: fourcc must have 4 characters in VideoFileBufferWriter::Reset", LOC);
-	const char * s = m_param.fourcc.c_str();
-	// The color flag seem to be supported on Windows only
-	// http://docs.opencv.org/modules/highgui/doc/reading_and_writing_images_and_video.html#videowriter-videowriter
-	bool isColor = true;
 	assert(m_param.type == CV_8UC3);
 
+	// note: the file name is reserved here since it is linked to events
 	stringstream ss;
 	ss << m_param.file  << "." << m_currentTimeStamp << "." << ExtensionFromFourcc(m_param.fourcc);
 	m_fileName = RefContext().RefOutputDir().ReserveFile(ss.str());
@@ -121,42 +135,35 @@ void VideoFileBufferWriter::OpenNewFile()
 	}
 
 	LOG_DEBUG(m_logger, "Start recording file "<<m_fileName<<" with fps="<<fps<<" and size "<<m_param.width<<"x"<<m_param.height);
-	WaitForThread();
-	m_writer.open(m_fileName, CV_FOURCC(s[0], s[1], s[2], s[3]), fps, Size(m_param.width, m_param.height), isColor);
-	if(!m_writer.isOpened())
-	{
-		throw MkException("Failed to open output video file in VideoFileBufferWriter::Reset", LOC);
-	}
+	Job job;
+	job.type     = Job::OPEN;
+	job.fileName = m_fileName;
+	job.fps      = fps;
+	mp_queue->Push(std::move(job));
+}
 
+void VideoFileBufferWriter::PrintStatistics(mkconf& xr_result) const
+{
+	Module::PrintStatistics(xr_result);
+	WaitForThread();
+	xr_result["module"][GetName()]["bufferedFrames"] = m_ring.Size();
+	xr_result["module"][GetName()]["bufferedBytes"]  = m_ring.GetUsedBytes();
 }
 
 void VideoFileBufferWriter::ProcessFrame()
 {
 	LOG_DEBUG(m_logger, "Recording=" << m_recording << " until " << m_endOfRecord << " (" << (m_endOfRecord - m_currentTimeStamp) / 1000.0
-			  << "s) trigger=" << m_trigger << " event=" << m_event.IsRaised() << " thread=" << m_threadIsWorking);
+			  << "s) trigger=" << m_trigger << " event=" << m_event.IsRaised());
 
-	// We are always buffering
-	m_buffer1.push_back(Mat());
-	m_input.copyTo(m_buffer1.back());
+	// We are always buffering: the frame is encoded and added to the buffer by the writing thread
+	Job frame;
+	frame.image = TakeImage();
+	m_input.copyTo(frame.image);
+	frame.timeStamp = m_currentTimeStamp;
+	mp_queue->Push(std::move(frame));
 
 	if(m_recording)
 	{
-		m_mutex.lock();
-		if(!m_threadIsWorking)
-		{
-			// Thread is complete: write directly
-			m_writer.write(m_input);
-		}
-		else
-		{
-			// Thread is working: add to buffer
-			if(m_buffer2.size() == m_buffer2.max_size())
-				LOG_ERROR(m_logger, "Buffer is not being written fast enough to disk, loosing frames");
-			m_buffer2.push_back();
-			m_input.copyTo(m_buffer2.back());
-		}
-		m_mutex.unlock();
-
 		if(m_trigger || m_event.IsRaised())
 			m_endOfRecord = m_currentTimeStamp + m_param.bufferDurationAfter * 1000;
 
@@ -169,42 +176,10 @@ void VideoFileBufferWriter::ProcessFrame()
 	}
 	else
 	{
-		// If there is motion or if an event occurs, start recording
+		// If there is motion or if an event occurs, start recording: the buffer is written first
 		if(m_trigger || m_event.IsRaised())
 		{
-			// Write the buffer to disk
 			OpenNewFile();
-			LOG_DEBUG(m_logger, "Open " + m_fileName + " for " + to_string(m_buffer1.size()) + " frames");
-			// m_buffer2 = boost::circular_buffer<Mat>(m_buffer1);
-			for(const auto elem : m_buffer1)
-			{
-				m_buffer2.push_back();
-				elem.copyTo(m_buffer2.back());
-			}
-			assert(!m_buffer1.empty());
-			assert(!m_buffer2.empty());
-			LOG_DEBUG(m_logger, "Starting thread");
-			m_threadIsWorking = true; // note: must be set here to handle case where destructor is called
-
-			std::thread t([this]()
-			{
-				// start new thread
-				while(true)
-				{
-					m_mutex.lock();
-					if(m_buffer2.empty())
-					{
-						m_mutex.unlock();
-						break;
-					}
-					m_writer.write(m_buffer2.front());
-					m_buffer2.pop_front();
-
-					m_mutex.unlock();
-				}
-				m_threadIsWorking = false;
-			});
-			t.detach();
 			m_endOfRecord = m_currentTimeStamp + m_param.bufferDurationAfter * 1000;
 			m_recording = true;
 		}
@@ -219,4 +194,100 @@ void VideoFileBufferWriter::ProcessFrame()
 	}
 }
 
+/**
+* @brief Process the jobs in the writing thread
+*
+* @param xr_jobs Jobs in the order of submission
+*/
+void VideoFileBufferWriter::WriteJobs(vector<Job>& xr_jobs)
+{
+	for(auto& job : xr_jobs)
+	{
+		switch(job.type)
+		{
+			case Job::FRAME:
+				WriteFrame(job);
+				break;
+			case Job::OPEN:
+				OpenInThread(job);
+				break;
+			case Job::CLOSE:
+				CloseInThread(job);
+				break;
+		}
+	}
+}
+
+/**
+* @brief Encode a frame to the buffer and write it to file if recording. With MJPG the encoded frame is written as it is.
+*/
+void VideoFileBufferWriter::WriteFrame(Job& xr_job)
+{
+	if(m_ring.GetCapacity() > 0 || m_aviWriter.IsOpened())
+	{
+		if(!imencode(".jpg", xr_job.image, m_encoded, {IMWRITE_JPEG_QUALITY, m_param.bufferQuality}))
+			throw MkException("Cannot encode frame to JPEG", LOC);
+		m_ring.Push(m_encoded, xr_job.timeStamp);
+	}
+	if(m_writing)
+	{
+		if(m_aviWriter.IsOpened())
+			m_aviWriter.WriteEncoded(m_encoded);
+		else
+			m_writer.write(xr_job.image);
+	}
+
+	ReleaseImage(xr_job.image);
+}
+
+/**
+* @brief Open the video file and write the content of the buffer
+*/
+void VideoFileBufferWriter::OpenInThread(const Job& x_job)
+{
+	Size size(m_param.width, m_param.height);
+	LOG_DEBUG(m_logger, "Open " + x_job.fileName + " for " + to_string(m_ring.Size()) + " frames");
+	if(m_param.fourcc == "MJPG")
+	{
+		// the frames of the buffer are copied without decoding
+		m_aviWriter.Open(x_job.fileName, x_job.fps, size);
+		for(size_t i = 0 ; i < m_ring.Size() ; i++)
+			m_aviWriter.WriteEncoded(m_ring.Data(m_ring.At(i)), m_ring.At(i).size);
+	}
+	else
+	{
+		const char * s = m_param.fourcc.c_str();
+		// The color flag seem to be supported on Windows only
+		// http://docs.opencv.org/modules/highgui/doc/reading_and_writing_images_and_video.html#videowriter-videowriter
+		bool isColor = true;
+		m_writer.open(x_job.fileName, CV_FOURCC(s[0], s[1], s[2], s[3]), x_job.fps, size, isColor);
+		if(!m_writer.isOpened())
+			throw MkException("Failed to open output video file " + x_job.fileName + " in VideoFileBufferWriter", LOC);
+		Mat decoded;
+		for(size_t i = 0 ; i < m_ring.Size() ; i++)
+		{
+			const EncodedFrameRing::Frame& frame(m_ring.At(i));
+			imdecode(Mat(1, frame.size, CV_8UC1, const_cast<uchar*>(m_ring.Data(frame))), IMREAD_COLOR, &decoded);
+			m_writer.write(decoded);
+		}
+	}
+	m_writing = true;
+}
+
+/**
+* @brief Close the video file and delete it if needed
+*/
+void VideoFileBufferWriter::CloseInThread(const Job& x_job)
+{
+	m_aviWriter.Close();
+	m_writer.release();
+	m_writing = false;
+	if(x_job.erase)
+	{
+		LOG_DEBUG(m_logger, "Delete file " << x_job.fileName);
+		if (remove(x_job.fileName.c_str()) != 0)
+			LOG_WARN(m_logger, "Error deleting temporary video file named " << x_job.fileName);
+	}
+}
+
 } // namespace mk
@@ -25,15 +25,18 @@
 #define INPUT_VIDEOFILEBUFFERWRITER_H
 
 #include <mutex>
-#include <atomic>
-#include <boost/circular_buffer.hpp>
+#include <memory>
 #include <opencv2/highgui/highgui.hpp>
 #include "modules/VideoFileWriter/VideoFileWriter.h"
 #include "Event.h"
+#include "BatchQueue.h"
+#include "EncodedFrameRing.h"
+#include "MjpegAviWriter.h"
 
 namespace mk {
 /**
-* @brief Write output to a buffer and exports it if an evenement occurs
+* @brief Write output to a buffer and exports it if an evenement occurs. The buffer contains frames encoded in JPEG,
+*        encoding and writing is done in a separate thread.
 */
 class VideoFileBufferWriter : public VideoFileWriter
 {
@@ -47,13 +50,23 @@ public:
 			AddParameter(new ParameterInt   ("bufferFramesBefore" , 1200, 0, 10000, &bufferFramesBefore,  "Length of video buffer before activity [frames]"));
 			AddParameter(new ParameterDouble("bufferDurationAfter", 120, 0, 600,    &bufferDurationAfter, "Length of video buffer after activity [s]. If possible this should be longer than the duration before next event."));
 			AddParameter(new ParameterBool("keepAllRecordings"    , false,          &keepAllRecordings  , "Keep all recordings, event if no event is associated with it."));
+			AddParameter(new ParameterInt   ("bufferQuality"      , 90, 0, 100,     &bufferQuality,       "Quality of the JPEG encoding of the frames in buffer"));
+			AddParameter(new ParameterDouble("bufferMemory"       , 0, 0, 4096,     &bufferMemory,        "Memory allocated to the buffer [MB]. If 0 this is estimated from the number of frames and the image size"));
 
 			RefParameterByName("type").SetDefaultAndValue("CV_8UC3");
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC3"]})"_json);
+
+			// note: this module always writes in a separate thread
+			RefParameterByName("asynchronous").Hide();
+			RefParameterByName("queueSize").Hide();
+			RefParameterByName("dropFrames").Hide();
+			RefParameterByName("segmentDuration").Hide();
 		};
 		int    bufferFramesBefore;
 		double bufferDurationAfter;
 		bool   keepAllRecordings;
+		int    bufferQuality;
+		double bufferMemory;
 	};
 
 	explicit VideoFileBufferWriter(ParameterStructure& xr_params);
@@ -62,10 +75,10 @@ public:
 	MKCATEG("Output")
 	MKDESCR("Write output to a buffer and export it if an evenement occurs")
 
-	void AddImageToBuffer();
 	void OpenNewFile();
 	void CloseFile();
 	void WaitForThread() const;
+	void PrintStatistics(mkconf& xr_result) const override;
 
 private:
 	const Parameters& m_param;
@@ -87,11 +100,31 @@ protected:
 	std::string m_fileName;
 
 	// temporary
-	boost::circular_buffer<cv::Mat> m_buffer1;
-	boost::circular_buffer<cv::Mat> m_buffer2;
 	TIME_STAMP m_endOfRecord;
-	std::mutex m_mutex;
-	std::atomic<bool> m_threadIsWorking;
+
+	/// A job for the writing thread
+	struct Job
+	{
+		enum Type {FRAME, OPEN, CLOSE};
+		Type        type  = FRAME;
+		cv::Mat     image;
+		TIME_STAMP  timeStamp = 0;
+		std::string fileName;
+		double      fps   = 0;
+		bool        erase = false;
+	};
+	void WriteJobs(std::vector<Job>& xr_jobs);
+	void WriteFrame(Job& xr_job);
+	void OpenInThread(const Job& x_job);
+	void CloseInThread(const Job& x_job);
+
+	std::unique_ptr<BatchQueue<Job>> mp_queue;
+
+	// used by the writing thread only
+	EncodedFrameRing     m_ring;
+	MjpegAviWriter       m_aviWriter;
+	std::vector<uchar>   m_encoded;
+	bool                 m_writing = false;
 };
 
 } // namespace mk
@@ -43,54 +43,179 @@ VideoFileWriter::VideoFileWriter(ParameterStructure& xr_params):
 
 VideoFileWriter::~VideoFileWriter()
 {
-	// cout<<"Release FileWriter"<<endl;
-	// m_writer.release();
+	// note: the remaining frames are written before the thread exits
+	mp_encoderQueue.reset();
 }
 
 void VideoFileWriter::Reset()
 {
 	Module::Reset();
+	mp_encoderQueue.reset();
 	if(!m_writer.isOpened())
 		m_writer.release();
 	// m_writer.release();
 	if(m_param.fourcc.size() != 4)
 		throw MkException("Error in parameter: fourcc must have 4 characters in VideoFileWriter::Reset", LOC);
-	const char * s = m_param.fourcc.c_str();
-	// The color flag seem to be supported on Windows only
-	// http://docs.opencv.org/modules/highgui/doc/reading_and_writing_images_and_video.html#videowriter-videowriter
-	bool isColor = true;
 	assert(m_param.type == CV_8UC3);
 
-	stringstream ss;
-	ss << m_param.file  << "." << m_index++ << "." << ExtensionFromFourcc(m_param.fourcc);
-	const string filename = RefContext().RefOutputDir().ReserveFile(ss.str());
-	double fps = 12;
-
+	m_fps = 12;
 	try
 	{
-		fps = GetRecordingFps();
-		if(fps == 0)
-			fps = 8; // default 8 fps
+		m_fps = GetRecordingFps();
+		if(m_fps == 0)
+			m_fps = 8; // default 8 fps
 	}
 	catch(exception& e)
 	{
 		// This may happen if the module is not connected
-		LOG_WARN(m_logger, "Impossible to acquire the fps value for recording in VideoFileWriter::Reset. Set to default value " << fps << ". Reason: " << e.what());
+		LOG_WARN(m_logger, "Impossible to acquire the fps value for recording in VideoFileWriter::Reset. Set to default value " << m_fps << ". Reason: " << e.what());
 	}
 
-	LOG_DEBUG(m_logger, "Start recording file "<<filename<<" with fps="<<fps<<" and size "<<m_param.width<<"x"<<m_param.height);
-	m_writer.open(filename, CV_FOURCC(s[0], s[1], s[2], s[3]), fps, Size(m_param.width, m_param.height), isColor);
+	m_nbDropped = 0;
+	m_maxQueued = 0;
+	m_nbEncoded = 0;
+	m_timerEncoding.Reset();
+	if(m_param.asynchronous)
+		mp_encoderQueue.reset(new BatchQueue<Job>(1, 0, m_param.queueSize, [this](vector<Job>& xr_jobs){WriteJobs(xr_jobs);}));
+	OpenSegment();
+}
+
+/**
+* @brief Reserve the name of a new file and open it. In asynchronous mode the file is opened by the encoding thread
+*/
+void VideoFileWriter::OpenSegment()
+{
+	stringstream ss;
+	ss << m_param.file  << "." << m_index++ << "." << ExtensionFromFourcc(m_param.fourcc);
+	const string filename = RefContext().RefOutputDir().ReserveFile(ss.str());
+	// note: the start of the segment is the time stamp of its first frame
+	m_segmentStarted = false;
+
+	if(mp_encoderQueue == nullptr)
+	{
+		OpenWriter(filename, m_fps);
+		return;
+	}
+	Job job;
+	job.fileName = filename;
+	mp_encoderQueue->Push(std::move(job));
+}
+
+/**
+* @brief Open the video writer on a new file
+*
+* @param x_fileName Name of the file with path
+* @param x_fps      Frame rate
+*/
+void VideoFileWriter::OpenWriter(const string& x_fileName, double x_fps)
+{
+	const char * s = m_param.fourcc.c_str();
+	// The color flag seem to be supported on Windows only
+	// http://docs.opencv.org/modules/highgui/doc/reading_and_writing_images_and_video.html#videowriter-videowriter
+	bool isColor = true;
+
+	m_writer.release();
+	LOG_DEBUG(m_logger, "Start recording file "<<x_fileName<<" with fps="<<x_fps<<" and size "<<m_param.width<<"x"<<m_param.height);
+	m_writer.open(x_fileName, CV_FOURCC(s[0], s[1], s[2], s[3]), x_fps, Size(m_param.width, m_param.height), isColor);
 	if(!m_writer.isOpened())
 	{
-		throw MkException("Failed to open output video file " + filename + " in VideoFileWriter::Reset", LOC);
+		throw MkException("Failed to open output video file " + x_fileName + " in VideoFileWriter::Reset", LOC);
 	}
 }
 
 void VideoFileWriter::ProcessFrame()
 {
-	// cout << "write frame " << m_input->cols << "x" << m_input->rows << endl;
-	// m_writer << *m_input;
-	m_writer.write(m_input);
+	if(m_segmentStarted && m_param.segmentDuration > 0 && m_currentTimeStamp - m_segmentStart >= m_param.segmentDuration * 1000)
+		OpenSegment();
+	if(!m_segmentStarted)
+	{
+		m_segmentStart   = m_currentTimeStamp;
+		m_segmentStarted = true;
+	}
+
+	if(mp_encoderQueue == nullptr)
+	{
+		EncodeFrame(m_input);
+		return;
+	}
+
+	Job job;
+	job.image = TakeImage();
+	m_input.copyTo(job.image);
+	if(!m_param.dropFrames)
+		mp_encoderQueue->Push(std::move(job));
+	else if(!mp_encoderQueue->TryPush(std::move(job)))
+	{
+		if(m_nbDropped == 0)
+			LOG_WARN(m_logger, "Frames are not encoded fast enough, dropping frames in module " << GetName());
+		m_nbDropped++;
+	}
+	m_maxQueued = max(m_maxQueued, mp_encoderQueue->GetNbQueued());
+}
+
+/**
+* @brief Encode a frame to the video file
+*/
+void VideoFileWriter::EncodeFrame(const Mat& x_image)
+{
+	m_timerEncoding.Start();
+	m_writer.write(x_image);
+	m_timerEncoding.Stop();
+	m_nbEncoded++;
+}
+
+/**
+* @brief Process the jobs in the encoding thread
+*
+* @param xr_jobs Jobs in the order of submission
+*/
+void VideoFileWriter::WriteJobs(vector<Job>& xr_jobs)
+{
+	for(auto& job : xr_jobs)
+	{
+		if(!job.fileName.empty())
+		{
+			OpenWriter(job.fileName, m_fps);
+			continue;
+		}
+		EncodeFrame(job.image);
+		ReleaseImage(job.image);
+	}
+}
+
+/**
+* @brief Return an image from the pool, to avoid an allocation for each frame
+*/
+Mat VideoFileWriter::TakeImage()
+{
+	lock_guard<mutex> lock(m_mutexImages);
+	if(m_freeImages.empty())
+		return Mat();
+	Mat image = m_freeImages.back();
+	m_freeImages.pop_back();
+	return image;
+}
+
+/**
+* @brief Return an image to the pool once it is not used anymore
+*/
+void VideoFileWriter::ReleaseImage(const Mat& x_image)
+{
+	lock_guard<mutex> lock(m_mutexImages);
+	m_freeImages.push_back(x_image);
+}
+
+void VideoFileWriter::PrintStatistics(mkconf& xr_result) const
+{
+	Module::PrintStatistics(xr_result);
+	if(mp_encoderQueue != nullptr)
+		mp_encoderQueue->Flush();
+	double encodingTime = m_timerEncoding.GetSecDouble();
+	double fps = encodingTime > 0 ? m_nbEncoded / encodingTime : 0;
+	LOG_INFO(m_logger, "Module " << GetName() << ": " << m_nbEncoded << " frames encoded at " << fps << " fps, " << m_nbDropped << " dropped, max queue size " << m_maxQueued);
+	xr_result["module"][GetName()]["encodingFps"]   = fps;
+	xr_result["module"][GetName()]["framesDropped"] = m_nbDropped;
+	xr_result["module"][GetName()]["maxQueueSize"]  = m_maxQueued;
 }
 
 
@@ -25,7 +25,10 @@
 #define INPUT_VIDEOFILEWRITER_H
 
 #include <opencv2/highgui/highgui.hpp>
+#include <mutex>
+#include <memory>
 #include "Module.h"
+#include "BatchQueue.h"
 
 
 
@@ -45,6 +48,10 @@ public:
 		{
 			AddParameter(new ParameterString("file", 	  "output", 	     &file,      "Name of the video file to write, with path"));
 			AddParameter(new ParameterString("fourcc", 	  "MJPG", 	     &fourcc,    "Four character code, determines the format. PIM1, MJPG, MP42, DIV3, DIVX, H263, I263, FLV1"));
+			AddParameter(new ParameterBool("asynchronous",  false,         &asynchronous, "Encode and write the frames in a separate thread"));
+			AddParameter(new ParameterInt("queueSize",      50, 1, 10000,  &queueSize, "Maximal number of frames waiting to be encoded in asynchronous mode"));
+			AddParameter(new ParameterBool("dropFrames",    false,         &dropFrames, "If the queue is full drop the frame, otherwise the processing waits"));
+			AddParameter(new ParameterDouble("segmentDuration", 0, 0, 86400, &segmentDuration, "Duration of each video file, a new file is created after this duration [s]. If 0 one file is created"));
 
 			RefParameterByName("width").SetRange(R"({"min":32, "max":6400})"_json);
 			RefParameterByName("height").SetRange(R"({"min":24, "max":4800})"_json);
@@ -56,6 +63,10 @@ public:
 
 		std::string file;
 		std::string fourcc;
+		bool        asynchronous;
+		int         queueSize;
+		bool        dropFrames;
+		double      segmentDuration;
 	};
 
 	explicit VideoFileWriter(ParameterStructure& xr_params);
@@ -64,6 +75,7 @@ public:
 	MKCATEG("Output")
 	MKDESCR("Write output to a video file")
 
+	void PrintStatistics(mkconf& xr_result) const override;
 	static const std::string ExtensionFromFourcc(const std::string& x_fourcc);
 
 private:
@@ -82,6 +94,33 @@ protected:
 
 	// temporary
 	cv::VideoWriter m_writer;
+
+	void OpenSegment();
+	void OpenWriter(const std::string& x_fileName, double x_fps);
+	void EncodeFrame(const cv::Mat& x_image);
+	cv::Mat TakeImage();
+	void ReleaseImage(const cv::Mat& x_image);
+
+	std::mutex           m_mutexImages;
+	std::vector<cv::Mat> m_freeImages;   // pool of images to pass frames to a thread
+
+private:
+	/// A frame to encode or, if the file name is set, a new file to open
+	struct Job
+	{
+		cv::Mat     image;
+		std::string fileName;
+	};
+	void WriteJobs(std::vector<Job>& xr_jobs);
+
+	std::unique_ptr<BatchQueue<Job>> mp_encoderQueue;
+	double     m_fps = 0;
+	TIME_STAMP m_segmentStart   = 0;
+	bool       m_segmentStarted = false; // true once the first frame of the segment is written
+	uint64_t   m_nbDropped    = 0;
+	size_t     m_maxQueued    = 0;
+	Timer      m_timerEncoding;  // used by the encoding thread only
+	uint64_t   m_nbEncoded    = 0;
 };
 
 } // namespace mk
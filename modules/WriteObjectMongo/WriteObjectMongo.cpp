@@ -28,6 +28,7 @@
 #include "StreamImage.h"
 #include "Manager.h"
 #include "util.h"
+#include "ImageEncoder.h"
 namespace mk {
 
 using namespace std;
@@ -52,6 +53,7 @@ WriteObjectMongo::WriteObjectMongo(ParameterStructure& xr_params)
 
 WriteObjectMongo::~WriteObjectMongo()
 {
+	DestroyQueue();
 	if(mp_gridfs)
 		mongoc_gridfs_destroy(mp_gridfs);
 	if(mp_collection)
@@ -61,10 +63,31 @@ WriteObjectMongo::~WriteObjectMongo()
 	mongoc_cleanup();
 }
 
+/**
+* @brief Write all pending documents and stop the writing thread
+*/
+void WriteObjectMongo::DestroyQueue()
+{
+	if(mp_queue == nullptr)
+		return;
+	try
+	{
+		mp_queue->Flush();
+	}
+	catch(exception& e)
+	{
+		LOG_ERROR(m_logger, "Exception while writing to MongoDB: " << e.what());
+	}
+	mp_queue.reset();
+}
+
 void WriteObjectMongo::Reset()
 {
 	Module::Reset();
 
+	// note: the database must not be accessed by the thread while reconnecting
+	DestroyQueue();
+
 	m_jobId = GetContext().GetJobId();
 
 	mp_outputDir = std::make_unique<MkDirectory>(m_param.folder, RefContext().RefOutputDir(), false);
@@ -106,6 +129,9 @@ void WriteObjectMongo::Reset()
 
 	bson_destroy(doc);
 	mongoc_collection_destroy(p_job_collection);
+
+	mp_queue = std::make_unique<BatchQueue<Document>>(m_param.batchSize, m_param.flushInterval, 10 * m_param.batchSize,
+		[this](vector<Document>& xr_documents){WriteBatch(xr_documents);});
 }
 
 const char* WriteObjectMongo::contentType(const string& x_fileName)
@@ -113,6 +139,8 @@ const char* WriteObjectMongo::contentType(const string& x_fileName)
 	static const map<string, string> typeList = {
 		{"jpg", "image/jpeg"}, 
 		{"jpeg", "image/jpeg"}, 
+		{"png", "image/png"}, 
+		{"webp", "image/webp"}, 
 		{"svg", "image/svg+xml"}, 
 		{"image", "image/png"}
 	};
@@ -133,55 +161,156 @@ const char* WriteObjectMongo::contentType(const string& x_fileName)
 
 void WriteObjectMongo::ProcessFrame()
 {
+	// Encode all images in parallel to memory buffers
+	bool saveImage = m_inputStreams.at("image")->IsConnected();
+	if(saveImage)
+		EncodeImages();
+
 	int cpt = 0;
 	for(const auto& elem : m_objects)
 	{
-		// mongoc_cursor_t *cursor;
 		bson_error_t error;
 
 		mkjson json(elem);
-		bson_t* doc = bson_new_from_json(reinterpret_cast<const uint8_t*>(oneLine(json).c_str()), -1, &error);
-		assert(doc);
+		Document document;
+		document.doc.reset(bson_new_from_json(reinterpret_cast<const uint8_t*>(oneLine(json).c_str()), -1, &error));
+		if(document.doc == nullptr)
+			throw MkException("Error at creation of BSON document: " + string(error.message), LOC);
 
 		// create a mongo document
 		bson_oid_t oid;
 		bson_oid_init(&oid, NULL);
-		BSON_APPEND_OID(doc, "_id", &oid);
-		bson_append_utf8(doc, "jobId", -1, m_jobId.c_str(), -1);
+		BSON_APPEND_OID(document.doc.get(), "_id", &oid);
+		bson_append_utf8(document.doc.get(), "jobId", -1, m_jobId.c_str(), -1);
 
 		// For each object save an image
-		if(m_inputStreams.at("image")->IsConnected())
+		if(saveImage)
 		{
 			stringstream sfile;
 			sfile << m_currentTimeStamp << "_" << elem.GetName() << elem.GetId() << "_" << cpt << "." << m_param.extension;
-			string path = mp_outputDir.get()->ReserveFile(sfile.str());
-			imwrite(path, (m_image)(elem.GetRect()));
-
-			// Save to mongo db
-			mongoc_gridfs_file_opt_t opt = {};
-			mongoc_stream_t *stream = mongoc_stream_file_new_for_path(path.c_str(), O_RDONLY, 0);
-			assert(stream);
-			string name = m_jobId + '/' + sfile.str();
-			opt.filename = name.c_str();
-			mongoc_gridfs_file_t *file = mongoc_gridfs_create_file_from_stream(mp_gridfs, stream, &opt);
-			assert(file);
-
-			mongoc_gridfs_file_save(file);
-			mongoc_gridfs_file_destroy(file);
-
-			bson_append_utf8(doc, "file", -1, name.c_str(), -1);
-			if(m_param.cleanFiles)
-				mp_outputDir.get()->Rm(sfile.str());
+			document.fileName = m_jobId + '/' + sfile.str();
+			bson_append_utf8(document.doc.get(), "file", -1, document.fileName.c_str(), -1);
+
+			// Keep a copy of the file on disk if required
+			if(!m_param.cleanFiles)
+				document.filePath = mp_outputDir.get()->ReserveFile(sfile.str());
+			// note: the buffer is copied, the one of the module keeps its allocation for the next frame
+			document.image = m_buffers.at(cpt);
 		}
 
-		if(!mongoc_collection_insert(mp_collection, MONGOC_INSERT_NONE, doc, NULL, &error))
+		// note: the document is written to the database by the thread of the queue
+		mp_queue->Push(std::move(document));
+		cpt++;
+	}
+}
+
+/**
+* @brief Write a batch of documents to the database. This is called from the thread of the queue
+*
+* @param xr_documents Documents to write
+*/
+void WriteObjectMongo::WriteBatch(vector<Document>& xr_documents)
+{
+	// Save images to GridFS directly from the memory buffers
+	for(const auto& elem : xr_documents)
+	{
+		if(elem.fileName.empty())
+			continue;
+		SaveToGridFS(elem.fileName, elem.image);
+		if(!elem.filePath.empty())
+			ImageEncoder::WriteToFile(elem.image, elem.filePath);
+	}
+
+	// Insert all documents at once
+	mongoc_bulk_operation_t* bulk = mongoc_collection_create_bulk_operation(mp_collection, false, NULL);
+	for(const auto& elem : xr_documents)
+		mongoc_bulk_operation_insert(bulk, elem.doc.get());
+
+	bson_t reply;
+	bson_error_t error;
+	bool ret = mongoc_bulk_operation_execute(bulk, &reply, &error);
+	bson_destroy(&reply);
+	mongoc_bulk_operation_destroy(bulk);
+	if(!ret)
+		throw MkException("Error at mongo db insertion: " + string(error.message), LOC);
+	LOG_DEBUG(m_logger, "Inserted " << xr_documents.size() << " documents to " << m_dbCollection);
+}
+
+/**
+* @brief Print statistics on the number of inserted documents
+*/
+void WriteObjectMongo::PrintStatistics(mkconf& xr_result) const
+{
+	Module::PrintStatistics(xr_result);
+	if(mp_queue == nullptr)
+		return;
+	LOG_INFO(m_logger, "Module " << GetName() << ": " << mp_queue->GetNbWritten() << " documents inserted in " << mp_queue->GetNbBatches() << " batches");
+	xr_result["module"][GetName()]["documents"] = mp_queue->GetNbWritten();
+	xr_result["module"][GetName()]["batches"]   = mp_queue->GetNbBatches();
+}
+
+/**
+* @brief Encode the images of all objects in parallel. The resulting bytes are stored in m_buffers
+*/
+void WriteObjectMongo::EncodeImages()
+{
+	ImageEncoder& encoder(RefContext().RefImageEncoder());
+
+	// note: buffers are kept from one frame to the next to reuse their allocations
+	if(m_buffers.size() < m_objects.size())
+		m_buffers.resize(m_objects.size());
+
+	vector<future<void>> futures;
+	futures.reserve(m_objects.size());
+	try
+	{
+		for(size_t i = 0 ; i < m_objects.size() ; i++)
 		{
-			throw MkException("Error at mongo db insertion: " + string(error.message), LOC);
+			vector<uchar>& buffer(m_buffers[i]);
+			futures.push_back(encoder.Encode((m_image)(m_objects[i].GetRect()), m_param.extension, m_param.quality, [&buffer](const vector<uchar>& x_buffer)
+			{
+				buffer.assign(x_buffer.begin(), x_buffer.end());
+			}));
 		}
+	}
+	catch(...)
+	{
+		// note: the queued jobs write to m_buffers, they must be done before leaving
+		for(auto& elem : futures)
+			elem.wait();
+		throw;
+	}
 
-		bson_destroy(doc);
-		cpt++;
+	// Wait for all images: this rethrows exceptions of the encoder
+	ImageEncoder::Wait(futures);
+}
+
+/**
+* @brief Write an encoded image to GridFS
+*
+* @param x_name   Name of the file in GridFS
+* @param x_buffer Encoded image
+*/
+void WriteObjectMongo::SaveToGridFS(const string& x_name, const vector<uchar>& x_buffer)
+{
+	mongoc_gridfs_file_opt_t opt = {};
+	opt.filename = x_name.c_str();
+	const char* type = contentType(x_name);
+	if(*type != '\0')
+		opt.content_type = type;
+	mongoc_gridfs_file_t *file = mongoc_gridfs_create_file(mp_gridfs, &opt);
+	if(file == nullptr)
+		throw MkException("Cannot create GridFS file " + x_name, LOC);
+
+	mongoc_iovec_t iov;
+	iov.iov_base = const_cast<uchar*>(x_buffer.data());
+	iov.iov_len  = x_buffer.size();
+	if(mongoc_gridfs_file_writev(file, &iov, 1, 0) != static_cast<ssize_t>(x_buffer.size()) || !mongoc_gridfs_file_save(file))
+	{
+		mongoc_gridfs_file_destroy(file);
+		throw MkException("Error while writing GridFS file " + x_name, LOC);
 	}
+	mongoc_gridfs_file_destroy(file);
 }
 
 bool WriteObjectMongo::IsInputProcessed() const
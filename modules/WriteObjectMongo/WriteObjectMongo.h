@@ -26,6 +26,7 @@
 
 #include "Module.h"
 #include "Object.h"
+#include "BatchQueue.h"
 #include <mongoc.h>
 
 namespace mk {
@@ -47,14 +48,21 @@ public:
 			AddParameter(new ParameterString("collection", "objects"       , &collection, "MongoDB collection"));
 			AddParameter(new ParameterBool("cleanFiles", true            , &cleanFiles, "Erase image and other files after insertion in database"));
 			AddParameter(new ParameterString("extension"  , "jpg"        , &extension , "Extension of the thumbnails. Determines the output format."));
+			AddParameter(new ParameterInt("quality"       , 95, 0, 100   , &quality   , "Quality of the encoding [0-100]. For png it determines the compression level"));
+			AddParameter(new ParameterInt("batchSize"     , 100, 1, 10000, &batchSize , "Number of documents inserted at once in the database"));
+			AddParameter(new ParameterDouble("flushInterval", 1, 0, 60   , &flushInterval, "Maximal time that a document waits before insertion [s]. If 0 documents are inserted as soon as possible"));
 
 			RefParameterByName("type").SetDefaultAndValue("CV_8UC3");
 			RefParameterByName("type").SetValueToDefault();
 			RefParameterByName("type").SetRange(R"({"allowed":["CV_8UC1","CV_8UC3"]})"_json);
+			RefParameterByName("extension").SetRange(R"({"allowed":["jpg","png","webp"]})"_json);
 		}
 		bool cleanFiles;
 		std::string file;
 		std::string extension;
+		int quality;
+		int batchSize;
+		double flushInterval;
 		double duration;
 		std::string folder;
 		std::string host;
@@ -64,12 +72,23 @@ public:
 
 	static const char* contentType(const std::string& x_fileName);
 
+	/// A document to insert in the database, with its image
+	struct Document
+	{
+		std::unique_ptr<bson_t, void(*)(bson_t*)> doc{nullptr, bson_destroy};
+		std::string fileName; // name of the file in GridFS, empty if no image
+		std::string filePath; // path of the copy on disk, empty if no copy
+		std::vector<uchar> image;
+	};
+
 	explicit WriteObjectMongo(ParameterStructure& xr_params);
 	~WriteObjectMongo() override;
 	MKCLASS("WriteObjectMongo")
 	MKCATEG("Output")
 	MKDESCR("Outputs objects to MongoDB")
 
+	void PrintStatistics(mkconf& xr_result) const override;
+
 private:
 	const Parameters& m_param;
 	static log4cxx::LoggerPtr m_logger;
@@ -78,6 +97,10 @@ protected:
 	void ProcessFrame() override;
 	void Reset() override;
 	bool IsInputProcessed() const override;
+	void EncodeImages();
+	void WriteBatch(std::vector<Document>& xr_documents);
+	void DestroyQueue();
+	void SaveToGridFS(const std::string& x_name, const std::vector<uchar>& x_buffer);
 
 	// input
 	std::vector<Object> m_objects;
@@ -91,6 +114,8 @@ protected:
 	std::string m_dbCollection;
 	std::string m_jobId;
 	std::unique_ptr<MkDirectory> mp_outputDir;
+	std::vector<std::vector<uchar>> m_buffers;
+	std::unique_ptr<BatchQueue<Document>> mp_queue;
 };
 
 } // namespace mk
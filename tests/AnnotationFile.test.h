@@ -0,0 +1,93 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_ANNOTATION_FILE_H
+#define TEST_ANNOTATION_FILE_H
+
+#include <cxxtest/TestSuite.h>
+#include <memory>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include "Global.test.h"
+#include "AnnotationFileWriter.h"
+#include "AnnotationFileReader.h"
+#include "util.h"
+
+using namespace std;
+
+/// Test the writing and reading of annotation files, with compression
+class AnnotationFileTestSuite : public CxxTest::TestSuite
+{
+protected:
+	void writeAndRead(const string& x_compression)
+	{
+		const string fileName = "tests/tmp/test_annotation.srt" + mk::AnnotationFileWriter::CompressedExtension(x_compression);
+		boost::filesystem::remove(fileName);
+		{
+			mk::AnnotationFileWriter writer;
+			writer.Open(fileName, x_compression, 6);
+			for(int i = 0 ; i < 100 ; i++)
+			{
+				stringstream ss;
+				ss << "event_" << i;
+				writer.WriteAnnotation(i * 1000, i * 1000 + 500, ss);
+			}
+		}
+
+		unique_ptr<mk::AnnotationFileReader> reader(mk::createAnnotationFileReader(fileName, 0, 0));
+		string text;
+		for(int i = 0 ; i < 100 ; i++)
+		{
+			TS_ASSERT(reader->ReadNextAnnotation(text));
+			TS_ASSERT_EQUALS(text, "event_" + to_string(i) + " ");
+			TS_ASSERT_EQUALS(reader->GetCurrentTimeStamp(), static_cast<TIME_STAMP>(i * 1000));
+		}
+		TS_ASSERT(!reader->ReadNextAnnotation(text));
+	}
+
+public:
+	/// Round trip with and without compression
+	void testRoundTrip()
+	{
+		writeAndRead("none");
+		writeAndRead("gzip");
+		writeAndRead("bzip2");
+
+		// the file must really be compressed with gzip
+		ifstream ifs("tests/tmp/test_annotation.srt.gz", ios::binary);
+		unsigned char magic[2] = {0, 0};
+		ifs.read(reinterpret_cast<char*>(magic), 2);
+		TS_ASSERT_EQUALS(magic[0], 0x1f);
+		TS_ASSERT_EQUALS(magic[1], 0x8b);
+	}
+
+	/// An unknown compression does not leave a file behind
+	void testUnknownCompression()
+	{
+		const string fileName = "tests/tmp/test_annotation_unknown.srt";
+		boost::filesystem::remove(fileName);
+		mk::AnnotationFileWriter writer;
+		TS_ASSERT_THROWS(writer.Open(fileName, "zip"), mk::MkException);
+		TS_ASSERT(!boost::filesystem::exists(fileName));
+	}
+};
+#endif
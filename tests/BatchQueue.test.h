@@ -0,0 +1,139 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_BATCH_QUEUE_H
+#define TEST_BATCH_QUEUE_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include <future>
+#include <thread>
+#include "BatchQueue.h"
+#include "MkException.h"
+#include "util.h"
+
+using namespace std;
+
+/// Test the queue used to write documents to a database by batches. A blocking writer is used as stand-in for the database.
+class BatchQueueTestSuite : public CxxTest::TestSuite
+{
+protected:
+	/// Stand-in for a database: insertions wait until the database is opened
+	struct FakeDatabase
+	{
+		FakeDatabase() : open(gate.get_future()) {}
+		void Insert(vector<int>& xr_batch)
+		{
+			open.wait();
+			nbInserts++;
+			for(auto elem : xr_batch)
+				content.push_back(elem);
+		}
+		promise<void> gate;
+		shared_future<void> open;
+		int nbInserts = 0;
+		vector<int> content;
+	};
+
+public:
+	void testBatches()
+	{
+		TS_TRACE("Test that documents are inserted by batches without blocking the caller");
+		FakeDatabase db;
+		BatchQueue<int> queue(10, 60, 1000, [&db](vector<int>& xr_batch){db.Insert(xr_batch);});
+
+		// note: the database is blocked, pushing would never return if it was synchronous
+		for(int i = 0 ; i < 100 ; i++)
+			queue.Push(int(i));
+		TS_ASSERT_EQUALS(queue.GetNbWritten(), 0);
+		db.gate.set_value();
+		queue.Flush();
+
+		TS_ASSERT_EQUALS(db.content.size(), 100);
+		TS_ASSERT_EQUALS(queue.GetNbWritten(), 100);
+		TS_ASSERT_LESS_THAN_EQUALS(db.nbInserts, 10);
+		TS_ASSERT_EQUALS(db.nbInserts, queue.GetNbBatches());
+		for(int i = 0 ; i < 100 ; i++)
+			TS_ASSERT_EQUALS(db.content.at(i), i);
+	}
+
+	void testFlushInterval()
+	{
+		TS_TRACE("Test that an incomplete batch is inserted after the flush interval");
+		const double interval = 0.2;
+		promise<size_t> written;
+		BatchQueue<int> queue(10, interval, 1000, [&written](vector<int>& xr_batch){written.set_value(xr_batch.size());});
+
+		// note: the interval starts with the first push, not with the queue
+		this_thread::sleep_for(chrono::duration<double>(interval / 2));
+		auto start = chrono::steady_clock::now();
+		queue.Push(1);
+		queue.Push(2);
+
+		// note: without the interval the batch would only be written by Flush
+		future<size_t> batchSize = written.get_future();
+		TS_ASSERT_EQUALS(batchSize.wait_for(chrono::seconds(10)), future_status::ready);
+		const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		TS_ASSERT_EQUALS(batchSize.get(), 2);
+		TS_ASSERT_LESS_THAN_EQUALS(interval * 0.95, elapsed);
+		TS_ASSERT_LESS_THAN(elapsed, interval + 0.5);
+		queue.Flush();
+		TS_ASSERT_EQUALS(queue.GetNbWritten(), 2);
+		TS_ASSERT_EQUALS(queue.GetNbBatches(), 1);
+	}
+
+	void testException()
+	{
+		TS_TRACE("Test that the exceptions of the writer are rethrown");
+		BatchQueue<int> queue(1, 0, 10, [](vector<int>& xr_batch){throw MkException("Insertion failed", LOC);});
+		queue.Push(1);
+		TS_ASSERT_THROWS(queue.Flush(), MkException);
+		queue.Flush();
+	}
+
+	void testTryPush()
+	{
+		TS_TRACE("Test that items are refused when the queue is full");
+		promise<void> started;
+		promise<void> gate;
+		shared_future<void> open(gate.get_future());
+		BatchQueue<int> queue(1, 0, 2, [&started, open](vector<int>& xr_batch){
+			if(xr_batch.front() == 1)
+			{
+				started.set_value();
+				open.wait();
+			}
+		});
+		queue.Push(1);
+		started.get_future().wait();
+		TS_ASSERT(queue.TryPush(2));
+		TS_ASSERT(queue.TryPush(3));
+		TS_ASSERT(!queue.TryPush(4));
+		TS_ASSERT_EQUALS(queue.GetNbQueued(), 2);
+		gate.set_value();
+		queue.Flush();
+		TS_ASSERT_EQUALS(queue.GetNbWritten(), 3);
+		TS_ASSERT_EQUALS(queue.GetNbQueued(), 0);
+	}
+};
+
+#endif
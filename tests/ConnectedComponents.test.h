@@ -0,0 +1,136 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_CONNECTED_COMPONENTS_H
+#define TEST_CONNECTED_COMPONENTS_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include "ConnectedComponents.h"
+
+using namespace std;
+using namespace cv;
+
+/// Test the labeling of connected components by stripes, OpenCV is used as reference
+class ConnectedComponentsTestSuite : public CxxTest::TestSuite
+{
+protected:
+	void compareWithOpenCv(const Mat& x_binary, int x_nbStripes)
+	{
+		mk::ConnectedComponents components;
+		components.Label(x_binary, x_nbStripes, true);
+
+		Mat labels, stats, centroids;
+		int nb = connectedComponentsWithStats(x_binary, labels, stats, centroids, 8, CV_32S);
+
+		TS_ASSERT_EQUALS(static_cast<int>(components.GetBlobs().size()), nb - 1);
+		if(static_cast<int>(components.GetBlobs().size()) != nb - 1)
+			return;
+
+		// note: the order of blobs may differ from OpenCV: find the corresponding label of OpenCV for each blob
+		vector<int> correspondence(nb, -1);
+		const Mat& ourLabels(components.GetLabels());
+		for(int y = 0 ; y < labels.rows ; y++)
+		{
+			for(int x = 0 ; x < labels.cols ; x++)
+			{
+				int ours = ourLabels.at<int>(y, x);
+				TS_ASSERT_EQUALS(ours == 0, labels.at<int>(y, x) == 0);
+				if(ours == 0)
+					continue;
+				if(correspondence[ours] == -1)
+					correspondence[ours] = labels.at<int>(y, x);
+				TS_ASSERT_EQUALS(correspondence[ours], labels.at<int>(y, x));
+			}
+		}
+
+		for(int i = 0 ; i < nb - 1 ; i++)
+		{
+			const mk::Blob& blob(components.GetBlobs()[i]);
+			int j = correspondence[i + 1];
+			TS_ASSERT(j > 0);
+			if(j <= 0)
+				continue;
+			TS_ASSERT_EQUALS(blob.Area(), stats.at<int>(j, CC_STAT_AREA));
+			TS_ASSERT_EQUALS(blob.rect, Rect(stats.at<int>(j, CC_STAT_LEFT), stats.at<int>(j, CC_STAT_TOP),
+				stats.at<int>(j, CC_STAT_WIDTH), stats.at<int>(j, CC_STAT_HEIGHT)));
+			TS_ASSERT_DELTA(blob.Centroid().x, centroids.at<double>(j, 0), 1e-6);
+			TS_ASSERT_DELTA(blob.Centroid().y, centroids.at<double>(j, 1), 1e-6);
+
+			// moments of the pixels of the blob
+			Moments mom = moments(labels == j, true);
+			TS_ASSERT_DELTA(blob.Moments().mu20, mom.mu20, 1e-6 * max(1.0, mom.mu20));
+			TS_ASSERT_DELTA(blob.Moments().mu03, mom.mu03, 1e-6 * max(1.0, abs(mom.mu03)));
+		}
+	}
+
+public:
+	/// Random images with different numbers of stripes
+	void testRandom()
+	{
+		RNG rng(4323);
+		for(int i = 0 ; i < 20 ; i++)
+		{
+			Mat noise(rng.uniform(1, 100), rng.uniform(1, 100), CV_8UC1);
+			rng.fill(noise, RNG::UNIFORM, 0, 255);
+			Mat binary = noise > rng.uniform(50, 230);
+			compareWithOpenCv(binary, rng.uniform(1, 16));
+		}
+	}
+
+	/// Blobs that cross the borders of stripes (U shapes are merged late)
+	void testShapes()
+	{
+		Mat binary = Mat::zeros(64, 64, CV_8UC1);
+		rectangle(binary, Rect(5, 5, 3, 50), Scalar(255), -1);
+		rectangle(binary, Rect(20, 5, 3, 50), Scalar(255), -1);
+		rectangle(binary, Rect(5, 52, 18, 3), Scalar(255), -1);
+		circle(binary, Point(45, 30), 10, Scalar(255), -1);
+		line(binary, Point(30, 63), Point(63, 0), Scalar(255), 1, 8);
+		for(int nb = 1 ; nb < 10 ; nb++)
+			compareWithOpenCv(binary, nb);
+
+		mk::ConnectedComponents components;
+		components.Label(binary, 4);
+		vector<Point> contour;
+		components.GetContour(0, contour);
+		TS_ASSERT(!contour.empty());
+		TS_ASSERT_EQUALS(boundingRect(contour), components.GetBlobs()[0].rect);
+	}
+
+	/// A noisy mask has many small blobs, each present in a few stripes only. A large blob crosses all stripes
+	void testNoisyMask()
+	{
+		RNG rng(763);
+		Mat noise(120, 160, CV_8UC1);
+		rng.fill(noise, RNG::UNIFORM, 0, 255);
+		Mat binary = noise > 240;
+		rectangle(binary, Rect(70, 0, 4, 120), Scalar(255), -1);
+		for(int nb : {1, 16, 60, 120})
+			compareWithOpenCv(binary, nb);
+
+		mk::ConnectedComponents components;
+		components.Label(binary, 60);
+		TS_ASSERT_LESS_THAN(300, static_cast<int>(components.GetBlobs().size()));
+	}
+};
+#endif
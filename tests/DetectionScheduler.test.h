@@ -0,0 +1,167 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_DETECTION_SCHEDULER_H
+#define TEST_DETECTION_SCHEDULER_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include "DetectionScheduler.h"
+
+using namespace std;
+using namespace cv;
+
+/// Scheduler whose measured costs can be set by the test
+struct TestedScheduler : mk::DetectionScheduler
+{
+	void SetCosts(double x_detection, double x_tracking)
+	{
+		m_detectionCost = x_detection;
+		m_trackingCost  = x_tracking;
+	}
+};
+
+/// Test the scheduling of the detection and the tracking in between
+class DetectionSchedulerTestSuite : public CxxTest::TestSuite
+{
+public:
+	/// A textured frame, so that objects can be tracked by template matching
+	static Mat RandomFrame(int x_seed)
+	{
+		Mat frame(Size(320, 240), CV_8UC1);
+		RNG rng(x_seed);
+		rng.fill(frame, RNG::UNIFORM, 0, 256);
+		return frame;
+	}
+
+	/// Without activity and fps, the detection is run every n frames
+	void testFixedInterval()
+	{
+		mk::DetectionScheduler scheduler;
+		scheduler.Reset();
+		Mat frame = RandomFrame(1);
+		int nbCalls = 0;
+		auto detect = [&nbCalls](vector<Rect>& xr_detected){nbCalls++; xr_detected.push_back(Rect(100, 100, 40, 40));};
+		vector<Rect> detected;
+		for(int i = 0 ; i < 9 ; i++)
+		{
+			TS_ASSERT_EQUALS(scheduler.Process(frame, 3, 10, 0, 0, detect, detected), i % 3 == 0);
+			// in between, the static object is tracked at the same position
+			TS_ASSERT_EQUALS(static_cast<int>(detected.size()), 1);
+			TS_ASSERT_EQUALS(detected.at(0), Rect(100, 100, 40, 40));
+		}
+		TS_ASSERT_EQUALS(nbCalls, 3);
+		TS_ASSERT_EQUALS(scheduler.GetNbDetections(), 3u);
+		TS_ASSERT_EQUALS(scheduler.GetNbFrames(), 9u);
+	}
+
+	/// A change of the scene on the thumbnail triggers the detection before the end of the interval
+	void testActivity()
+	{
+		mk::DetectionScheduler scheduler;
+		scheduler.Reset();
+		Mat frame = RandomFrame(2);
+		vector<Rect> detected;
+		auto detect = [](vector<Rect>&){};
+		TS_ASSERT(scheduler.Process(frame, 100, 100, 0.1, 0, detect, detected));
+		TS_ASSERT(!scheduler.Process(frame, 100, 100, 0.1, 0, detect, detected));
+
+		// a small change is below the threshold
+		Mat changed = frame.clone();
+		changed(Rect(0, 0, 10, 10)).setTo(255);
+		TS_ASSERT(!scheduler.Process(changed, 100, 100, 0.1, 0, detect, detected));
+
+		// a quarter of the image changes
+		changed(Rect(0, 0, 160, 120)).setTo(255);
+		TS_ASSERT(scheduler.Process(changed, 100, 100, 0.1, 0, detect, detected));
+		TS_ASSERT(!scheduler.Process(changed, 100, 100, 0.1, 0, detect, detected));
+
+		// without threshold, the activity is ignored
+		TS_ASSERT(!scheduler.Process(frame, 100, 100, 0, 0, detect, detected));
+	}
+
+	/// The interval grows so that the average cost of a frame stays below 1 / fps
+	void testAdaptiveInterval()
+	{
+		TestedScheduler scheduler;
+		scheduler.Reset();
+		Mat frame = RandomFrame(3);
+
+		// no target fps: the configured interval is kept
+		scheduler.SetCosts(1, 0.125);
+		scheduler.IsDetectionNeeded(frame, 2, 20, 0, 0);
+		TS_ASSERT_EQUALS(scheduler.GetInterval(), 2);
+
+		// the detection is faster than 1 / fps
+		scheduler.SetCosts(0.125, 0.0625);
+		scheduler.IsDetectionNeeded(frame, 2, 20, 0, 4);
+		TS_ASSERT_EQUALS(scheduler.GetInterval(), 2);
+
+		// (1 + 6 * 0.125) / 7 = 0.25 s per frame
+		scheduler.SetCosts(1, 0.125);
+		scheduler.IsDetectionNeeded(frame, 2, 20, 0, 4);
+		TS_ASSERT_EQUALS(scheduler.GetInterval(), 7);
+
+		// limited by the maximal interval
+		scheduler.IsDetectionNeeded(frame, 2, 5, 0, 4);
+		TS_ASSERT_EQUALS(scheduler.GetInterval(), 5);
+
+		// the tracking alone is slower than 1 / fps
+		scheduler.SetCosts(1, 0.5);
+		scheduler.IsDetectionNeeded(frame, 2, 20, 0, 4);
+		TS_ASSERT_EQUALS(scheduler.GetInterval(), 20);
+	}
+
+	/// Objects follow the motion of the image and are dropped when they are not found
+	void testTrack()
+	{
+		mk::DetectionScheduler scheduler;
+		scheduler.Reset();
+		Mat frame = RandomFrame(4);
+		vector<Rect> detected;
+		auto detect = [](vector<Rect>& xr_detected){
+			xr_detected.push_back(Rect(100, 100, 40, 40));
+			xr_detected.push_back(Rect(200, 50, 30, 30));
+		};
+		TS_ASSERT(scheduler.Process(frame, 5, 5, 0, 0, detect, detected));
+
+		// the image moves by (5, 3)
+		Mat moved(frame.size(), frame.type(), Scalar(0));
+		frame(Rect(0, 0, frame.cols - 5, frame.rows - 3)).copyTo(moved(Rect(5, 3, frame.cols - 5, frame.rows - 3)));
+		TS_ASSERT(!scheduler.Process(moved, 5, 5, 0, 0, detect, detected));
+		TS_ASSERT_EQUALS(static_cast<int>(detected.size()), 2);
+		TS_ASSERT_EQUALS(detected.at(0), Rect(105, 103, 40, 40));
+		TS_ASSERT_EQUALS(detected.at(1), Rect(205, 53, 30, 30));
+
+		// the first object is hidden by noise: its score is below 0.5 and it is dropped
+		Mat noise = RandomFrame(5);
+		noise(Rect(90, 90, 70, 70)).copyTo(moved(Rect(90, 90, 70, 70)));
+		TS_ASSERT(!scheduler.Process(moved, 5, 5, 0, 0, detect, detected));
+		TS_ASSERT_EQUALS(static_cast<int>(detected.size()), 1);
+		TS_ASSERT_EQUALS(detected.at(0), Rect(205, 53, 30, 30));
+
+		// the whole scene changes: all objects are lost
+		TS_ASSERT(!scheduler.Process(noise, 5, 5, 0, 0, detect, detected));
+		TS_ASSERT(detected.empty());
+	}
+};
+#endif
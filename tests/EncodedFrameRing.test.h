@@ -0,0 +1,205 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_ENCODED_FRAME_RING_H
+#define TEST_ENCODED_FRAME_RING_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include "EncodedFrameRing.h"
+#include "MjpegAviWriter.h"
+#include <opencv2/highgui/highgui.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+using namespace std;
+using namespace cv;
+
+/// Test the ring of encoded frames used as pre-roll by VideoFileBufferWriter and the writing of MJPEG videos
+class EncodedFrameRingTestSuite : public CxxTest::TestSuite
+{
+public:
+	/// Push a frame whose bytes are all equal to its time stamp
+	static void PushFrame(mk::EncodedFrameRing& xr_ring, size_t x_size, TIME_STAMP x_timeStamp)
+	{
+		xr_ring.Push(vector<uchar>(x_size, static_cast<uchar>(x_timeStamp)), x_timeStamp);
+	}
+
+	/// Check the time stamps of the frames in the ring, from oldest to newest, and their content
+	static void CheckFrames(const mk::EncodedFrameRing& x_ring, const vector<TIME_STAMP>& x_timeStamps)
+	{
+		TS_ASSERT_EQUALS(x_ring.Size(), x_timeStamps.size());
+		size_t used = 0;
+		for(size_t i = 0 ; i < min(x_ring.Size(), x_timeStamps.size()) ; i++)
+		{
+			const mk::EncodedFrameRing::Frame& frame(x_ring.At(i));
+			TS_ASSERT_EQUALS(frame.timeStamp, x_timeStamps[i]);
+			TS_ASSERT(frame.offset + frame.size <= x_ring.GetCapacity());
+			const uchar* data = x_ring.Data(frame);
+			TS_ASSERT(all_of(data, data + frame.size, [&frame](uchar x_byte){return x_byte == static_cast<uchar>(frame.timeStamp);}));
+			used += frame.size;
+		}
+		TS_ASSERT_EQUALS(x_ring.GetUsedBytes(), used);
+	}
+
+	/// The oldest frames are dropped when the maximal number of frames is reached
+	void testMaxFrames()
+	{
+		mk::EncodedFrameRing ring;
+		ring.Reset(1000, 3);
+		for(TIME_STAMP ts = 1 ; ts <= 5 ; ts++)
+			PushFrame(ring, 10 * ts, ts);
+		CheckFrames(ring, {3, 4, 5});
+
+		ring.Clear();
+		TS_ASSERT(ring.Empty());
+		TS_ASSERT_EQUALS(ring.GetUsedBytes(), 0u);
+	}
+
+	/// Frames of mixed sizes wrap around the end of the slab and overwrite the oldest ones
+	void testWrapAround()
+	{
+		mk::EncodedFrameRing ring;
+		ring.Reset(100, 10);
+		PushFrame(ring, 30, 1);
+		PushFrame(ring, 30, 2);
+		PushFrame(ring, 30, 3);
+		CheckFrames(ring, {1, 2, 3});
+		TS_ASSERT_EQUALS(ring.At(2).offset, 60u);
+
+		// does not fit at the end: written at the start of the slab, over frame 1
+		PushFrame(ring, 20, 4);
+		CheckFrames(ring, {2, 3, 4});
+		TS_ASSERT_EQUALS(ring.At(2).offset, 0u);
+
+		// fits after frame 4, over frames 2 and 3
+		PushFrame(ring, 50, 5);
+		CheckFrames(ring, {4, 5});
+		TS_ASSERT_EQUALS(ring.At(1).offset, 20u);
+
+		// small frames fill the end of the slab
+		PushFrame(ring, 10, 6);
+		PushFrame(ring, 10, 7);
+		PushFrame(ring, 10, 8);
+		CheckFrames(ring, {4, 5, 6, 7, 8});
+
+		// wraps again over frames 4 and 5, the frames at the end of the slab are kept
+		PushFrame(ring, 25, 9);
+		CheckFrames(ring, {6, 7, 8, 9});
+		TS_ASSERT_EQUALS(ring.At(3).offset, 0u);
+	}
+
+	/// A frame larger than the slab clears the ring
+	void testLargeFrame()
+	{
+		mk::EncodedFrameRing ring;
+		ring.Reset(100, 10);
+		PushFrame(ring, 30, 1);
+		PushFrame(ring, 150, 2);
+		CheckFrames(ring, {2});
+		TS_ASSERT_EQUALS(ring.GetCapacity(), 300u);
+	}
+
+	/// A synthetic scene, with smooth areas, edges and sensor noise
+	static Mat SceneFrame(const Size& x_size, int x_index)
+	{
+		Mat frame(x_size, CV_8UC3);
+		for(int y = 0 ; y < frame.rows ; y++)
+			frame.row(y).setTo(Scalar(50 + 150 * y / frame.rows, 100, 200 - 100 * y / frame.rows));
+		rectangle(frame, Rect(x_size.width / 4 + 4 * x_index, x_size.height / 3, x_size.width / 8, x_size.height / 3), Scalar(30, 30, 30), -1);
+		circle(frame, Point(x_size.width * 3 / 4, x_size.height / 4), x_size.height / 8, Scalar(255, 255, 255), -1);
+		Mat noise(x_size, CV_16SC3);
+		RNG rng(x_index);
+		rng.fill(noise, RNG::NORMAL, 0, 1.5);
+		add(frame, noise, frame, noArray(), CV_8U);
+		return frame;
+	}
+
+	/// The pre-roll of encoded frames takes more than 10 times less memory than raw frames
+	void testMemory()
+	{
+		const Size size(640, 480);
+		const size_t nbFrames = 30;
+		const size_t rawBytes = nbFrames * size.area() * 3;
+		mk::EncodedFrameRing ring;
+		// note: same estimate of the size of JPEG frames as VideoFileBufferWriter
+		ring.Reset(rawBytes / 12, nbFrames);
+		vector<uchar> encoded;
+		for(size_t i = 0 ; i < 2 * nbFrames ; i++)
+		{
+			TS_ASSERT(imencode(".jpg", SceneFrame(size, i), encoded, {IMWRITE_JPEG_QUALITY, 90}));
+			ring.Push(encoded, i);
+		}
+		// all frames fit in the slab
+		TS_ASSERT_EQUALS(ring.Size(), nbFrames);
+		TS_ASSERT_EQUALS(ring.At(0).timeStamp, nbFrames);
+		TS_ASSERT_LESS_THAN(10 * ring.GetUsedBytes(), rawBytes);
+		TS_ASSERT_LESS_THAN(10 * ring.GetCapacity(), rawBytes);
+		TS_TRACE("Pre-roll of " + to_string(nbFrames) + " frames: " + to_string(ring.GetUsedBytes() / 1024) + " kB encoded, "
+			+ to_string(rawBytes / 1024) + " kB raw");
+	}
+
+	/// A video written from encoded and raw frames can be read by OpenCV
+	void testAviReadBack()
+	{
+		const string file = "tests/tmp/test_mjpeg.avi";
+		const Size size(160, 120);
+		const int nbFrames = 10;
+		{
+			mk::MjpegAviWriter writer;
+			writer.Open(file, 10, size);
+			TS_ASSERT(writer.IsOpened());
+			vector<uchar> encoded;
+			for(int i = 0 ; i < nbFrames ; i++)
+			{
+				Mat frame(size, CV_8UC3, Scalar(20 * i, 128, 255 - 20 * i));
+				if(i % 2 == 0)
+				{
+					TS_ASSERT(imencode(".jpg", frame, encoded, {IMWRITE_JPEG_QUALITY, 90}));
+					writer.WriteEncoded(encoded);
+				}
+				else writer.Write(frame, 90);
+			}
+			TS_ASSERT_EQUALS(writer.GetFrameCount(), static_cast<size_t>(nbFrames));
+			writer.Close();
+			TS_ASSERT(!writer.IsOpened());
+		}
+
+		VideoCapture capture(file);
+		TS_ASSERT(capture.isOpened());
+		TS_ASSERT_EQUALS(static_cast<int>(capture.get(CV_CAP_PROP_FRAME_COUNT)), nbFrames);
+		TS_ASSERT_EQUALS(static_cast<int>(capture.get(CV_CAP_PROP_FRAME_WIDTH)), size.width);
+		TS_ASSERT_EQUALS(static_cast<int>(capture.get(CV_CAP_PROP_FRAME_HEIGHT)), size.height);
+		Mat frame;
+		int nbRead = 0;
+		while(capture.read(frame))
+		{
+			TS_ASSERT_EQUALS(frame.size(), size);
+			// note: JPEG is lossy, the color of each frame is approximately kept
+			Scalar color = mean(frame);
+			TS_ASSERT_DELTA(color[0], 20 * nbRead, 4);
+			TS_ASSERT_DELTA(color[2], 255 - 20 * nbRead, 4);
+			nbRead++;
+		}
+		TS_ASSERT_EQUALS(nbRead, nbFrames);
+	}
+};
+#endif
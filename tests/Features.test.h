@@ -109,5 +109,20 @@ public:
 			delete(feat);
 		}
 	}
+
+	/// The Hamming distance of binary descriptors must be the one of OpenCV
+	void testHammingDistance()
+	{
+		cv::RNG rng(3456);
+		for(int size : {1, 7, 8, 32, 61, 64})
+		{
+			cv::Mat desc1(1, size, CV_8UC1);
+			cv::Mat desc2(1, size, CV_8UC1);
+			rng.fill(desc1, cv::RNG::UNIFORM, 0, 256);
+			rng.fill(desc2, cv::RNG::UNIFORM, 0, 256);
+			TS_ASSERT_EQUALS(hammingDistance(desc1.data, desc2.data, size), static_cast<int>(cv::norm(desc1, desc2, cv::NORM_HAMMING)));
+			TS_ASSERT_EQUALS(hammingDistance(desc1.data, desc1.data, size), 0);
+		}
+	}
 };
 #endif
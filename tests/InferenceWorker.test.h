@@ -0,0 +1,179 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_INFERENCE_WORKER_H
+#define TEST_INFERENCE_WORKER_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include <fstream>
+#include <thread>
+#include <future>
+#include <chrono>
+#include "DnnDetector/InferenceWorker.h"
+
+using namespace std;
+
+/// Worker whose routing of the output can be called directly
+struct TestedWorker : mk::InferenceWorker
+{
+	using mk::InferenceWorker::InferenceWorker;
+	using mk::InferenceWorker::SplitOutput;
+};
+
+/// Test the shared inference worker with a tiny network generated on the fly (no weights): a global average pooling
+class InferenceWorkerTestSuite : public CxxTest::TestSuite
+{
+protected:
+	static mk::InferenceWorker::Settings CreateTinyNetwork()
+	{
+		const string file = "tests/tmp/tiny.prototxt";
+		ofstream of(file);
+		of << "name: \"tiny\"\n"
+		   << "input: \"data\"\n"
+		   << "input_shape { dim: 1 dim: 3 dim: 8 dim: 8 }\n"
+		   << "layer { name: \"pool\" type: \"Pooling\" bottom: \"data\" top: \"pool\" pooling_param { pool: AVE global_pooling: true } }\n";
+		of.close();
+		return mk::InferenceWorker::Settings{file, "", cv::Size(8, 8), 1, 0, false, 4, 1};
+	}
+
+public:
+	/// Images of two modules are processed by batches and each output is routed back to its image
+	void testRouting()
+	{
+		mk::InferenceWorker::Settings settings = CreateTinyNetwork();
+		shared_ptr<mk::InferenceWorker> worker = mk::InferenceWorker::Get(settings);
+		TS_ASSERT_EQUALS(worker, mk::InferenceWorker::Get(settings));
+
+		// note: each module pushes all its images before waiting for the outputs (e.g. all regions of a frame)
+		// note: the outputs are collected by the threads and checked in the main thread
+		const int nbRequests = 20;
+		const int offsets[2] = {0, 100};
+		vector<cv::Mat> outputs[2];
+		exception_ptr errors[2];
+		auto module = [&worker, &offsets, &outputs, &errors](int x_module){
+			try
+			{
+				vector<future<cv::Mat>> results;
+				for(int i = 0 ; i < nbRequests ; i++)
+				{
+					const int value = offsets[x_module] + i;
+					results.push_back(worker->Push(cv::Mat(16, 16, CV_8UC3, cv::Scalar(value, value + 1, value + 2))));
+				}
+				for(auto& elem : results)
+					outputs[x_module].push_back(elem.get());
+			}
+			catch(...)
+			{
+				errors[x_module] = current_exception();
+			}
+		};
+		thread module1(module, 0);
+		thread module2(module, 1);
+		module1.join();
+		module2.join();
+
+		for(int m = 0 ; m < 2 ; m++)
+		{
+			TS_ASSERT(errors[m] == nullptr);
+			TS_ASSERT_EQUALS(static_cast<int>(outputs[m].size()), nbRequests);
+			for(size_t i = 0 ; i < outputs[m].size() ; i++)
+			{
+				TS_ASSERT_EQUALS(static_cast<int>(outputs[m][i].total()), 3);
+				for(int c = 0 ; c < 3 ; c++)
+					TS_ASSERT_DELTA(outputs[m][i].at<float>(c), offsets[m] + i + c, 1e-3);
+			}
+		}
+
+		// a batch is run when it is full, the maximal latency only elapses for the last one
+		TS_ASSERT_EQUALS(worker->GetNbImages(), 2 * nbRequests);
+		TS_ASSERT_LESS_THAN(worker->GetNbBatches(), 2 * nbRequests);
+		TS_ASSERT_LESS_THAN_EQUALS(worker->GetNbBatches(), 2 * nbRequests / settings.maxBatchSize + 1);
+	}
+
+	/// A module that is alone to use the network submits its images without waiting for the maximal latency
+	void testSubmit()
+	{
+		mk::InferenceWorker::Settings settings = CreateTinyNetwork();
+		shared_ptr<mk::InferenceWorker> worker = mk::InferenceWorker::Get(settings);
+		auto start = chrono::steady_clock::now();
+		vector<future<cv::Mat>> results;
+		for(int i = 0 ; i < 3 ; i++)
+			results.push_back(worker->Push(cv::Mat(16, 16, CV_8UC3, cv::Scalar(i, i, i))));
+		worker->Submit();
+		for(auto& elem : results)
+			elem.get();
+		const double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		TS_ASSERT_LESS_THAN(elapsed, settings.maxLatency / 2);
+
+		// nothing is queued anymore
+		TS_ASSERT_THROWS_NOTHING(worker->Submit());
+	}
+
+	/// The rows of a detection output are routed to their image with the index of the first column
+	void testSplitDetections()
+	{
+		TestedWorker worker(CreateTinyNetwork());
+		const int size[4] = {1, 1, 6, 7};
+		cv::Mat output(4, size, CV_32F, cv::Scalar(0));
+		cv::Mat rows(6, 7, CV_32F, output.ptr());
+		const float indices[6] = {0, 2, 1, 0, 3, -1};
+		for(int i = 0 ; i < 6 ; i++)
+		{
+			rows.at<float>(i, 0) = indices[i];
+			rows.at<float>(i, 2) = 0.1f * i; // confidence, to identify the row
+		}
+
+		// note: rows of images that are not in the batch are ignored
+		vector<cv::Mat> results(3);
+		worker.SplitOutput(output, results);
+		TS_ASSERT_EQUALS(results[0].rows, 2);
+		TS_ASSERT_EQUALS(results[1].rows, 1);
+		TS_ASSERT_EQUALS(results[2].rows, 1);
+		for(const auto& elem : results)
+			TS_ASSERT_EQUALS(elem.cols, 7);
+		TS_ASSERT_DELTA(results[0].at<float>(0, 2), 0.0, 1e-6);
+		TS_ASSERT_DELTA(results[0].at<float>(1, 2), 0.3, 1e-6);
+		TS_ASSERT_DELTA(results[1].at<float>(0, 2), 0.2, 1e-6);
+		TS_ASSERT_DELTA(results[2].at<float>(0, 2), 0.1, 1e-6);
+
+		// an image without detection has no row
+		results.assign(5, cv::Mat());
+		worker.SplitOutput(output, results);
+		TS_ASSERT_EQUALS(results[4].rows, 0);
+		TS_ASSERT_EQUALS(results[4].cols, 7);
+
+		// an output that is neither a detection nor one output per image
+		cv::Mat other(2, 3, CV_32F, cv::Scalar(0));
+		results.assign(3, cv::Mat());
+		TS_ASSERT_THROWS_ANYTHING(worker.SplitOutput(other, results));
+	}
+
+	/// A missing network is reported to the module
+	void testMissingNetwork()
+	{
+		mk::InferenceWorker::Settings settings = CreateTinyNetwork();
+		settings.modelFile = "tests/tmp/missing.prototxt";
+		TS_ASSERT_THROWS_ANYTHING(mk::InferenceWorker::Get(settings));
+	}
+};
+#endif
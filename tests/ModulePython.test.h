@@ -0,0 +1,146 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_MODULE_PYTHON_H
+#define TEST_MODULE_PYTHON_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include "ModulePython.h"
+#include "FeatureVector.h"
+#include "Object.h"
+
+using namespace std;
+using namespace boost::python;
+
+/// Give access to the conversions of ModulePython, no module is created
+struct PythonConversions : public mk::ModulePython
+{
+	using mk::ModulePython::InitPython;
+	using mk::ModulePython::ScopedGil;
+	using mk::ModulePython::MatToPython;
+	using mk::ModulePython::FeaturesToMatrix;
+};
+
+/// Test the conversions of data given to Python scripts
+class ModulePythonTestSuite : public CxxTest::TestSuite
+{
+protected:
+	/// Convert a matrix to a numpy array, the GIL must be held
+	static object ToNumpy(const cv::Mat& x_mat)
+	{
+		return object(handle<>(PythonConversions::MatToPython::convert(x_mat)));
+	}
+
+	static bool HasNumpy()
+	{
+		try
+		{
+			import("numpy");
+			return true;
+		}
+		catch(error_already_set&)
+		{
+			PyErr_Clear();
+			return false;
+		}
+	}
+
+public:
+	/// The features of all objects are copied in one matrix, one row per object
+	void testFeaturesToMatrix()
+	{
+		vector<mk::Object> objects;
+		for(int i = 0 ; i < 3 ; i++)
+		{
+			mk::Object obj("test");
+			obj.AddFeature("a", new mk::FeatureFloat(i));
+			obj.AddFeature("v", new mk::FeatureVectorFloat(vector<float>{10.f * i, 10.f * i + 1}));
+			obj.AddFeature("b", new mk::FeatureFloat(-i));
+			objects.push_back(obj);
+		}
+		cv::Mat matrix;
+		PythonConversions::FeaturesToMatrix(objects, {"v", "a", "b"}, matrix);
+		TS_ASSERT_EQUALS(matrix.rows, 3);
+		TS_ASSERT_EQUALS(matrix.cols, 4);
+		TS_ASSERT_EQUALS(matrix.type(), CV_32F);
+		for(int i = 0 ; i < 3 ; i++)
+		{
+			TS_ASSERT_EQUALS(matrix.at<float>(i, 0), 10 * i);
+			TS_ASSERT_EQUALS(matrix.at<float>(i, 1), 10 * i + 1);
+			TS_ASSERT_EQUALS(matrix.at<float>(i, 2), i);
+			TS_ASSERT_EQUALS(matrix.at<float>(i, 3), -i);
+		}
+
+		// no objects: empty matrix
+		PythonConversions::FeaturesToMatrix(vector<mk::Object>(), {"a"}, matrix);
+		TS_ASSERT(matrix.empty());
+
+		// all objects must have features of the same type and size
+		objects[2].AddFeature("v", new mk::FeatureVectorFloat(vector<float>{1}));
+		TS_ASSERT_THROWS(PythonConversions::FeaturesToMatrix(objects, {"v"}, matrix), mk::MkException);
+		objects[2].AddFeature("a", new mk::FeatureVectorFloat(vector<float>{1}));
+		TS_ASSERT_THROWS(PythonConversions::FeaturesToMatrix(objects, {"a"}, matrix), mk::MkException);
+		TS_ASSERT_THROWS(PythonConversions::FeaturesToMatrix(objects, {"missing"}, matrix), mk::FeatureNotFoundException);
+	}
+
+	/// Matrices are given as numpy views: shape, type and strides of the matrix, without copy
+	void testNumpyView()
+	{
+		PythonConversions::InitPython();
+		PythonConversions::ScopedGil gil;
+		if(!HasNumpy())
+			TS_SKIP("numpy is not available");
+
+		// a submatrix with 3 channels
+		cv::Mat image(6, 8, CV_16UC3);
+		cv::randu(image, 0, 1000);
+		cv::Mat roi = image(cv::Rect(1, 2, 4, 3));
+		object array = ToNumpy(roi);
+		TS_ASSERT_EQUALS(extract<int>(array.attr("ndim"))(), 3);
+		TS_ASSERT_EQUALS(extract<int>(array.attr("shape")[0])(), 3);
+		TS_ASSERT_EQUALS(extract<int>(array.attr("shape")[1])(), 4);
+		TS_ASSERT_EQUALS(extract<int>(array.attr("shape")[2])(), 3);
+		TS_ASSERT_EQUALS(extract<string>(array.attr("dtype").attr("name"))(), "uint16");
+		for(int y = 0 ; y < roi.rows ; y++)
+			for(int x = 0 ; x < roi.cols ; x++)
+				for(int c = 0 ; c < 3 ; c++)
+					TS_ASSERT_EQUALS(extract<int>(array.attr("item")(y, x, c))(), roi.at<cv::Vec3w>(y, x)[c]);
+
+		// the array shares the data of the matrix
+		TS_ASSERT(!extract<bool>(array.attr("flags")["OWNDATA"])());
+		array[boost::python::make_tuple(2, 3, 1)] = 1234;
+		TS_ASSERT_EQUALS(roi.at<cv::Vec3w>(2, 3)[1], 1234);
+		roi.at<cv::Vec3w>(0, 0)[0] = 4321;
+		TS_ASSERT_EQUALS(extract<int>(array.attr("item")(0, 0, 0))(), 4321);
+
+		// the features of objects: one row per object
+		cv::Mat features(5, 7, CV_32F, cv::Scalar(0.5));
+		array = ToNumpy(features);
+		TS_ASSERT_EQUALS(extract<int>(array.attr("ndim"))(), 2);
+		TS_ASSERT_EQUALS(extract<int>(array.attr("shape")[0])(), 5);
+		TS_ASSERT_EQUALS(extract<int>(array.attr("shape")[1])(), 7);
+		TS_ASSERT_EQUALS(extract<string>(array.attr("dtype").attr("name"))(), "float32");
+		TS_ASSERT_EQUALS(extract<double>(array.attr("sum")().attr("item")())(), 5 * 7 * 0.5);
+	}
+};
+#endif
@@ -26,6 +26,7 @@
 #include <cxxtest/TestSuite.h>
 #include <string>
 #include <tuple>
+#include <thread>
 #include <iostream>
 #include "Module.h"
 #include "Controller.h"
@@ -36,11 +37,14 @@
 #include "StreamImage.h"
 #include "StreamState.h"
 #include "StreamNum.h"
+#include "StreamPyramid.h"
 #include "MkException.h"
 #include "FeatureFloatInTime.h"
 #include "FeatureVector.h"
+#include "FeatureOpenCv.h"
 #include "Timer.h"
 #include "Manager.h"
+#include <mongoc.h>
 
 using namespace std;
 
@@ -117,6 +121,7 @@ protected:
 	uint   m_uint    = 0;
 	bool   m_bool    = false;
 	vector<Object> m_objects;
+	Pyramid m_pyramid;
 	int m_cpt = 0;
 
 public:
@@ -211,6 +216,8 @@ public:
 			// outputStream = new StreamNum<uint>("test", m_uint, *mp_fakeInput, "Test input");
 			else if(elem.second->GetClass() == "StreamNum<bool>")
 				outputStream = new StreamNum<bool>("test", m_bool, *mp_fakeInput, "Test input");
+			else if(elem.second->GetClass() == "StreamPyramid")
+				outputStream = new StreamPyramid("test", m_pyramid, *mp_fakeInput, "Test input");
 			else
 			{
 				TSM_ASSERT("Unknown input stream type", false);
@@ -450,6 +457,220 @@ public:
 	}
 
 
+	/// Write a video in segments: a new file is created after each segment duration
+	void testVideoSegments()
+	{
+		unsigned int seed = 324234566;
+		for(bool asynchronous : {false, true})
+		{
+			TS_TRACE("## asynchronous=" + to_string(asynchronous));
+			ModuleTester tester;
+			map<string, mkjson> params = {{"width", 64}, {"height", 48}, {"segmentDuration", 0.1}, {"asynchronous", asynchronous}};
+			CreateAndConnectModule(tester, "VideoFileWriter", &params);
+			auto countFiles = [this]()
+			{
+				int nb = 0;
+				boost::filesystem::directory_iterator end;
+				for(boost::filesystem::directory_iterator it(mp_context->RefOutputDir().GetPath()) ; it != end ; ++it)
+					nb += it->path().filename().string().compare(0, 7, "output.") == 0;
+				return nb;
+			};
+			const int nbFiles = countFiles();
+
+			// note: time stamps increase by 1 to 2 ms for each frame
+			for(int i = 0 ; i < 400 ; i++)
+				tester.module->ProcessRandomInput(seed);
+			TS_ASSERT_LESS_THAN(400, tester.module->GetCurrentTimeStamp());
+
+			// note: this waits for the encoding thread
+			mkconf stats;
+			tester.module->PrintStatistics(stats);
+			TS_ASSERT_LESS_THAN_EQUALS(nbFiles + 3, countFiles());
+			mp_context->RefOutputDir().CleanDir();
+		}
+	}
+
+	/// Write objects to MongoDB by batches and check that all documents are inserted. Skipped without a server
+	void testWriteObjectMongo()
+	{
+		const string host = "mongodb://localhost:27017/?serverSelectionTimeoutMS=1000";
+		const string collectionName = "unitTest_" + timeStamp();
+		mongoc_init();
+		mongoc_client_t* client = mongoc_client_new(host.c_str());
+		bson_t* ping = BCON_NEW("ping", BCON_INT32(1));
+		bson_error_t error;
+		bool available = mongoc_client_command_simple(client, "admin", ping, nullptr, nullptr, &error);
+		bson_destroy(ping);
+		if(!available)
+		{
+			mongoc_client_destroy(client);
+			mongoc_cleanup();
+			TS_SKIP("No MongoDB server: " + string(error.message));
+		}
+
+		unsigned int seed = 324234566;
+		size_t nbObjects = 0;
+		{
+			ModuleTester tester;
+			map<string, mkjson> params = {{"host", host}, {"collection", collectionName}, {"batchSize", 7}, {"flushInterval", 60}};
+			CreateAndConnectModule(tester, "WriteObjectMongo", &params);
+			tester.module->LockAndReset();
+			const StreamObject& stream(dynamic_cast<const StreamObject&>(tester.module->RefInputStreamByName("objects")));
+			for(int i = 0 ; i < 20 ; i++)
+			{
+				tester.module->ProcessRandomInput(seed);
+				nbObjects += stream.GetContent().size();
+			}
+			// note: this writes the pending documents
+			tester.module->LockAndReset();
+			mp_context->RefOutputDir().CleanDir();
+		}
+
+		mongoc_collection_t* collection = mongoc_client_get_collection(client, "test", collectionName.c_str());
+		bson_t* query = bson_new();
+		int64_t count = mongoc_collection_count(collection, MONGOC_QUERY_NONE, query, 0, 0, nullptr, &error);
+		bson_destroy(query);
+		TS_ASSERT_EQUALS(count, static_cast<int64_t>(nbObjects));
+		mongoc_collection_drop(collection, &error);
+		mongoc_collection_destroy(collection);
+		mongoc_client_destroy(client);
+		mongoc_cleanup();
+	}
+
+	/// Match the keypoints of two objects with the ones of the previous frame: the matches refer to the parent objects
+	void testDescriptorMatcher()
+	{
+		ModuleTester tester;
+		map<string, mkjson> params = {{"historyFrames", 1}, {"rebuildInterval", 1}};
+		CreateAndConnectModule(tester, "DescriptorMatcher", &params);
+		TS_ASSERT_EQUALS(tester.outputStreams.size(), 1);
+
+		// keypoints of two objects, with random descriptors
+		unsigned int seed = 324234566;
+		vector<Object> keypoints;
+		for(int parent : {3, 7})
+		{
+			for(int i = 0 ; i < 5 ; i++)
+			{
+				BinaryDescriptor desc;
+				desc.bytes.resize(32);
+				for(auto& elem : desc.bytes)
+					elem = rand_r(&seed) % 256;
+				Object obj("keypoint");
+				obj.AddFeature("descriptor", new FeatureBinaryDescriptor(desc));
+				obj.AddFeature("parent", new FeatureInt(parent));
+				keypoints.push_back(obj);
+			}
+		}
+
+		// note: the module is processed as a depending module of the fake input
+		Module::DependingModules modules;
+		modules.AddDependingModule(*tester.module);
+		const vector<Object>& matched(dynamic_cast<const StreamObject&>(tester.module->GetOutputStreamByName("matched")).GetContent());
+		for(int frame = 1 ; frame <= 2 ; frame++)
+		{
+			m_objects = keypoints;
+			tester.outputStreams.front()->SetTimeStamp(frame * 40);
+			modules.Process();
+			TS_ASSERT_EQUALS(tester.module->GetLastTimeStamp(), frame * 40);
+		}
+
+		// all keypoints are found in the previous frame
+		TS_ASSERT_EQUALS(matched.size(), keypoints.size());
+		for(size_t i = 0 ; i < matched.size() ; i++)
+		{
+			TS_ASSERT_EQUALS(dynamic_cast<const FeatureInt&>(matched[i].GetFeature("matchId")).value,
+				dynamic_cast<const FeatureInt&>(keypoints[i].GetFeature("parent")).value);
+			TS_ASSERT_EQUALS(dynamic_cast<const FeatureFloat&>(matched[i].GetFeature("matchDistance")).value, 0);
+		}
+	}
+
+	/// Python with numpy is needed by the module PythonScript
+	static bool HasNumpy()
+	{
+		return system("python -c 'import numpy' > /dev/null 2>&1") == 0;
+	}
+
+	/// Process frames until the module raises an event
+	bool ProcessUntilEvent(ModuleTester& xr_tester, const Event& x_event, TIME_STAMP x_firstTimeStamp)
+	{
+		Module::DependingModules modules;
+		modules.AddDependingModule(*xr_tester.module);
+		for(int frame = 0 ; frame < 100 ; frame++)
+		{
+			for(auto& elem : xr_tester.outputStreams)
+				elem->SetTimeStamp(x_firstTimeStamp + frame * 40);
+			modules.Process();
+			if(x_event.IsRaised())
+				return true;
+			this_thread::sleep_for(chrono::milliseconds(20));
+		}
+		return false;
+	}
+
+	/// With worker processes, the result of a frame is given with an event that has the timestamp of its frame
+	void testPythonScriptWorkers()
+	{
+		if(!HasNumpy())
+			TS_SKIP("python with numpy is not available");
+		ModuleTester tester;
+		map<string, mkjson> params = {{"nbProcesses", 1}, {"eventName", "mean"}};
+		CreateAndConnectModule(tester, "PythonScript", &params);
+		tester.module->LockAndReset();
+		const Event& event(dynamic_cast<const StreamEvent&>(tester.module->GetOutputStreamByName("event")).GetContent());
+
+		m_image.setTo(10);
+		m_objects = {Object("a"), Object("b")};
+		TS_ASSERT(ProcessUntilEvent(tester, event, 40));
+		TS_ASSERT_EQUALS(event.GetEventName(), "mean");
+		TS_ASSERT_EQUALS(event.GetTimeEvent(), 40u);
+		TS_ASSERT_LESS_THAN_EQUALS(event.GetTimeEvent(), event.GetTimeNotif());
+		TS_ASSERT_DELTA(event.GetExternalInfo()["result"]["mean"].get<double>(), 10, 1e-6);
+		TS_ASSERT_EQUALS(event.GetExternalInfo()["result"]["nbObjects"].get<int>(), 2);
+
+		// the requests pending at the reset are discarded: the next event is the one of a frame after the reset
+		m_image.setTo(20);
+		Module::DependingModules modules;
+		modules.AddDependingModule(*tester.module);
+		for(auto& elem : tester.outputStreams)
+			elem->SetTimeStamp(10000);
+		modules.Process();
+		tester.module->LockAndReset();
+		m_image.setTo(30);
+		TS_ASSERT(ProcessUntilEvent(tester, event, 20000));
+		TS_ASSERT_EQUALS(event.GetTimeEvent(), 20000u);
+		TS_ASSERT_DELTA(event.GetExternalInfo()["result"]["mean"].get<double>(), 30, 1e-6);
+	}
+
+	/// In markus, each module runs its script in its own namespace: the functions of two scripts have the same name
+	void testPythonScriptNamespaces()
+	{
+		if(!HasNumpy())
+			TS_SKIP("python with numpy is not available");
+		ModuleTester testers[2];
+		const Event* events[2];
+		for(int i = 0 ; i < 2 ; i++)
+		{
+			const string script = "tests/tmp/script" + to_string(i) + ".py";
+			ofstream of(script);
+			of << "def process(image, objects):
+"
+			   << "    return " << i << "
+";
+			of.close();
+			map<string, mkjson> params = {{"scriptPath", "tests/tmp"}, {"script", script}};
+			CreateAndConnectModule(testers[i], "PythonScript", &params);
+			testers[i].module->LockAndReset();
+			events[i] = &dynamic_cast<const StreamEvent&>(testers[i].module->GetOutputStreamByName("event")).GetContent();
+		}
+		for(int i = 0 ; i < 2 ; i++)
+		{
+			TS_ASSERT(ProcessUntilEvent(testers[i], *events[i], 40));
+			TS_ASSERT_EQUALS(events[i]->GetTimeEvent(), 40u);
+			TS_ASSERT_EQUALS(events[i]->GetExternalInfo()["result"].get<int>(), i);
+		}
+	}
+
 	// Test by searching the XML files that were created specially to unit test one modules (ModuleX.test.json)
 	/// Test export
 	void testExport(const Module& xr_module)
@@ -28,6 +28,8 @@
 #include "util.h"
 #include "MkException.h"
 #include "Manager.h"
+#include "StreamImage.h"
+#include <opencv2/imgproc/imgproc.hpp>
 
 using namespace std;
 
@@ -95,7 +97,130 @@ protected:
 		}
 	}
 
+	/// Run a config and return the images of output streams (module name and output name), for each frame
+	vector<vector<cv::Mat>> runAndGetImages(const string& x_configFile, bool x_fuseModules, const vector<pair<string, string>>& x_outputs)
+	{
+		mkconf appConfig;
+		readFromFile(appConfig, x_configFile);
+		Manager::Parameters params(appConfig);
+		params.autoProcess = false;
+		params.fuseModules = x_fuseModules;
+		Context::Parameters contextParams(appConfig["name"].get<string>());
+		contextParams.configFile      = x_configFile;
+		contextParams.outputDir       = "";
+		contextParams.applicationName = "TestProjects";
+		contextParams.centralized = true;
+		contextParams.autoClean   = true;
+		Context context(contextParams);
+
+		Manager manager(params, context);
+		manager.Connect();
+		manager.LockAndReset();
+
+		vector<const StreamImage*> streams;
+		for(const auto& output : x_outputs)
+		{
+			for(auto& module : manager.RefModules())
+			{
+				if(module->GetName() != output.first)
+					continue;
+				TS_ASSERT_EQUALS(module->IsFused(), x_fuseModules);
+				streams.push_back(&dynamic_cast<const StreamImage&>(module->GetOutputStreamByName(output.second)));
+			}
+		}
+		TS_ASSERT_EQUALS(streams.size(), x_outputs.size());
+
+		vector<vector<cv::Mat>> images;
+		for(int i = 0 ; i < 20 ; i++)
+		{
+			TS_ASSERT(manager.ProcessAndCatch());
+			images.emplace_back();
+			for(const auto& elem : streams)
+				images.back().push_back(elem->GetImage().clone());
+		}
+		return images;
+	}
+
 public:
+	/// The background of BgrSubRunAvg in fixed point must stay within 0.5 / (256 * alpha) levels of the floating point
+	/// background, computed here as in the former implementation (accumulateWeighted)
+	void testRunningAverageFixedPoint()
+	{
+		TS_TRACE("\n# Unit test of BgrSubRunAvg in fixed point");
+		const string configFile = "tests/projects/fusion_test.json";
+		for(const string type : {"CV_32FC3", "CV_8UC3"})
+		{
+			for(double alpha : {0.02, 0.1, 0.5})
+			{
+				TS_TRACE("## type " + type + ", alpha " + to_string(alpha));
+				mkconf appConfig;
+				readFromFile(appConfig, configFile);
+				mkconf& inputs(replaceOrAppendInArray(appConfig["modules"], "name", "BgrSubRunAvg")["inputs"]);
+				replaceOrAppendInArray(inputs, "name", "backgroundAlpha")["value"] = alpha;
+				replaceOrAppendInArray(inputs, "name", "fixedPoint")["value"]      = true;
+				replaceOrAppendInArray(inputs, "name", "type")["value"]            = type;
+
+				Manager::Parameters params(appConfig);
+				params.autoProcess = false;
+				Context::Parameters contextParams(appConfig["name"].get<string>());
+				contextParams.configFile      = configFile;
+				contextParams.outputDir       = "";
+				contextParams.applicationName = "TestProjects";
+				contextParams.centralized = true;
+				contextParams.autoClean   = true;
+				Context context(contextParams);
+				Manager manager(params, context);
+				manager.Connect();
+				manager.LockAndReset();
+
+				Module* module = nullptr;
+				for(auto& elem : manager.RefModules())
+					if(elem->GetName() == "BgrSubRunAvg")
+						module = elem;
+				TS_ASSERT(module != nullptr);
+				if(module == nullptr)
+					return;
+				const cv::Mat& input(dynamic_cast<const StreamImage&>(module->GetInputStreamByName("image")).GetImage());
+				const cv::Mat& background(dynamic_cast<const StreamImage&>(module->GetOutputStreamByName("background")).GetImage());
+
+				// note: images of floats are in [0, 1], 8 bit backgrounds are also rounded to an integer
+				const bool isFloat = input.depth() == CV_32F;
+				const double tolerance = isFloat ? 0.5 / (256 * alpha) / 255 : 0.5 / (256 * alpha) + 1;
+				cv::Mat accumulator, expected;
+				for(int i = 0 ; i < 30 ; i++)
+				{
+					TS_ASSERT(manager.ProcessAndCatch());
+					if(accumulator.empty())
+						input.convertTo(accumulator, CV_32F);
+					cv::accumulateWeighted(input, accumulator, alpha);
+					accumulator.convertTo(expected, input.depth());
+					TS_ASSERT_LESS_THAN_EQUALS(cv::norm(background, expected, cv::NORM_INF), tolerance);
+				}
+			}
+		}
+	}
+
+	/// Process a chain of fused modules: the result must be the same as without fusion
+	void testFusion()
+	{
+		TS_TRACE("\n# Unit test with fused modules");
+		// note: the outputs of all modules of the chain are compared, including the intermediate ones
+		const vector<pair<string, string>> outputs = {
+			{"BgrSubRunAvg", "foreground"}, {"BgrSubRunAvg", "background"}, {"Morph", "output"}, {"Mask", "masked"}
+		};
+		vector<vector<cv::Mat>> images1 = runAndGetImages("tests/projects/fusion_test.json", false, outputs);
+		vector<vector<cv::Mat>> images2 = runAndGetImages("tests/projects/fusion_test.json", true, outputs);
+		TS_ASSERT_EQUALS(images1.size(), 20);
+		TS_ASSERT_EQUALS(images1.size(), images2.size());
+		for(size_t i = 0 ; i < images1.size() && i < images2.size() ; i++)
+		{
+			TS_ASSERT_EQUALS(images1[i].size(), outputs.size());
+			TS_ASSERT_EQUALS(images1[i].size(), images2[i].size());
+			for(size_t j = 0 ; j < images1[i].size() && j < images2[i].size() ; j++)
+				TSM_ASSERT_EQUALS((outputs[j].first + "." + outputs[j].second).c_str(), cv::norm(images1[i][j], images2[i][j], cv::NORM_INF), 0);
+		}
+	}
+
 	/// Run different existing configs
 	void testProjects1()
 	{
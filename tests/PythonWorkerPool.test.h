@@ -0,0 +1,127 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_PYTHON_WORKER_POOL_H
+#define TEST_PYTHON_WORKER_POOL_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include <fstream>
+#include <algorithm>
+#include <cstdlib>
+#include "PythonWorkerPool.h"
+
+using namespace std;
+
+/// Test the pool of Python processes with a script generated by the test
+class PythonWorkerPoolTestSuite : public CxxTest::TestSuite
+{
+protected:
+	static void CreateScript(const string& x_file)
+	{
+		ofstream of(x_file);
+		of << "import os, time\n"
+		   << "def process(image, objects):\n"
+		   << "    if objects == 'crash':\n"
+		   << "        os._exit(1)\n"
+		   << "    if objects == 'hang':\n"
+		   << "        time.sleep(3600)\n"
+		   << "    return {'sum': int(image.sum()), 'nb': len(objects)}\n";
+	}
+
+	/// The workers need python with numpy
+	static bool HasNumpy()
+	{
+		return system("python -c 'import numpy' > /dev/null 2>&1") == 0;
+	}
+
+	/// Wait for a number of results
+	static void WaitResults(mk::PythonWorkerPool& xr_pool, size_t x_nb, vector<mk::PythonWorkerPool::Result>& xr_results)
+	{
+		vector<mk::PythonWorkerPool::Result> results;
+		while(xr_results.size() < x_nb)
+		{
+			xr_pool.Collect(results, -1);
+			xr_results.insert(xr_results.end(), results.begin(), results.end());
+		}
+	}
+
+public:
+	/// Results are returned with the timestamp of their image, a crash of the script does not stop the pool
+	void testWorkers()
+	{
+		if(!HasNumpy())
+			TS_SKIP("python with numpy is not available");
+		CreateScript("tests/tmp/worker.py");
+		mk::PythonWorkerPool pool(2, cv::Size(8, 4), CV_8UC3, "python", "tests/tmp", "tests/tmp/worker.py", "process");
+		TS_ASSERT_EQUALS(pool.GetNbWorkers(), 2);
+
+		for(int i = 0 ; i < 6 ; i++)
+			pool.Submit(100 + i, cv::Mat(4, 8, CV_8UC3, cv::Scalar::all(i)), mk::mkjson::array({1, 2}));
+		vector<mk::PythonWorkerPool::Result> results;
+		WaitResults(pool, 6, results);
+		sort(results.begin(), results.end(), [](const mk::PythonWorkerPool::Result& x_1, const mk::PythonWorkerPool::Result& x_2){return x_1.timestamp < x_2.timestamp;});
+		for(int i = 0 ; i < 6 ; i++)
+		{
+			TS_ASSERT_EQUALS(results[i].timestamp, 100 + i);
+			TS_ASSERT(results[i].error.empty());
+			TS_ASSERT_EQUALS(results[i].value["sum"].get<int>(), 4 * 8 * 3 * i);
+			TS_ASSERT_EQUALS(results[i].value["nb"].get<int>(), 2);
+		}
+
+		// crash of a worker
+		results.clear();
+		pool.Submit(200, cv::Mat(4, 8, CV_8UC3, cv::Scalar::all(1)), "crash");
+		WaitResults(pool, 1, results);
+		TS_ASSERT_EQUALS(results[0].timestamp, 200);
+		TS_ASSERT(!results[0].error.empty());
+		TS_ASSERT_EQUALS(pool.GetNbRestarts(), 1);
+
+		results.clear();
+		pool.Submit(300, cv::Mat(4, 8, CV_8UC3, cv::Scalar::all(1)), mk::mkjson::array());
+		WaitResults(pool, 1, results);
+		TS_ASSERT(results[0].error.empty());
+		TS_ASSERT_EQUALS(results[0].value["sum"].get<int>(), 4 * 8 * 3);
+	}
+
+	/// A worker that exceeds the timeout is restarted, its request is returned with an error
+	void testTimeout()
+	{
+		if(!HasNumpy())
+			TS_SKIP("python with numpy is not available");
+		CreateScript("tests/tmp/worker.py");
+		mk::PythonWorkerPool pool(1, cv::Size(8, 4), CV_8UC1, "python", "tests/tmp", "tests/tmp/worker.py", "process", 0.5);
+
+		vector<mk::PythonWorkerPool::Result> results;
+		pool.Submit(100, cv::Mat(4, 8, CV_8UC1, cv::Scalar::all(1)), "hang");
+		// note: the only worker is busy, this waits until it is restarted
+		pool.Submit(200, cv::Mat(4, 8, CV_8UC1, cv::Scalar::all(1)), mk::mkjson::array());
+		TS_ASSERT_EQUALS(pool.GetNbRestarts(), 1);
+		WaitResults(pool, 2, results);
+		TS_ASSERT_EQUALS(results[0].timestamp, 100);
+		TS_ASSERT(!results[0].error.empty());
+		TS_ASSERT_EQUALS(results[1].timestamp, 200);
+		TS_ASSERT(results[1].error.empty());
+		TS_ASSERT_EQUALS(results[1].value["sum"].get<int>(), 4 * 8);
+	}
+};
+#endif
@@ -0,0 +1,118 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_REGIONS_OF_INTEREST_H
+#define TEST_REGIONS_OF_INTEREST_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include "RegionsOfInterest.h"
+
+using namespace std;
+using namespace cv;
+
+/// Test the selection of the regions scanned by detectors
+class RegionsOfInterestTestSuite : public CxxTest::TestSuite
+{
+public:
+	/// Overlapping regions are merged until no region overlaps another one
+	void testMergeOverlapping()
+	{
+		// note: the third region bridges the two first ones
+		vector<Rect> regions = {Rect(10, 10, 20, 20), Rect(50, 10, 20, 20), Rect(25, 12, 30, 5), Rect(150, 70, 10, 10)};
+		mk::mergeRegions(regions, 0, Size(1, 1), Size(200, 100));
+		TS_ASSERT_EQUALS(static_cast<int>(regions.size()), 2);
+		TS_ASSERT_EQUALS(regions.at(0), Rect(10, 10, 60, 20));
+		TS_ASSERT_EQUALS(regions.at(1), Rect(150, 70, 10, 10));
+		TS_ASSERT_EQUALS(mk::regionsArea(regions), 60 * 20 + 10 * 10);
+	}
+
+	/// Regions dilated by the margin outside of the image are moved inside of it
+	void testMarginAtBorder()
+	{
+		vector<Rect> regions = {Rect(2, 3, 10, 10), Rect(90, 92, 8, 6)};
+		mk::mergeRegions(regions, 5, Size(1, 1), Size(100, 100));
+		TS_ASSERT_EQUALS(static_cast<int>(regions.size()), 2);
+		TS_ASSERT_EQUALS(regions.at(0), Rect(0, 0, 20, 20));
+		TS_ASSERT_EQUALS(regions.at(1), Rect(82, 84, 18, 16));
+		for(const auto& elem : regions)
+			TS_ASSERT_EQUALS(elem & Rect(0, 0, 100, 100), elem);
+	}
+
+	/// A region smaller than the window of the detector is enlarged around its center
+	void testSmallRegion()
+	{
+		vector<Rect> regions = {Rect(50, 40, 4, 4)};
+		mk::mergeRegions(regions, 0, Size(24, 48), Size(200, 100));
+		TS_ASSERT_EQUALS(static_cast<int>(regions.size()), 1);
+		TS_ASSERT_EQUALS(regions.at(0), Rect(40, 18, 24, 48));
+
+		// the window is higher than the image
+		regions = {Rect(50, 40, 4, 4)};
+		mk::mergeRegions(regions, 0, Size(64, 128), Size(200, 100));
+		TS_ASSERT_EQUALS(static_cast<int>(regions.size()), 1);
+		TS_ASSERT_EQUALS(regions.at(0), Rect(20, 0, 64, 100));
+	}
+
+	/// Above the maximal ratio of the image, the whole image is scanned
+	void testFullFrameFallback()
+	{
+		vector<Rect> regions = {Rect(0, 0, 60, 60)};
+		mk::selectRegions(regions, 0, Size(1, 1), Size(100, 100), 0.5);
+		TS_ASSERT_EQUALS(static_cast<int>(regions.size()), 1);
+		TS_ASSERT_EQUALS(regions.at(0), Rect(0, 0, 60, 60));
+
+		mk::selectRegions(regions, 0, Size(1, 1), Size(100, 100), 0.3);
+		TS_ASSERT_EQUALS(static_cast<int>(regions.size()), 1);
+		TS_ASSERT_EQUALS(regions.at(0), Rect(0, 0, 100, 100));
+	}
+
+	/// Regions of the mask and objects inputs, and the scanned part of the images
+	void testSelect()
+	{
+		const Size size(100, 100);
+		mk::RegionsOfInterest roi;
+		roi.Reset();
+
+		// no input: the whole image is scanned
+		roi.Select(nullptr, nullptr, 1, 0, Size(1, 1), size, 0.5);
+		TS_ASSERT_EQUALS(static_cast<int>(roi.GetRegions().size()), 1);
+		TS_ASSERT_EQUALS(roi.GetRegions().at(0), Rect(Point(0, 0), size));
+
+		Mat mask(size, CV_8UC1, Scalar(0));
+		mask(Rect(60, 60, 10, 10)).setTo(255);
+		vector<mk::Object> objects = {mk::Object("object", Rect(10, 10, 20, 20))};
+		roi.Select(&mask, &objects, 2, 0, Size(1, 1), size, 0.5);
+		TS_ASSERT_EQUALS(static_cast<int>(roi.GetRegions().size()), 2);
+		TS_ASSERT_EQUALS(mk::regionsArea(roi.GetRegions()), 20 * 20 + 10 * 10);
+
+		// a frame without detection
+		roi.Skip(size);
+		TS_ASSERT(roi.GetRegions().empty());
+		TS_ASSERT_DELTA(roi.GetScannedRatio(), (100 * 100 + 20 * 20 + 10 * 10) / (3.0 * 100 * 100), 1e-9);
+
+		mk::mkconf result;
+		roi.PrintStatistics("test", result);
+		TS_ASSERT_DELTA(result["module"]["test"]["scannedRatio"].get<double>(), roi.GetScannedRatio(), 1e-9);
+	}
+};
+#endif
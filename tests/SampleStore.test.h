@@ -0,0 +1,114 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_SAMPLE_STORE_H
+#define TEST_SAMPLE_STORE_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include "SampleStore.h"
+#include "BatchPredictor.h"
+
+using namespace std;
+using namespace cv;
+
+/// Test the storage of samples by chunks and the batched prediction
+class SampleStoreTestSuite : public CxxTest::TestSuite
+{
+protected:
+	/// Samples of two classes, separated by a line
+	void createSamples(int x_nb, Mat& xr_samples, Mat& xr_responses)
+	{
+		RNG rng(3421);
+		xr_samples.create(x_nb, 3, CV_32F);
+		rng.fill(xr_samples, RNG::UNIFORM, -1, 1);
+		xr_responses.create(x_nb, 1, CV_32S);
+		for(int i = 0 ; i < x_nb ; i++)
+			xr_responses.at<int>(i) = xr_samples.at<float>(i, 0) + 0.5 * xr_samples.at<float>(i, 1) > 0.1;
+	}
+
+public:
+	/// Append samples by batches of different sizes, part of the chunks are written to a file
+	void testSpill()
+	{
+		Mat samples, responses;
+		createSamples(1000, samples, responses);
+		mk::SampleStore store;
+		store.Reset(3, 64, 2, "tests/tmp/test_samples.bin");
+		for(int i = 0 ; i < samples.rows ; )
+		{
+			int nb = min(1 + i % 37, samples.rows - i);
+			store.Append(samples.rowRange(i, i + nb), responses.rowRange(i, i + nb));
+			i += nb;
+		}
+		TS_ASSERT_EQUALS(store.GetNbRows(), 1000U);
+
+		Mat loaded, loadedResp;
+		store.Load(loaded, loadedResp, 0);
+		TS_ASSERT_EQUALS(norm(loaded, samples, NORM_INF), 0);
+		TS_ASSERT_EQUALS(norm(loadedResp, responses, NORM_INF), 0);
+
+		// sub-sampling: one sample out of 4
+		store.Load(loaded, loadedResp, 250);
+		TS_ASSERT_EQUALS(loaded.rows, 250);
+		TS_ASSERT_EQUALS(norm(loaded.row(10), samples.row(40), NORM_INF), 0);
+		TS_ASSERT_EQUALS(loadedResp.at<int>(249), responses.at<int>(996));
+	}
+
+	/// The prediction of a linear SVM as a product gives the same results as OpenCV
+	void testLinearSvm()
+	{
+		Mat samples, responses;
+		createSamples(300, samples, responses);
+		Ptr<ml::SVM> svm = ml::SVM::create();
+		svm->setKernel(ml::SVM::LINEAR);
+		svm->setC(10);
+		svm->train(ml::TrainData::create(samples, ml::ROW_SAMPLE, responses));
+
+		mk::BatchPredictor predictor;
+		predictor.SetModel(svm);
+		TS_ASSERT(predictor.IsLinear());
+
+		// one sample is not enough to verify the fast path
+		Mat results, expected;
+		predictor.Predict(samples.row(0), results);
+		TS_ASSERT(predictor.IsLinear());
+		TS_ASSERT(!predictor.IsVerified());
+
+		predictor.Predict(samples, results);
+		TS_ASSERT(predictor.IsLinear());
+		TS_ASSERT(predictor.IsVerified());
+		svm->predict(samples, expected);
+		TS_ASSERT_EQUALS(norm(results, expected, NORM_INF), 0);
+
+		// a classifier of three classes has three decision functions: no fast path
+		for(int i = 0 ; i < responses.rows ; i++)
+			responses.at<int>(i) += samples.at<float>(i, 2) > 0.5;
+		svm->train(ml::TrainData::create(samples, ml::ROW_SAMPLE, responses));
+		predictor.SetModel(svm);
+		TS_ASSERT(!predictor.IsLinear());
+		predictor.Predict(samples, results);
+		svm->predict(samples, expected);
+		TS_ASSERT_EQUALS(norm(results, expected, NORM_INF), 0);
+	}
+};
+#endif
@@ -336,6 +336,12 @@ public:
 		testSerialization(fpt3f, "FeaturePoint3f");
 	}
 
+	void testFeatureBinaryDescriptor()
+	{
+		FeatureBinaryDescriptor fbd;
+		testSerialization(fbd, "FeatureBinaryDescriptor");
+	}
+
 	void testFeatures()
 	{
 		vector<string> listFeatures;
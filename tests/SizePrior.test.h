@@ -0,0 +1,110 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+#ifndef TEST_SIZE_PRIOR_H
+#define TEST_SIZE_PRIOR_H
+
+#include <cxxtest/TestSuite.h>
+#include "Global.test.h"
+#include "SizePrior.h"
+#include <climits>
+
+using namespace std;
+using namespace cv;
+
+/// Test the prior on the size of objects in function of their row
+class SizePriorTestSuite : public CxxTest::TestSuite
+{
+public:
+	/// Without samples, regions are scanned at all sizes
+	void testNoPrior()
+	{
+		mk::SizePrior prior;
+		prior.Reset(Size(100, 80), 4, 10, 1.5);
+		vector<mk::ScanArea> areas;
+		prior.Split(Rect(10, 10, 50, 50), 5, areas);
+		TS_ASSERT_EQUALS(static_cast<int>(areas.size()), 1);
+		TS_ASSERT_EQUALS(areas[0].roi, Rect(10, 10, 50, 50));
+		TS_ASSERT_EQUALS(areas[0].rows, Range(10, 60));
+		TS_ASSERT_EQUALS(areas[0].minSize, 5);
+		TS_ASSERT_EQUALS(areas[0].maxSize, INT_MAX);
+	}
+
+	/// Objects grow with their row: learn the sizes and write them as a calibration
+	void testLearn()
+	{
+		mk::SizePrior prior;
+		prior.Reset(Size(100, 80), 4, 10, 1.5);
+		for(int i = 0 ; i < 20 ; i++)
+		{
+			prior.Add(Rect(i, 5, 10, 10));
+			prior.Add(Rect(i, 55, 20, 20));
+		}
+		vector<mk::ScanArea> areas;
+		// bands 1 and 2 are unknown: the image is scanned at all sizes in one area
+		prior.Split(Rect(0, 0, 100, 80), 0, areas);
+		TS_ASSERT_EQUALS(static_cast<int>(areas.size()), 1);
+		TS_ASSERT_EQUALS(areas[0].roi, Rect(0, 0, 100, 80));
+		TS_ASSERT_EQUALS(areas[0].rows, Range(0, 80));
+		TS_ASSERT_EQUALS(areas[0].maxSize, INT_MAX);
+
+		// a region that only crosses band 0 is restricted
+		prior.Split(Rect(0, 0, 100, 20), 0, areas);
+		TS_ASSERT_EQUALS(static_cast<int>(areas.size()), 1);
+		TS_ASSERT_EQUALS(areas[0].rows, Range(0, 20));
+		TS_ASSERT(areas[0].minSize <= 10 && areas[0].maxSize >= 10 && areas[0].maxSize < 20);
+
+		// the learned prior is read as a calibration
+		mk::mkjson json = prior;
+		TS_ASSERT_EQUALS(static_cast<int>(json["rows"].size()), 2);
+		mk::SizePrior calibrated;
+		calibrated.Reset(Size(100, 80), 4, 0, 1.5);
+		from_json(json, calibrated);
+		TS_ASSERT(calibrated.IsCalibrated());
+		double minSize = 0, maxSize = 0;
+		TS_ASSERT(calibrated.GetRange(0, minSize, maxSize));
+		TS_ASSERT_DELTA(minSize, 10 / 1.5, 1e-6);
+		TS_ASSERT_DELTA(maxSize, 10 * 1.5, 1e-6);
+		// interpolated between the two rows
+		TS_ASSERT(calibrated.GetRange(1, minSize, maxSize));
+		TS_ASSERT_DELTA(maxSize, (10 + 10.0 / 3) * 1.5, 1e-6);
+
+		// all bands are known
+		for(int i = 0 ; i < 20 ; i++)
+		{
+			prior.Add(Rect(i, 25, 14, 14));
+			prior.Add(Rect(i, 42, 16, 16));
+		}
+		prior.Split(Rect(0, 0, 100, 80), 0, areas);
+		TS_ASSERT_EQUALS(static_cast<int>(areas.size()), 4);
+		TS_ASSERT_EQUALS(areas[0].rows, Range(0, 20));
+		TS_ASSERT_EQUALS(areas[1].rows, Range(20, 40));
+		TS_ASSERT(areas[1].minSize <= 14 && areas[1].maxSize >= 14 && areas[1].maxSize < INT_MAX);
+		TS_ASSERT_EQUALS(areas[2].rows, Range(40, 60));
+		TS_ASSERT_EQUALS(areas[3].rows, Range(60, 80));
+		TS_ASSERT(areas[3].minSize > 10 && areas[3].minSize <= 20 && areas[3].maxSize >= 20);
+		// note: objects centered on the band can exceed it by half their size
+		TS_ASSERT_EQUALS(areas[0].roi.y, 0);
+		TS_ASSERT(areas[0].roi.height < 80);
+	}
+};
+#endif
@@ -26,6 +26,9 @@
 #include "StreamState.h"
 #include "StreamDebug.h"
 #include "util.h"
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
 
 namespace mk {
 using namespace std;
@@ -85,8 +88,7 @@ AnnotationFileReader::AnnotationFileReader()
 
 AnnotationFileReader::~AnnotationFileReader()
 {
-	if(m_srtFile.is_open())
-		m_srtFile.close();
+	m_srtFile.reset();
 }
 
 TIME_STAMP AnnotationFileReader::GetCurrentTimeStamp()
@@ -108,14 +110,21 @@ void AnnotationFileReader::Open(const string& x_file)
 
 	LOG_DEBUG(m_logger, "Open annotation file: "<<x_file);
 
-	if(m_srtFile.is_open())
-		m_srtFile.close();
-	m_srtFile.open(x_file.c_str(), ifstream::in);
+	m_srtFile.reset();
+	boost::iostreams::file_source file(x_file, ios_base::in | ios_base::binary);
 
-	if(! m_srtFile.is_open())
+	if(! file.is_open())
 	{
 		throw MkException("Error : AnnotationFileReader cannot open file : " + x_file, LOC);
 	}
+
+	// Decompress on the fly if needed
+	string ext = x_file.substr(x_file.find_last_of(".") + 1);
+	if(ext == "gz")
+		m_srtFile.push(boost::iostreams::gzip_decompressor());
+	else if(ext == "bz2")
+		m_srtFile.push(boost::iostreams::bzip2_decompressor());
+	m_srtFile.push(file);
 }
 
 string AnnotationFileReader::ReadAnnotationForTimeStamp(TIME_STAMP x_current)
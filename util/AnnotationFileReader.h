@@ -26,13 +26,14 @@
 
 #include <log4cxx/logger.h>
 #include <fstream>
+#include <boost/iostreams/filtering_stream.hpp>
 #include "define.h"
 #include "Module.h"
 
 
 namespace mk {
 /**
-* @brief Read an annotation file
+* @brief Read an annotation file. Files compressed with gzip (.gz) or bzip2 (.bz2) are decompressed on the fly
 */
 class AnnotationFileReader
 {
@@ -56,7 +57,7 @@ private:
 protected:
 	int m_num;
 	std::string m_text;
-	std::ifstream m_srtFile;
+	boost::iostreams::filtering_istream m_srtFile;
 	std::string m_srtStart;
 	std::string m_srtEnd;
 };
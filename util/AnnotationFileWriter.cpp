@@ -26,6 +26,9 @@
 #include "StreamState.h"
 #include "StreamDebug.h"
 #include "util.h"
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
 
 namespace mk {
 using namespace std;
@@ -41,40 +44,122 @@ AnnotationFileWriter::AnnotationFileWriter()
 
 AnnotationFileWriter::~AnnotationFileWriter()
 {
-	if(m_file.is_open())
-		m_file.close();
+	Close();
 }
 
-void AnnotationFileWriter::Open(const string& x_file)
+/**
+* @brief Open the file for writing
+*
+* @param x_file        Name of the file with path
+* @param x_compression Compression: none, gzip or bzip2
+* @param x_level       Compression level in [1-9], -1 for default
+*/
+void AnnotationFileWriter::Open(const string& x_file, const string& x_compression, int x_level)
 {
 	// m_srtStart = msToTimeStamp(0);
 	// m_srtEnd   = msToTimeStamp(0);
 	m_subId    = 0;
 
-	LOG_DEBUG(m_logger, "Open annotation file: "<<x_file);
+	LOG_DEBUG(m_logger, "Open annotation file: "<<x_file<<" with compression "<<x_compression);
+
+	Close();
 
-	if(m_file.is_open())
-		m_file.close();
-	m_file.open(x_file.c_str(), ios_base::app);
+	// note: the compression is checked before the file is created
+	if(x_compression != "none" && x_compression != "gzip" && x_compression != "bzip2")
+		throw MkException("Unknown compression " + x_compression + " for file " + x_file, LOC);
 
-	if(! m_file.is_open())
+	// note: a compressed file cannot be appended to
+	boost::iostreams::file_sink file(x_file, x_compression == "none" ? ios_base::app : ios_base::out | ios_base::binary);
+	if(! file.is_open())
 	{
 		throw MkException("Error : AnnotationFileWriter cannot open file : " + x_file, LOC);
 	}
+	if(x_compression == "gzip")
+		m_file.push(boost::iostreams::gzip_compressor(x_level < 0 ? boost::iostreams::gzip::default_compression : x_level));
+	else if(x_compression == "bzip2")
+		m_file.push(boost::iostreams::bzip2_compressor(x_level < 0 ? boost::iostreams::bzip2::default_block_size : x_level));
+	m_file.push(file);
+
+	m_stop   = false;
+	m_thread = thread(&AnnotationFileWriter::Work, this);
+}
+
+/**
+* @brief Write all pending annotations and close the file
+*/
+void AnnotationFileWriter::Close()
+{
+	if(!m_thread.joinable())
+		return;
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_condition.notify_one();
+	m_thread.join();
+
+	// note: this flushes the compressor and closes the file
+	m_file.reset();
 }
 
+/**
+* @brief Loop of the writing thread
+*/
+void AnnotationFileWriter::Work()
+{
+	deque<string> queue;
+	while(true)
+	{
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_condition.wait(lock, [this]{return m_stop || !m_queue.empty();});
+			if(m_queue.empty())
+				return;
+			queue.swap(m_queue);
+		}
+		for(const auto& elem : queue)
+			m_file << elem;
+		queue.clear();
+		if(!m_file.good())
+			LOG_ERROR(m_logger, "Error while writing annotation file");
+	}
+}
 
 /// Write the subtitle in log file
 void AnnotationFileWriter::WriteAnnotation(TIME_STAMP x_start, TIME_STAMP x_end, stringstream& x_in)
 {
+	if(!m_thread.joinable())
+		throw MkException("Error : AnnotationFileWriter must be opened before writing", LOC);
 	string startTime = msToTimeStamp(x_start);
 	string endTime   = msToTimeStamp(x_end);
 	LOG_DEBUG(m_logger, "Write annotation to file");
 
-	m_file<<m_subId<<endl;
-	m_file<<startTime<<" --> "<<endTime<<endl;
-	m_file<<x_in.str()<<endl;
-	m_file<<endl;
+	stringstream ss;
+	ss<<m_subId<<endl;
+	ss<<startTime<<" --> "<<endTime<<endl;
+	ss<<x_in.str()<<endl;
+	ss<<endl;
 	m_subId++;
+
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_queue.push_back(ss.str());
+	}
+	m_condition.notify_one();
+}
+
+/**
+* @brief Return the extension to add to a file name for a given compression
+*
+* @param x_compression Compression: none, gzip or bzip2
+* @return Extension
+*/
+string AnnotationFileWriter::CompressedExtension(const string& x_compression)
+{
+	if(x_compression == "gzip")
+		return ".gz";
+	if(x_compression == "bzip2")
+		return ".bz2";
+	return "";
 }
 } // namespace mk
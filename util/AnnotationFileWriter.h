@@ -26,12 +26,18 @@
 
 #include <log4cxx/logger.h>
 #include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <boost/iostreams/filtering_stream.hpp>
 #include "define.h"
 
 
 namespace mk {
 /**
-* @brief Read an annotation file (in .srt format)
+* @brief Write an annotation file (in .srt format). The file can be compressed on the fly (gzip or bzip2).
+*        Compression and writing take place in a background thread.
 */
 class AnnotationFileWriter
 {
@@ -39,15 +45,26 @@ public:
 	AnnotationFileWriter();
 	virtual ~AnnotationFileWriter();
 
-	void Open(const std::string& x_file);
+	void Open(const std::string& x_file, const std::string& x_compression = "none", int x_level = -1);
+	void Close();
 	void WriteAnnotation(TIME_STAMP x_start, TIME_STAMP x_end, std::stringstream& x_in);
+	static std::string CompressedExtension(const std::string& x_compression);
 
 private:
 	static log4cxx::LoggerPtr m_logger;
 
 protected:
+	void Work();
+
 	int m_subId;
-	std::ofstream m_file;
+	boost::iostreams::filtering_ostream m_file;
+
+	// queue of annotations to be written by the thread
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<std::string> m_queue;
+	bool m_stop = false;
 };
 
 } // namespace mk
@@ -0,0 +1,267 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "ConnectedComponents.h"
+#include <algorithm>
+#include <unordered_map>
+#include <climits>
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+/**
+* @brief Label a binary image and compute the statistics of blobs
+*
+* @param x_binary            Binary image (CV_8UC1): all non-zero pixels are foreground
+* @param x_nbStripes         Number of stripes processed in parallel
+* @param x_thirdOrderMoments Also compute the moments of third order (e.g. for Hu moments)
+*/
+void ConnectedComponents::Label(const Mat& x_binary, int x_nbStripes, bool x_thirdOrderMoments)
+{
+	CV_Assert(x_binary.type() == CV_8UC1);
+	m_labels.create(x_binary.size(), CV_32S);
+	m_parent.resize(x_binary.total() + 1);
+	m_localIndex.resize(x_binary.total() + 1);
+	m_stripes = splitInStripes(x_binary.size(), x_nbStripes, 0);
+	m_created.resize(m_stripes.size());
+
+	// 1. label each stripe independently
+	parallelForEach(m_stripes.size(), [this, &x_binary](int i){LabelStripe(x_binary, m_stripes[i]);});
+
+	// 2. merge the labels at the border of stripes
+	for(size_t i = 1 ; i < m_stripes.size() ; i++)
+	{
+		const int y = m_stripes[i].roi.y;
+		const int* labels = m_labels.ptr<int>(y);
+		const int* above  = m_labels.ptr<int>(y - 1);
+		for(int x = 0 ; x < m_labels.cols ; x++)
+		{
+			if(labels[x] == 0)
+				continue;
+			for(int dx = max(0, x - 1) ; dx <= min(m_labels.cols - 1, x + 1) ; dx++)
+			{
+				if(above[dx] != 0)
+					Union(labels[x], above[dx]);
+			}
+		}
+	}
+
+	// 3. give a final index to each root. Since a parent is always smaller than its child, labels can be resolved
+	//    in increasing order. Final indices are stored as negative values
+	int nbBlobs = 0;
+	for(const auto& created : m_created)
+	{
+		for(int label : created)
+		{
+			int parent = m_parent[label];
+			m_parent[label] = parent == label ? -(++nbBlobs) : m_parent[parent];
+		}
+	}
+
+	// 4. write the final labels and accumulate the statistics of blobs in each stripe. Only the blobs present in a stripe
+	//    are accumulated, so that the cost does not grow with the number of stripes times the number of blobs
+	m_accumulators.resize(m_stripes.size());
+	parallelForEach(m_stripes.size(), [this, x_thirdOrderMoments](int i){AccumulateStripe(m_stripes[i], x_thirdOrderMoments);});
+
+	vector<Accumulator> total(nbBlobs);
+	for(const auto& stripe : m_accumulators)
+	{
+		for(size_t j = 0 ; j < stripe.blobs.size() ; j++)
+		{
+			Accumulator& acc(total[stripe.blobs[j] - 1]);
+			const Accumulator& other(stripe.accumulators[j]);
+			acc.minX = min(acc.minX, other.minX);
+			acc.minY = min(acc.minY, other.minY);
+			acc.maxX = max(acc.maxX, other.maxX);
+			acc.maxY = max(acc.maxY, other.maxY);
+			acc.m00 += other.m00; acc.m10 += other.m10; acc.m01 += other.m01;
+			acc.m20 += other.m20; acc.m11 += other.m11; acc.m02 += other.m02;
+			acc.m30 += other.m30; acc.m21 += other.m21; acc.m12 += other.m12; acc.m03 += other.m03;
+		}
+	}
+
+	m_blobs.assign(nbBlobs, Blob());
+	for(int i = 0 ; i < nbBlobs ; i++)
+	{
+		const Accumulator& acc(total[i]);
+		Blob& blob(m_blobs[i]);
+		blob.rect = Rect(acc.minX, acc.minY, acc.maxX - acc.minX + 1, acc.maxY - acc.minY + 1);
+		blob.m00 = acc.m00; blob.m10 = acc.m10; blob.m01 = acc.m01;
+		blob.m20 = acc.m20; blob.m11 = acc.m11; blob.m02 = acc.m02;
+		blob.m30 = acc.m30; blob.m21 = acc.m21; blob.m12 = acc.m12; blob.m03 = acc.m03;
+	}
+}
+
+/**
+* @brief Extract the external contour of a blob. This is done on the bounding rectangle of the blob only
+*
+* @param x_blob      Index of the blob
+* @param xr_contour  Contour, in the coordinates of the image
+*/
+void ConnectedComponents::GetContour(int x_blob, vector<Point>& xr_contour) const
+{
+	const Rect& rect(m_blobs.at(x_blob).rect);
+	Mat mask = m_labels(rect) == x_blob + 1;
+	vector<vector<Point>> contours;
+	findContours(mask, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE, rect.tl());
+
+	// note: a blob has only one external contour
+	xr_contour.clear();
+	if(!contours.empty())
+		xr_contour.swap(contours.front());
+}
+
+/// Find the root of a label, with path halving
+int ConnectedComponents::Find(int x_label)
+{
+	while(m_parent[x_label] != x_label)
+	{
+		m_parent[x_label] = m_parent[m_parent[x_label]];
+		x_label = m_parent[x_label];
+	}
+	return x_label;
+}
+
+/// Merge two labels: the smallest root becomes the parent
+void ConnectedComponents::Union(int x_label1, int x_label2)
+{
+	int root1 = Find(x_label1);
+	int root2 = Find(x_label2);
+	if(root1 < root2)
+		m_parent[root2] = root1;
+	else if(root2 < root1)
+		m_parent[root1] = root2;
+}
+
+/**
+* @brief Give provisional labels to the pixels of a stripe. A provisional label is the index of the pixel that created
+*        it (+1), so that labels of different stripes never collide and only the part of m_parent of the stripe is written.
+*/
+void ConnectedComponents::LabelStripe(const Mat& x_binary, const Tile& x_stripe)
+{
+	vector<int>& created(m_created.at(x_stripe.index));
+	created.clear();
+	const int cols = x_binary.cols;
+
+	for(int y = x_stripe.roi.y ; y < x_stripe.roi.y + x_stripe.roi.height ; y++)
+	{
+		const uchar* pixels = x_binary.ptr<uchar>(y);
+		int* labels         = m_labels.ptr<int>(y);
+		// note: the first row of a stripe is not connected to the previous stripe yet
+		const int* above    = y > x_stripe.roi.y ? m_labels.ptr<int>(y - 1) : nullptr;
+
+		for(int x = 0 ; x < cols ; x++)
+		{
+			if(pixels[x] == 0)
+			{
+				labels[x] = 0;
+				continue;
+			}
+			int label = 0;
+			auto merge = [this, &label](int x_neighbour)
+			{
+				if(x_neighbour == 0)
+					return;
+				if(label == 0)
+					label = x_neighbour;
+				else if(label != x_neighbour)
+					Union(label, x_neighbour);
+			};
+			if(x > 0)
+				merge(labels[x - 1]);
+			if(above != nullptr)
+			{
+				if(x > 0)
+					merge(above[x - 1]);
+				merge(above[x]);
+				if(x + 1 < cols)
+					merge(above[x + 1]);
+			}
+			if(label == 0)
+			{
+				label = y * cols + x + 1;
+				m_parent[label] = label;
+				created.push_back(label);
+			}
+			labels[x] = label;
+		}
+	}
+}
+
+/// Replace the provisional labels of a stripe by the final ones and accumulate the statistics of blobs
+void ConnectedComponents::AccumulateStripe(const Tile& x_stripe, bool x_thirdOrderMoments)
+{
+	StripeAccumulators& stripe(m_accumulators.at(x_stripe.index));
+	stripe.blobs.clear();
+	stripe.accumulators.clear();
+
+	// note: all pixels of a stripe have a provisional label created in the stripe. Several provisional labels
+	//       of the stripe may belong to the same blob
+	unordered_map<int, int> blobToLocal;
+	for(int label : m_created.at(x_stripe.index))
+	{
+		const int index = -m_parent[label];
+		auto inserted = blobToLocal.emplace(index, static_cast<int>(stripe.blobs.size()));
+		if(inserted.second)
+		{
+			stripe.blobs.push_back(index);
+			stripe.accumulators.push_back(Accumulator());
+		}
+		m_localIndex[label] = inserted.first->second;
+	}
+
+	for(int y = x_stripe.roi.y ; y < x_stripe.roi.y + x_stripe.roi.height ; y++)
+	{
+		int* labels = m_labels.ptr<int>(y);
+		const double yy = y;
+		for(int x = 0 ; x < m_labels.cols ; x++)
+		{
+			if(labels[x] == 0)
+				continue;
+			Accumulator& acc(stripe.accumulators[m_localIndex[labels[x]]]);
+			labels[x] = -m_parent[labels[x]];
+
+			acc.minX = min(acc.minX, x);
+			acc.maxX = max(acc.maxX, x);
+			acc.minY = min(acc.minY, y);
+			acc.maxY = max(acc.maxY, y);
+			const double xx = x;
+			acc.m00 += 1;
+			acc.m10 += xx;
+			acc.m01 += yy;
+			acc.m20 += xx * xx;
+			acc.m11 += xx * yy;
+			acc.m02 += yy * yy;
+			if(x_thirdOrderMoments)
+			{
+				acc.m30 += xx * xx * xx;
+				acc.m21 += xx * xx * yy;
+				acc.m12 += xx * yy * yy;
+				acc.m03 += yy * yy * yy;
+			}
+		}
+	}
+}
+
+} // namespace mk
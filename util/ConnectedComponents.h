@@ -0,0 +1,90 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_CONNECTED_COMPONENTS_H
+#define MK_CONNECTED_COMPONENTS_H
+
+#include <vector>
+#include <climits>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+#include "Tiles.h"
+
+namespace mk {
+
+/// Statistics of a blob (a connected component), computed while labeling. Coordinates are the ones of the pixels
+struct Blob
+{
+	cv::Rect rect;
+	// raw moments of the pixels (third order only if requested)
+	double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m11 = 0, m02 = 0, m30 = 0, m21 = 0, m12 = 0, m03 = 0;
+
+	inline int Area() const {return static_cast<int>(m00);}
+	inline cv::Point2d Centroid() const {return cv::Point2d(m10 / m00, m01 / m00);}
+	inline cv::Moments Moments() const {return cv::Moments(m00, m10, m01, m20, m11, m02, m30, m21, m12, m03);}
+};
+
+/**
+* @brief Label the connected components of a binary image (8-connectivity). The image is labeled by horizontal stripes
+*        in parallel, labels are then merged at the borders of stripes with a union-find structure. The statistics of
+*        blobs are computed in the same pass as the final labels.
+*/
+class ConnectedComponents
+{
+public:
+	void Label(const cv::Mat& x_binary, int x_nbStripes, bool x_thirdOrderMoments = false);
+	void GetContour(int x_blob, std::vector<cv::Point>& xr_contour) const;
+
+	inline const std::vector<Blob>& GetBlobs() const {return m_blobs;}
+	/// Image of labels (CV_32S): 0 for the background, i + 1 for the blob of index i
+	inline const cv::Mat& GetLabels() const {return m_labels;}
+
+protected:
+	/// Statistics accumulated for a blob in one stripe
+	struct Accumulator
+	{
+		int minX = INT_MAX, minY = INT_MAX, maxX = -1, maxY = -1;
+		double m00 = 0, m10 = 0, m01 = 0, m20 = 0, m11 = 0, m02 = 0, m30 = 0, m21 = 0, m12 = 0, m03 = 0;
+	};
+	/// Statistics of the blobs of one stripe only
+	struct StripeAccumulators
+	{
+		std::vector<int> blobs;                 // final index of the blob of each accumulator
+		std::vector<Accumulator> accumulators;
+	};
+	int Find(int x_label);
+	void Union(int x_label1, int x_label2);
+	void LabelStripe(const cv::Mat& x_binary, const Tile& x_stripe);
+	void AccumulateStripe(const Tile& x_stripe, bool x_thirdOrderMoments);
+
+	cv::Mat m_labels;
+	std::vector<int> m_parent;                    // union-find: parent of each provisional label, always smaller or equal
+	std::vector<std::vector<int>> m_created;      // provisional labels created in each stripe, in increasing order
+	std::vector<int> m_localIndex;                // index of the accumulator of each provisional label in its stripe
+	std::vector<StripeAccumulators> m_accumulators;
+	std::vector<Tile> m_stripes;
+	std::vector<Blob> m_blobs;
+};
+
+} // namespace mk
+#endif
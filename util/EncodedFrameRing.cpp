@@ -0,0 +1,87 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "EncodedFrameRing.h"
+#include <cstring>
+
+namespace mk {
+using namespace std;
+
+/**
+* @brief Allocate the memory slab and remove all frames
+*
+* @param x_capacity  Size of the slab [bytes]
+* @param x_maxFrames Maximal number of frames kept
+*/
+void EncodedFrameRing::Reset(size_t x_capacity, size_t x_maxFrames)
+{
+	Clear();
+	m_maxFrames = x_maxFrames;
+	m_slab.resize(x_capacity);
+	m_slab.shrink_to_fit();
+}
+
+/**
+* @brief Add a frame at the end of the ring. The oldest frames are dropped if needed
+*
+* @param x_data      Encoded frame
+* @param x_size      Size of the encoded frame
+* @param x_timeStamp Time stamp of the frame
+*/
+void EncodedFrameRing::Push(const uchar* x_data, size_t x_size, TIME_STAMP x_timeStamp)
+{
+	if(m_maxFrames == 0)
+		return;
+	if(x_size > m_slab.size())
+	{
+		// note: this should not happen with a reasonable capacity, the buffer is cleared
+		Reset(2 * x_size, m_maxFrames);
+	}
+	while(m_frames.size() >= m_maxFrames)
+		PopFront();
+
+	size_t start = m_head;
+	if(start + x_size > m_slab.size())
+	{
+		// wrap around: the frames at the end of the slab are the oldest ones
+		while(!m_frames.empty() && m_frames.front().offset >= m_head)
+			PopFront();
+		start = 0;
+	}
+	// drop the oldest frames that overlap with the new one
+	while(!m_frames.empty() && m_frames.front().offset < start + x_size && start < m_frames.front().offset + m_frames.front().size)
+		PopFront();
+
+	memcpy(m_slab.data() + start, x_data, x_size);
+	m_frames.push_back(Frame{start, x_size, x_timeStamp});
+	m_head = start + x_size;
+	m_usedBytes += x_size;
+}
+
+void EncodedFrameRing::PopFront()
+{
+	m_usedBytes -= m_frames.front().size;
+	m_frames.pop_front();
+}
+
+} // namespace mk
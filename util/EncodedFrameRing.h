@@ -0,0 +1,71 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_ENCODED_FRAME_RING_H
+#define MK_ENCODED_FRAME_RING_H
+
+#include <opencv2/core/core.hpp>
+#include <deque>
+#include <vector>
+#include "define.h"
+
+namespace mk {
+/**
+* @brief A ring buffer of encoded frames (e.g. JPEG) stored in one preallocated memory slab.
+*        When the slab or the maximal number of frames is reached, the oldest frames are dropped.
+*/
+class EncodedFrameRing
+{
+public:
+	struct Frame
+	{
+		size_t offset;
+		size_t size;
+		TIME_STAMP timeStamp;
+	};
+
+	EncodedFrameRing() {}
+	void Reset(size_t x_capacity, size_t x_maxFrames);
+	void Push(const uchar* x_data, size_t x_size, TIME_STAMP x_timeStamp);
+	inline void Push(const std::vector<uchar>& x_data, TIME_STAMP x_timeStamp) {Push(x_data.data(), x_data.size(), x_timeStamp);}
+	inline void Clear() {m_frames.clear(); m_head = 0; m_usedBytes = 0;}
+
+	inline size_t Size() const {return m_frames.size();}
+	inline bool Empty() const {return m_frames.empty();}
+	inline const Frame& At(size_t x_index) const {return m_frames.at(x_index);}
+	inline const uchar* Data(const Frame& x_frame) const {return m_slab.data() + x_frame.offset;}
+	inline size_t GetCapacity() const {return m_slab.size();}
+	inline size_t GetUsedBytes() const {return m_usedBytes;}
+
+protected:
+	void PopFront();
+
+	std::vector<uchar> m_slab;
+	std::deque<Frame>  m_frames;         // from oldest to newest
+	size_t             m_maxFrames = 0;
+	size_t             m_head      = 0;  // end of the newest frame in the slab
+	size_t             m_usedBytes = 0;
+};
+
+} // namespace mk
+#endif
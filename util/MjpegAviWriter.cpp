@@ -0,0 +1,248 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "MjpegAviWriter.h"
+#include <opencv2/highgui/highgui.hpp>
+#include <cstdint>
+#include <cassert>
+#include "MkException.h"
+#include "define.h"
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+log4cxx::LoggerPtr MjpegAviWriter::m_logger(log4cxx::Logger::getLogger("MjpegAviWriter"));
+
+// Sizes of the header lists (see RIFF AVI specification)
+#define AVI_STRL_SIZE 116 // 'strl' + strh chunk (8 + 56) + strf chunk (8 + 40)
+#define AVI_HDRL_SIZE 192 // 'hdrl' + avih chunk (8 + 56) + strl list (8 + AVI_STRL_SIZE)
+#define AVIF_HASINDEX   0x10
+#define AVIIF_KEYFRAME  0x10
+
+MjpegAviWriter::~MjpegAviWriter()
+{
+	Close();
+}
+
+/**
+* @brief Open a file for writing
+*
+* @param x_file Name of the file with path
+* @param x_fps  Frame rate
+* @param x_size Size of the frames
+*/
+void MjpegAviWriter::Open(const string& x_file, double x_fps, const Size& x_size)
+{
+	Close();
+	if(x_fps <= 0)
+		throw MkException("Frame rate must be positive to write " + x_file, LOC);
+	m_file.open(x_file, ios::binary | ios::trunc);
+	if(!m_file.is_open())
+		throw MkException("Failed to open output video file " + x_file, LOC);
+	m_fps  = x_fps;
+	m_size = x_size;
+	m_index.clear();
+	m_maxFrameSize = 0;
+	WriteHeader();
+}
+
+/**
+* @brief Write the RIFF header. Fields that depend on the content are filled when closing
+*/
+void MjpegAviWriter::WriteHeader()
+{
+	WriteFourcc("RIFF");
+	m_posRiffSize = m_file.tellp();
+	WriteU32(0);
+	WriteFourcc("AVI ");
+
+	WriteFourcc("LIST");
+	WriteU32(AVI_HDRL_SIZE);
+	WriteFourcc("hdrl");
+
+	// main header
+	WriteFourcc("avih");
+	WriteU32(56);
+	WriteU32(static_cast<uint32_t>(1e6 / m_fps + 0.5)); // micro seconds per frame
+	WriteU32(0);                                        // max bytes per sec
+	WriteU32(0);                                        // padding granularity
+	WriteU32(AVIF_HASINDEX);                            // flags
+	m_posTotalFrames = m_file.tellp();
+	WriteU32(0);                                        // total frames
+	WriteU32(0);                                        // initial frames
+	WriteU32(1);                                        // streams
+	m_posSuggestedBuffer1 = m_file.tellp();
+	WriteU32(0);                                        // suggested buffer size
+	WriteU32(m_size.width);
+	WriteU32(m_size.height);
+	for(int i = 0 ; i < 4 ; i++)
+		WriteU32(0);                                    // reserved
+
+	// stream header
+	WriteFourcc("LIST");
+	WriteU32(AVI_STRL_SIZE);
+	WriteFourcc("strl");
+	WriteFourcc("strh");
+	WriteU32(56);
+	WriteFourcc("vids");
+	WriteFourcc("MJPG");
+	WriteU32(0);                                        // flags
+	WriteU16(0);                                        // priority
+	WriteU16(0);                                        // language
+	WriteU32(0);                                        // initial frames
+	WriteU32(1000);                                     // scale
+	WriteU32(static_cast<uint32_t>(m_fps * 1000 + 0.5)); // rate: fps = rate / scale
+	WriteU32(0);                                        // start
+	m_posLength = m_file.tellp();
+	WriteU32(0);                                        // length
+	m_posSuggestedBuffer2 = m_file.tellp();
+	WriteU32(0);                                        // suggested buffer size
+	WriteU32(0xFFFFFFFF);                               // quality
+	WriteU32(0);                                        // sample size
+	WriteU16(0);                                        // frame rectangle
+	WriteU16(0);
+	WriteU16(m_size.width);
+	WriteU16(m_size.height);
+
+	// stream format
+	WriteFourcc("strf");
+	WriteU32(40);
+	WriteU32(40);                                       // size of the bitmap info header
+	WriteU32(m_size.width);
+	WriteU32(m_size.height);
+	WriteU16(1);                                        // planes
+	WriteU16(24);                                       // bit count
+	WriteFourcc("MJPG");                                // compression
+	WriteU32(m_size.width * m_size.height * 3);         // image size
+	for(int i = 0 ; i < 4 ; i++)
+		WriteU32(0);                                    // resolution and colors
+
+	WriteFourcc("LIST");
+	m_posMoviSize = m_file.tellp();
+	WriteU32(0);
+	m_posMovi = m_file.tellp();
+	WriteFourcc("movi");
+}
+
+/**
+* @brief Write a frame that is already encoded in JPEG
+*
+* @param x_data Encoded frame
+* @param x_size Size of the data
+*/
+void MjpegAviWriter::WriteEncoded(const uchar* x_data, size_t x_size)
+{
+	if(!m_file.is_open())
+		throw MkException("Video file must be opened before writing", LOC);
+	uint32_t offset = static_cast<uint32_t>(m_file.tellp() - m_posMovi);
+	WriteFourcc("00dc");
+	WriteU32(x_size);
+	m_file.write(reinterpret_cast<const char*>(x_data), x_size);
+	if(x_size % 2 == 1)
+		m_file.put(0); // chunks are aligned on 16 bits
+	m_index.emplace_back(offset, x_size);
+	m_maxFrameSize = max<uint32_t>(m_maxFrameSize, x_size);
+}
+
+/**
+* @brief Encode and write a frame
+*
+* @param x_frame   Frame to write
+* @param x_quality Quality of the JPEG encoding [0-100]
+*/
+void MjpegAviWriter::Write(const Mat& x_frame, int x_quality)
+{
+	assert(x_frame.size() == m_size);
+	if(!imencode(".jpg", x_frame, m_buffer, {IMWRITE_JPEG_QUALITY, x_quality}))
+		throw MkException("Cannot encode frame to JPEG", LOC);
+	WriteEncoded(m_buffer);
+}
+
+/**
+* @brief Write the index, complete the header and close the file
+*/
+void MjpegAviWriter::Close()
+{
+	if(!m_file.is_open())
+		return;
+
+	std::streampos posIndex = m_file.tellp();
+	WriteFourcc("idx1");
+	WriteU32(16 * m_index.size());
+	for(const auto& elem : m_index)
+	{
+		WriteFourcc("00dc");
+		WriteU32(AVIIF_KEYFRAME);
+		WriteU32(elem.first);
+		WriteU32(elem.second);
+	}
+	std::streampos posEnd = m_file.tellp();
+	if(static_cast<std::streamoff>(posEnd) > UINT32_MAX)
+		LOG_WARN(m_logger, "Video file is larger than the size supported by the AVI format");
+
+	PatchU32(m_posRiffSize, static_cast<uint32_t>(posEnd - m_posRiffSize - 4));
+	PatchU32(m_posMoviSize, static_cast<uint32_t>(posIndex - m_posMovi));
+	PatchU32(m_posTotalFrames, m_index.size());
+	PatchU32(m_posLength, m_index.size());
+	PatchU32(m_posSuggestedBuffer1, m_maxFrameSize + 8);
+	PatchU32(m_posSuggestedBuffer2, m_maxFrameSize + 8);
+	m_file.close();
+	m_index.clear();
+}
+
+void MjpegAviWriter::WriteU32(uint32_t x_value)
+{
+	// note: AVI is little endian
+	char bytes[4] = {
+		static_cast<char>(x_value & 0xff),
+		static_cast<char>((x_value >> 8) & 0xff),
+		static_cast<char>((x_value >> 16) & 0xff),
+		static_cast<char>((x_value >> 24) & 0xff)
+	};
+	m_file.write(bytes, 4);
+}
+
+void MjpegAviWriter::WriteU16(uint16_t x_value)
+{
+	char bytes[2] = {
+		static_cast<char>(x_value & 0xff),
+		static_cast<char>((x_value >> 8) & 0xff)
+	};
+	m_file.write(bytes, 2);
+}
+
+void MjpegAviWriter::WriteFourcc(const char* x_fourcc)
+{
+	m_file.write(x_fourcc, 4);
+}
+
+void MjpegAviWriter::PatchU32(streampos x_pos, uint32_t x_value)
+{
+	streampos current = m_file.tellp();
+	m_file.seekp(x_pos);
+	WriteU32(x_value);
+	m_file.seekp(current);
+}
+
+} // namespace mk
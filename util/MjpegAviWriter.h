@@ -0,0 +1,79 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MJPEG_AVI_WRITER_H
+#define MJPEG_AVI_WRITER_H
+
+#include <log4cxx/logger.h>
+#include <opencv2/core/core.hpp>
+#include <fstream>
+#include <vector>
+
+namespace mk {
+/**
+* @brief Write a motion JPEG video (.avi). Frames that are already encoded as JPEG are written as they are,
+*        without decoding and encoding again.
+*/
+class MjpegAviWriter
+{
+public:
+	MjpegAviWriter() {}
+	virtual ~MjpegAviWriter();
+
+	void Open(const std::string& x_file, double x_fps, const cv::Size& x_size);
+	void WriteEncoded(const uchar* x_data, size_t x_size);
+	inline void WriteEncoded(const std::vector<uchar>& x_data) {WriteEncoded(x_data.data(), x_data.size());}
+	void Write(const cv::Mat& x_frame, int x_quality);
+	void Close();
+	inline bool IsOpened() const {return m_file.is_open();}
+	inline size_t GetFrameCount() const {return m_index.size();}
+
+protected:
+	void WriteHeader();
+	void WriteU32(uint32_t x_value);
+	void WriteU16(uint16_t x_value);
+	void WriteFourcc(const char* x_fourcc);
+	void PatchU32(std::streampos x_pos, uint32_t x_value);
+
+	std::ofstream m_file;
+	double m_fps = 0;
+	cv::Size m_size;
+	std::vector<std::pair<uint32_t, uint32_t>> m_index; // offset and size of each frame
+	std::vector<uchar> m_buffer;                        // buffer for encoding
+	uint32_t m_maxFrameSize = 0;
+
+	// positions of the fields to fill at the end
+	std::streampos m_posRiffSize;
+	std::streampos m_posTotalFrames;
+	std::streampos m_posSuggestedBuffer1;
+	std::streampos m_posLength;
+	std::streampos m_posSuggestedBuffer2;
+	std::streampos m_posMoviSize;
+	std::streampos m_posMovi;
+
+private:
+	static log4cxx::LoggerPtr m_logger;
+};
+
+} // namespace mk
+#endif
@@ -0,0 +1,173 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "RegionsOfInterest.h"
+#include "ConnectedComponents.h"
+#include "define.h"
+#include <algorithm>
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+log4cxx::LoggerPtr RegionsOfInterest::m_logger(log4cxx::Logger::getLogger("RegionsOfInterest"));
+
+/**
+* @brief Add the bounding rectangles of the blobs of a binary mask to a list of regions
+*
+* @param x_mask      Binary mask (CV_8UC1), e.g. the foreground of a background subtraction
+* @param x_nbStripes Number of stripes used to label the mask in parallel
+* @param xr_regions  List of regions
+*/
+void regionsFromMask(const Mat& x_mask, int x_nbStripes, vector<Rect>& xr_regions)
+{
+	ConnectedComponents components;
+	components.Label(x_mask, x_nbStripes);
+	for(const auto& elem : components.GetBlobs())
+		xr_regions.push_back(elem.rect);
+}
+
+/**
+* @brief Prepare regions of interest for a detector: regions are dilated by a margin, enlarged to the minimal size
+*        (e.g. the window of the detector) and merged until they do not overlap
+*
+* @param xr_regions   Regions, in the coordinates of the image
+* @param x_margin     Margin added on each side of a region
+* @param x_minSize    Minimal size of a region
+* @param x_imageSize  Size of the image: regions are clipped to the image
+*/
+void mergeRegions(vector<Rect>& xr_regions, int x_margin, const Size& x_minSize, const Size& x_imageSize)
+{
+	const Rect image(Point(0, 0), x_imageSize);
+	for(auto& elem : xr_regions)
+	{
+		elem = Rect(elem.x - x_margin, elem.y - x_margin, elem.width + 2 * x_margin, elem.height + 2 * x_margin);
+		// note: the region is enlarged around its center, then moved inside the image
+		int width  = min(max(elem.width,  x_minSize.width),  x_imageSize.width);
+		int height = min(max(elem.height, x_minSize.height), x_imageSize.height);
+		int x = min(max(0, elem.x + elem.width / 2 - width / 2),   x_imageSize.width  - width);
+		int y = min(max(0, elem.y + elem.height / 2 - height / 2), x_imageSize.height - height);
+		elem = Rect(x, y, width, height) & image;
+	}
+	xr_regions.erase(remove_if(xr_regions.begin(), xr_regions.end(), [](const Rect& x_rect){return x_rect.area() == 0;}), xr_regions.end());
+
+	// merge overlapping regions until no region overlaps another one
+	bool merged = true;
+	while(merged)
+	{
+		merged = false;
+		for(size_t i = 0 ; i < xr_regions.size() ; i++)
+		{
+			for(size_t j = i + 1 ; j < xr_regions.size() ; j++)
+			{
+				if((xr_regions[i] & xr_regions[j]).area() > 0)
+				{
+					xr_regions[i] |= xr_regions[j];
+					xr_regions.erase(xr_regions.begin() + j);
+					merged = true;
+					j = i;
+				}
+			}
+		}
+	}
+}
+
+/// Return the total area of regions that do not overlap
+int regionsArea(const vector<Rect>& x_regions)
+{
+	int area = 0;
+	for(const auto& elem : x_regions)
+		area += elem.area();
+	return area;
+}
+
+/**
+* @brief Merge regions of interest (see mergeRegions). If they cover a large part of the image, the whole image
+*        is used instead since scanning one image is faster than scanning many regions
+*
+* @param xr_regions   Regions, in the coordinates of the image
+* @param x_margin     Margin added on each side of a region
+* @param x_minSize    Minimal size of a region
+* @param x_imageSize  Size of the image
+* @param x_maxRatio   Maximal part of the image covered by regions
+*/
+void selectRegions(vector<Rect>& xr_regions, int x_margin, const Size& x_minSize, const Size& x_imageSize, double x_maxRatio)
+{
+	mergeRegions(xr_regions, x_margin, x_minSize, x_imageSize);
+	if(regionsArea(xr_regions) > x_maxRatio * x_imageSize.area())
+		xr_regions = {Rect(Point(0, 0), x_imageSize)};
+}
+
+void RegionsOfInterest::Reset()
+{
+	m_regions.clear();
+	m_scannedPixels = 0;
+	m_totalPixels   = 0;
+}
+
+/**
+* @brief Select the regions to scan on the current frame: the whole image or the regions given by a mask and objects
+*
+* @param xp_mask     Binary mask of the regions (e.g. foreground), nullptr if not used
+* @param xp_objects  Objects whose rectangles are regions, nullptr if not used
+* @param x_nbStripes Number of stripes used to label the mask in parallel
+* @param x_margin    Margin added on each side of a region
+* @param x_minSize   Minimal size of a region: a region must contain at least one window of the detector
+* @param x_imageSize Size of the image
+* @param x_maxRatio  Maximal part of the image covered by regions, above it the whole image is scanned
+*/
+void RegionsOfInterest::Select(const Mat* xp_mask, const vector<Object>* xp_objects, int x_nbStripes, int x_margin,
+	const Size& x_minSize, const Size& x_imageSize, double x_maxRatio)
+{
+	m_regions.clear();
+	if(xp_mask != nullptr)
+		regionsFromMask(*xp_mask, x_nbStripes, m_regions);
+	if(xp_objects != nullptr)
+	{
+		for(const auto& elem : *xp_objects)
+			m_regions.push_back(elem.GetRect());
+	}
+	if(xp_mask != nullptr || xp_objects != nullptr)
+		selectRegions(m_regions, x_margin, x_minSize, x_imageSize, x_maxRatio);
+	else m_regions.push_back(Rect(Point(0, 0), x_imageSize));
+
+	m_scannedPixels += regionsArea(m_regions);
+	m_totalPixels   += x_imageSize.area();
+}
+
+/// No region is scanned on the current frame (e.g. objects are tracked)
+void RegionsOfInterest::Skip(const Size& x_imageSize)
+{
+	m_regions.clear();
+	m_totalPixels += x_imageSize.area();
+}
+
+/// Log the scanned part of the images and add it to the results of the module
+void RegionsOfInterest::PrintStatistics(const string& x_moduleName, mkconf& xr_result) const
+{
+	const double ratio = GetScannedRatio();
+	LOG_INFO(m_logger, "Module " << x_moduleName << ": " << 100 * ratio << "% of the image was scanned");
+	xr_result["module"][x_moduleName]["scannedRatio"] = ratio;
+}
+
+} // namespace mk
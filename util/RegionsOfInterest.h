@@ -0,0 +1,66 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_REGIONS_OF_INTEREST_H
+#define MK_REGIONS_OF_INTEREST_H
+
+#include <vector>
+#include <string>
+#include <log4cxx/logger.h>
+#include <opencv2/core/core.hpp>
+#include "Object.h"
+#include "config.h"
+
+namespace mk {
+
+void regionsFromMask(const cv::Mat& x_mask, int x_nbStripes, std::vector<cv::Rect>& xr_regions);
+void mergeRegions(std::vector<cv::Rect>& xr_regions, int x_margin, const cv::Size& x_minSize, const cv::Size& x_imageSize);
+int regionsArea(const std::vector<cv::Rect>& x_regions);
+void selectRegions(std::vector<cv::Rect>& xr_regions, int x_margin, const cv::Size& x_minSize, const cv::Size& x_imageSize, double x_maxRatio);
+
+/**
+* @brief Regions scanned by a detector on each frame, with the statistics of the scanned part of the images
+*/
+class RegionsOfInterest
+{
+public:
+	void Reset();
+	void Select(const cv::Mat* xp_mask, const std::vector<Object>* xp_objects, int x_nbStripes, int x_margin,
+		const cv::Size& x_minSize, const cv::Size& x_imageSize, double x_maxRatio);
+	void Skip(const cv::Size& x_imageSize);
+	void PrintStatistics(const std::string& x_moduleName, mkconf& xr_result) const;
+
+	inline const std::vector<cv::Rect>& GetRegions() const {return m_regions;}
+	inline double GetScannedRatio() const {return m_totalPixels > 0 ? static_cast<double>(m_scannedPixels) / m_totalPixels : 0;}
+
+protected:
+	std::vector<cv::Rect> m_regions;
+	uint64_t m_scannedPixels = 0;
+	uint64_t m_totalPixels   = 0;
+
+private:
+	static log4cxx::LoggerPtr m_logger;
+};
+
+} // namespace mk
+#endif
@@ -0,0 +1,162 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "SampleStore.h"
+#include "MkException.h"
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+/**
+* @brief Reset the store, all samples are discarded
+*
+* @param x_cols              Number of columns of samples
+* @param x_chunkRows         Number of samples per chunk
+* @param x_maxChunksInMemory Number of chunks kept in memory, the older ones are written to the file (0: no limit)
+* @param x_spillFile         File where chunks are written, only used if the number of chunks is limited
+*/
+void SampleStore::Reset(int x_cols, int x_chunkRows, int x_maxChunksInMemory, const string& x_spillFile)
+{
+	if(x_cols <= 0 || x_chunkRows <= 0)
+		throw MkException("Invalid size for the store of samples", LOC);
+	m_cols              = x_cols;
+	m_chunkRows         = x_chunkRows;
+	m_maxChunksInMemory = x_maxChunksInMemory;
+	m_nbChunksInMemory  = 0;
+	m_nbRows            = 0;
+	m_spillFile         = x_spillFile;
+	m_chunks.clear();
+	if(m_spill.is_open())
+		m_spill.close();
+}
+
+/**
+* @brief Append samples
+*
+* @param x_samples   Samples (CV_32F), one per row
+* @param x_responses Responses (CV_32S), one per row
+*/
+void SampleStore::Append(const Mat& x_samples, const Mat& x_responses)
+{
+	if(x_samples.cols != m_cols || x_samples.type() != CV_32F || x_responses.rows != x_samples.rows || x_responses.type() != CV_32S)
+		throw MkException("Samples and responses do not match the store", LOC);
+
+	for(int i = 0 ; i < x_samples.rows ; )
+	{
+		if(m_chunks.empty() || m_chunks.back().rows == m_chunkRows)
+		{
+			m_chunks.push_back(Chunk());
+			m_chunks.back().samples.create(m_chunkRows, m_cols, CV_32F);
+			m_chunks.back().responses.create(m_chunkRows, 1, CV_32S);
+			m_nbChunksInMemory++;
+			// note: the last chunk always stays in memory
+			if(m_maxChunksInMemory > 0 && m_nbChunksInMemory > m_maxChunksInMemory)
+			{
+				for(auto& elem : m_chunks)
+				{
+					if(!elem.spilled)
+					{
+						Spill(elem);
+						break;
+					}
+				}
+			}
+		}
+		Chunk& chunk(m_chunks.back());
+		const int nb = min(x_samples.rows - i, m_chunkRows - chunk.rows);
+		x_samples.rowRange(i, i + nb).copyTo(chunk.samples.rowRange(chunk.rows, chunk.rows + nb));
+		x_responses.rowRange(i, i + nb).copyTo(chunk.responses.rowRange(chunk.rows, chunk.rows + nb));
+		chunk.rows += nb;
+		m_nbRows   += nb;
+		i          += nb;
+	}
+}
+
+/**
+* @brief Load the samples in one matrix, for training
+*
+* @param xr_samples   Samples
+* @param xr_responses Responses
+* @param x_maxRows    Maximal number of samples: if the store contains more, samples are taken at a regular step (0: no limit)
+*/
+void SampleStore::Load(Mat& xr_samples, Mat& xr_responses, size_t x_maxRows)
+{
+	const size_t step = x_maxRows == 0 || m_nbRows <= x_maxRows ? 1 : (m_nbRows + x_maxRows - 1) / x_maxRows;
+	xr_samples.create((m_nbRows + step - 1) / step, m_cols, CV_32F);
+	xr_responses.create(xr_samples.rows, 1, CV_32S);
+
+	size_t index = 0; // index of the sample in the store
+	int row      = 0; // row of the output
+	Mat samples, responses;
+	for(const auto& chunk : m_chunks)
+	{
+		if(chunk.spilled)
+		{
+			samples.create(chunk.rows, m_cols, CV_32F);
+			responses.create(chunk.rows, 1, CV_32S);
+			m_spill.seekg(chunk.offset);
+			m_spill.read(reinterpret_cast<char*>(samples.data), samples.total() * samples.elemSize());
+			m_spill.read(reinterpret_cast<char*>(responses.data), responses.total() * responses.elemSize());
+			if(!m_spill)
+				throw MkException("Cannot read the samples from " + m_spillFile, LOC);
+		}
+		else
+		{
+			samples   = chunk.samples;
+			responses = chunk.responses;
+		}
+		// first row of the chunk that is a multiple of the step
+		for(size_t i = (step - index % step) % step ; i < static_cast<size_t>(chunk.rows) ; i += step)
+		{
+			samples.row(i).copyTo(xr_samples.row(row));
+			xr_responses.at<int>(row) = responses.at<int>(i);
+			row++;
+		}
+		index += chunk.rows;
+	}
+	CV_Assert(row == xr_samples.rows);
+}
+
+/// Write a chunk to the file and release its memory
+void SampleStore::Spill(Chunk& xr_chunk)
+{
+	if(!m_spill.is_open())
+	{
+		m_spill.open(m_spillFile, ios::in | ios::out | ios::binary | ios::trunc);
+		if(!m_spill.is_open())
+			throw MkException("Cannot open file " + m_spillFile + " to store samples", LOC);
+	}
+	m_spill.seekp(0, ios::end);
+	xr_chunk.offset = m_spill.tellp();
+	m_spill.write(reinterpret_cast<const char*>(xr_chunk.samples.data), xr_chunk.rows * m_cols * sizeof(float));
+	m_spill.write(reinterpret_cast<const char*>(xr_chunk.responses.data), xr_chunk.rows * sizeof(int));
+	if(!m_spill)
+		throw MkException("Cannot write the samples to " + m_spillFile, LOC);
+	xr_chunk.samples.release();
+	xr_chunk.responses.release();
+	xr_chunk.spilled = true;
+	m_nbChunksInMemory--;
+}
+
+} // namespace mk
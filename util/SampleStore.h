@@ -0,0 +1,71 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_SAMPLE_STORE_H
+#define MK_SAMPLE_STORE_H
+
+#include <vector>
+#include <fstream>
+#include <opencv2/core/core.hpp>
+
+namespace mk {
+
+/**
+* @brief Store the samples of a training set by chunks of fixed size, to avoid reallocations while appending. When
+*        more chunks than a maximum are in memory, the oldest ones are written to a file, so that long learning
+*        sessions stay bounded in memory. The training set can be loaded with a uniform sub-sampling.
+*/
+class SampleStore
+{
+public:
+	void Reset(int x_cols, int x_chunkRows, int x_maxChunksInMemory, const std::string& x_spillFile);
+	void Append(const cv::Mat& x_samples, const cv::Mat& x_responses);
+	void Load(cv::Mat& xr_samples, cv::Mat& xr_responses, size_t x_maxRows);
+
+	inline size_t GetNbRows() const {return m_nbRows;}
+	inline bool IsEmpty() const {return m_nbRows == 0;}
+
+protected:
+	/// A chunk of samples (CV_32F) and responses (CV_32S), in memory or in the file
+	struct Chunk
+	{
+		cv::Mat samples;
+		cv::Mat responses;
+		int rows = 0;
+		std::streampos offset;
+		bool spilled = false;
+	};
+	void Spill(Chunk& xr_chunk);
+
+	int m_cols               = 0;
+	int m_chunkRows          = 1;
+	int m_maxChunksInMemory  = 0;
+	int m_nbChunksInMemory   = 0;
+	size_t m_nbRows          = 0;
+	std::string m_spillFile;
+	std::fstream m_spill;
+	std::vector<Chunk> m_chunks;
+};
+
+} // namespace mk
+#endif
@@ -0,0 +1,201 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "SizePrior.h"
+#include "MkException.h"
+#include <climits>
+#include <algorithm>
+#include <cmath>
+
+// range of sizes of a band: this number of standard deviations around the mean
+#define NB_STD_DEVS 2.5
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+/**
+* @brief Reset the prior, learned statistics and calibration are discarded
+*
+* @param x_imageSize  Size of the image
+* @param x_nbBands    Number of horizontal bands
+* @param x_minSamples Number of objects in a band before its range of sizes is used (0: never)
+* @param x_margin     Factor applied to the range of sizes, to accept slightly smaller and larger objects
+*/
+void SizePrior::Reset(const Size& x_imageSize, int x_nbBands, int x_minSamples, double x_margin)
+{
+	if(x_nbBands <= 0 || x_margin < 1)
+		throw MkException("Invalid parameters for the size prior", LOC);
+	m_imageSize  = x_imageSize;
+	m_bands.assign(min(x_nbBands, max(1, x_imageSize.height)), Band());
+	m_minSamples = x_minSamples;
+	m_margin     = x_margin;
+	m_calibrated = false;
+}
+
+/// Learn the size of an object, found at any size. This has no effect if the prior is calibrated
+void SizePrior::Add(const Rect& x_object)
+{
+	if(m_calibrated || m_minSamples <= 0 || x_object.height <= 0 || m_bands.empty())
+		return;
+	const int y = x_object.y + x_object.height / 2;
+	if(y < 0 || y >= m_imageSize.height)
+		return;
+	Band& band(m_bands.at(static_cast<int64_t>(y) * m_bands.size() / m_imageSize.height));
+	const double value = log(x_object.height);
+	band.count++;
+	const double delta = value - band.mean;
+	band.mean += delta / band.count;
+	band.m2   += delta * (value - band.mean);
+}
+
+/**
+* @brief Range of plausible heights of objects centered in a band
+*
+* @param x_band      Index of the band
+* @param xr_minSize  Minimal height [pixels]
+* @param xr_maxSize  Maximal height [pixels]
+*
+* @return false if the range is unknown (not enough samples)
+*/
+bool SizePrior::GetRange(int x_band, double& xr_minSize, double& xr_maxSize) const
+{
+	const Band& band(m_bands.at(x_band));
+	if(m_calibrated)
+	{
+		xr_minSize = band.minSize * m_imageSize.height / m_margin;
+		xr_maxSize = band.maxSize * m_imageSize.height * m_margin;
+		return true;
+	}
+	if(m_minSamples <= 0 || band.count < m_minSamples)
+		return false;
+	const double stdDev = sqrt(band.m2 / band.count);
+	xr_minSize = exp(band.mean - NB_STD_DEVS * stdDev) / m_margin;
+	xr_maxSize = exp(band.mean + NB_STD_DEVS * stdDev) * m_margin;
+	return true;
+}
+
+/**
+* @brief Split a region to scan in areas with a restricted range of sizes. Each area only keeps the objects centered on
+*        the rows of its band. If the range of a band crossed by the region is unknown, the region is scanned at all
+*        sizes in one area: objects centered on this band could be as large as the region.
+*
+* @param x_region  Region to scan
+* @param x_minSize Minimal size of objects
+* @param xr_areas  Resulting areas
+*/
+void SizePrior::Split(const Rect& x_region, int x_minSize, vector<ScanArea>& xr_areas) const
+{
+	xr_areas.clear();
+	bool known = !m_bands.empty();
+	for(int i = 0 ; i < GetNbBands() && known ; i++)
+	{
+		Range rows = RowsOfBand(i);
+		rows.start = max(rows.start, x_region.y);
+		rows.end   = min(rows.end, x_region.y + x_region.height);
+		if(rows.empty())
+			continue;
+		double minSize = 0, maxSize = 0;
+		if(!GetRange(i, minSize, maxSize))
+		{
+			known = false;
+			continue;
+		}
+		ScanArea area{Rect(), rows, max(x_minSize, cvFloor(minSize)), cvCeil(maxSize)};
+		if(area.maxSize < area.minSize)
+			continue;
+		// note: objects centered on the band can exceed it by half their size
+		const int top    = max(x_region.y, rows.start - area.maxSize / 2);
+		const int bottom = min(x_region.y + x_region.height, rows.end + area.maxSize / 2);
+		area.roi = Rect(x_region.x, top, x_region.width, bottom - top);
+		xr_areas.push_back(area);
+	}
+	if(!known)
+	{
+		xr_areas.clear();
+		xr_areas.push_back(ScanArea{x_region, Range(x_region.y, x_region.y + x_region.height), x_minSize, INT_MAX});
+	}
+}
+
+/// Rows of the image covered by a band
+Range SizePrior::RowsOfBand(int x_band) const
+{
+	const int64_t nb = m_bands.size();
+	return Range(x_band * m_imageSize.height / nb, (x_band + 1) * m_imageSize.height / nb);
+}
+
+void to_json(mkjson& _json, const SizePrior& x_prior)
+{
+	_json = mkjson::object();
+	_json["rows"] = mkjson::array();
+	for(int i = 0 ; i < x_prior.GetNbBands() ; i++)
+	{
+		double minSize = 0, maxSize = 0;
+		if(!x_prior.GetRange(i, minSize, maxSize))
+			continue;
+		Range rows = x_prior.RowsOfBand(i);
+		// note: the margin is removed, it is applied again when the prior is read
+		const double height = x_prior.m_imageSize.height;
+		_json["rows"].push_back(mkjson{
+			{"y", (rows.start + rows.end) / 2.0 / height},
+			{"minSize", minSize * x_prior.m_margin / height},
+			{"maxSize", maxSize / x_prior.m_margin / height}
+		});
+	}
+}
+
+/// Read a calibration, the prior must have been reset to the size of the image
+void from_json(const mkjson& x_json, SizePrior& xr_prior)
+{
+	vector<Point3d> rows; // y, min and max sizes
+	for(const auto& elem : x_json.at("rows"))
+		rows.push_back(Point3d(elem.at("y").get<double>(), elem.at("minSize").get<double>(), elem.at("maxSize").get<double>()));
+	if(rows.empty())
+		throw MkException("The calibration of sizes must contain at least one row", LOC);
+	sort(rows.begin(), rows.end(), [](const Point3d& x_1, const Point3d& x_2){return x_1.x < x_2.x;});
+
+	// interpolate linearly at the center of each band
+	const double height = xr_prior.m_imageSize.height;
+	for(int i = 0 ; i < xr_prior.GetNbBands() ; i++)
+	{
+		Range range = xr_prior.RowsOfBand(i);
+		const double y = (range.start + range.end) / 2.0 / height;
+		auto next = upper_bound(rows.begin(), rows.end(), y, [](double x_y, const Point3d& x_row){return x_y < x_row.x;});
+		Point3d value;
+		if(next == rows.begin())
+			value = rows.front();
+		else if(next == rows.end())
+			value = rows.back();
+		else
+		{
+			const Point3d& prev(*(next - 1));
+			const double alpha = (y - prev.x) / (next->x - prev.x);
+			value = prev + alpha * (*next - prev);
+		}
+		xr_prior.m_bands[i].minSize = value.y;
+		xr_prior.m_bands[i].maxSize = value.z;
+	}
+	xr_prior.m_calibrated = true;
+}
+
+} // namespace mk
@@ -0,0 +1,86 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_SIZE_PRIOR_H
+#define MK_SIZE_PRIOR_H
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+#include "serialize.h"
+
+namespace mk {
+
+/// A part of an image to scan for objects whose size is in a given range
+struct ScanArea
+{
+	cv::Rect roi;     // region to scan
+	cv::Range rows;   // only objects centered on these rows are kept
+	int minSize;      // height of the smallest object
+	int maxSize;      // height of the largest object
+};
+
+/**
+* @brief Prior on the size of objects in function of their row in the image (e.g. for a fixed camera). The image is split
+*        in horizontal bands, the range of plausible heights of objects in each band is either learned from detections
+*        or read from a calibration file. It is used to restrict the scales scanned by a detector in each band.
+*
+*        The calibration file has the format of the output of to_json: a list of rows with their range of sizes,
+*        relative to the height of the image: {"rows":[{"y":0.5,"minSize":0.1,"maxSize":0.2}, ...]}.
+*        Bands are interpolated between rows.
+*/
+class SizePrior
+{
+public:
+	void Reset(const cv::Size& x_imageSize, int x_nbBands, int x_minSamples, double x_margin);
+	void Add(const cv::Rect& x_object);
+	void Split(const cv::Rect& x_region, int x_minSize, std::vector<ScanArea>& xr_areas) const;
+	bool GetRange(int x_band, double& xr_minSize, double& xr_maxSize) const;
+
+	inline int GetNbBands() const {return m_bands.size();}
+	inline bool IsCalibrated() const {return m_calibrated;}
+
+	friend void to_json(mkjson& _json, const SizePrior& x_prior);
+	friend void from_json(const mkjson& x_json, SizePrior& xr_prior);
+
+protected:
+	/// Statistics of the log of the height of objects centered in a band (Welford's algorithm)
+	struct Band
+	{
+		double count = 0;
+		double mean  = 0;
+		double m2    = 0;
+		// calibrated range
+		double minSize = 0;
+		double maxSize = 0;
+	};
+	cv::Range RowsOfBand(int x_band) const;
+
+	cv::Size m_imageSize;
+	std::vector<Band> m_bands;
+	int m_minSamples    = 0;
+	double m_margin     = 1;
+	bool m_calibrated   = false;
+};
+
+} // namespace mk
+#endif
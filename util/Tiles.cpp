@@ -0,0 +1,91 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#include "Tiles.h"
+#include <algorithm>
+
+namespace mk {
+using namespace std;
+using namespace cv;
+
+namespace {
+/// Call a function for each index of a range
+class ParallelForEach : public ParallelLoopBody
+{
+public:
+	explicit ParallelForEach(const function<void(int)>& x_function) : m_function(x_function) {}
+	void operator()(const Range& x_range) const override
+	{
+		for(int i = x_range.start ; i < x_range.end ; i++)
+			m_function(i);
+	}
+private:
+	const function<void(int)>& m_function;
+};
+} // namespace
+
+/**
+* @brief Split an image in horizontal stripes
+*
+* @param x_size    Size of the image
+* @param x_nbTiles Number of stripes, limited by the number of rows
+* @param x_halo    Number of rows of the neighbouring stripes that are read by each stripe
+* @return The stripes
+*/
+vector<Tile> splitInStripes(const Size& x_size, int x_nbTiles, int x_halo)
+{
+	x_nbTiles = max(1, min(x_nbTiles, x_size.height));
+	vector<Tile> tiles(x_nbTiles);
+	for(int i = 0 ; i < x_nbTiles ; i++)
+	{
+		int y1 = i * x_size.height / x_nbTiles;
+		int y2 = (i + 1) * x_size.height / x_nbTiles;
+		int h1 = max(0, y1 - x_halo);
+		int h2 = min(x_size.height, y2 + x_halo);
+		tiles[i].index = i;
+		tiles[i].roi   = Rect(0, y1, x_size.width, y2 - y1);
+		tiles[i].halo  = Rect(0, h1, x_size.width, h2 - h1);
+	}
+	return tiles;
+}
+
+/**
+* @brief Call a function for each index in [0, x_nb[ in parallel. This uses the thread pool of OpenCV, which is shared with
+*        the parallel functions of OpenCV. Its size can be set with the parameter nbThreads of the context
+*
+* @param x_nb       Number of calls
+* @param x_function Function to call with the index
+*/
+void parallelForEach(int x_nb, const function<void(int)>& x_function)
+{
+	if(x_nb <= 0)
+		return;
+	if(x_nb == 1)
+	{
+		x_function(0);
+		return;
+	}
+	parallel_for_(Range(0, x_nb), ParallelForEach(x_function));
+}
+
+} // namespace mk
@@ -0,0 +1,48 @@
+/*----------------------------------------------------------------------------------
+*
+*    MARKUS : a manager for video analysis modules
+*
+*    author : Laurent Winkler <lwinkler888@gmail.com>
+*
+*
+*    This file is part of Markus.
+*
+*    Markus is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU Lesser General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    Markus is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Lesser General Public License for more details.
+*
+*    You should have received a copy of the GNU Lesser General Public License
+*    along with Markus.  If not, see <http://www.gnu.org/licenses/>.
+-------------------------------------------------------------------------------------*/
+
+#ifndef MK_TILES_H
+#define MK_TILES_H
+
+#include <functional>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+namespace mk {
+
+/// A tile of an image, processed independently from the others
+struct Tile
+{
+	int      index; // index of the tile, e.g. to use a buffer per tile
+	cv::Rect roi;   // part of the image written by the tile
+	cv::Rect halo;  // part of the image read by the tile: the roi with a margin for neighbourhood operations
+
+	/// Position of the roi inside the halo
+	inline cv::Rect Local() const {return cv::Rect(roi.x - halo.x, roi.y - halo.y, roi.width, roi.height);}
+};
+
+std::vector<Tile> splitInStripes(const cv::Size& x_size, int x_nbTiles, int x_halo);
+void parallelForEach(int x_nb, const std::function<void(int)>& x_function);
+
+} // namespace mk
+#endif
@@ -23,6 +23,7 @@
 
 #include "feature_util.h"
 #include "MkException.h"
+#include <cstring>
 
 using namespace std;
 using namespace cv;
@@ -63,6 +64,71 @@ void randomize(Point3f& xr_val, unsigned int& xr_seed)
 	randomize(xr_val.y, xr_seed);
 	randomize(xr_val.z, xr_seed);
 }
+
+/* -------------------------------------------------------------------------------- */
+
+namespace mk {
+void to_json(mkjson& _json, const BinaryDescriptor& _desc)
+{
+	static const char digits[] = "0123456789abcdef";
+	string hex(2 * _desc.bytes.size(), '0');
+	for(size_t i = 0 ; i < _desc.bytes.size() ; i++)
+	{
+		hex[2 * i]     = digits[_desc.bytes[i] >> 4];
+		hex[2 * i + 1] = digits[_desc.bytes[i] & 0xf];
+	}
+	_json = mkjson{{"type", "binary"}, {"hex", hex}};
+}
+
+void from_json(const mkjson& _json, BinaryDescriptor& _desc)
+{
+	if(_json.at("type").get<string>() != "binary")
+		throw MkException("Wrong descriptor type " + _json.at("type").get<string>(), LOC);
+	const string hex = _json.at("hex").get<string>();
+	if(hex.size() % 2 != 0)
+		throw MkException("Binary descriptor must have an even number of hexadecimal digits: " + hex, LOC);
+
+	auto value = [&hex](char x_digit) -> int
+	{
+		if(x_digit >= '0' && x_digit <= '9')
+			return x_digit - '0';
+		if(x_digit >= 'a' && x_digit <= 'f')
+			return x_digit - 'a' + 10;
+		if(x_digit >= 'A' && x_digit <= 'F')
+			return x_digit - 'A' + 10;
+		throw MkException("Invalid hexadecimal digit in binary descriptor: " + hex, LOC);
+	};
+	_desc.bytes.resize(hex.size() / 2);
+	for(size_t i = 0 ; i < _desc.bytes.size() ; i++)
+		_desc.bytes[i] = static_cast<uchar>(value(hex[2 * i]) << 4 | value(hex[2 * i + 1]));
+}
+} // namespace mk
+
+/// Number of different bits between two binary strings
+int hammingDistance(const uchar* x_1, const uchar* x_2, size_t x_size)
+{
+	int distance = 0;
+	size_t i = 0;
+	// note: 64 bits are compared at once, the compiler uses the POPCNT instruction when available
+	for( ; i + 8 <= x_size ; i += 8)
+	{
+		uint64_t word1, word2;
+		memcpy(&word1, x_1 + i, 8);
+		memcpy(&word2, x_2 + i, 8);
+		distance += __builtin_popcountll(word1 ^ word2);
+	}
+	for( ; i < x_size ; i++)
+		distance += __builtin_popcount(x_1[i] ^ x_2[i]);
+	return distance;
+}
+
+void randomize(mk::BinaryDescriptor& xr_val, unsigned int& xr_seed)
+{
+	// note: ORB descriptors have 32 bytes
+	xr_val.bytes.resize(32);
+	for(auto& elem : xr_val.bytes)
+		elem = rand_r(&xr_seed) % 256;
+}
 /* -------------------------------------------------------------------------------- */
 // note: Support for FeatureMat is only partially implemented
 
@@ -116,6 +116,33 @@ inline double compareSquared(const cv::KeyPoint& x_1, const cv::KeyPoint& x_2)
 }
 void randomize(cv::KeyPoint& xr_val, unsigned int& xr_seed);
 
+/* -------------------------------------------------------------------------------- */
+// Template specialization for features of type BinaryDescriptor
+
+namespace mk {
+/// A binary descriptor of keypoint (e.g. ORB, BRISK, AKAZE): the bits are packed in bytes as computed by OpenCV
+struct BinaryDescriptor
+{
+	std::vector<uchar> bytes;
+};
+// note: bytes are serialized as a string in hexadecimal format, to keep logs compact
+void to_json(mk::mkjson& _json, const BinaryDescriptor& _desc);
+void from_json(const mk::mkjson& _json, BinaryDescriptor& _desc);
+} // namespace mk
+
+int hammingDistance(const uchar* x_1, const uchar* x_2, size_t x_size);
+
+/// Squared Hamming distance, normalized by the number of bits
+inline double compareSquared(const mk::BinaryDescriptor& x_1, const mk::BinaryDescriptor& x_2)
+{
+	if(x_1.bytes.size() != x_2.bytes.size())
+		return 1;
+	if(x_1.bytes.empty())
+		return 0;
+	return POW2(static_cast<double>(hammingDistance(x_1.bytes.data(), x_2.bytes.data(), x_1.bytes.size())) / (8 * x_1.bytes.size()));
+}
+void randomize(mk::BinaryDescriptor& xr_val, unsigned int& xr_seed);
+
 /* -------------------------------------------------------------------------------- */
 // Template specialization for features of type float
 
@@ -157,6 +184,19 @@ inline void randomize(int& xr_val, unsigned int& xr_seed)
 	xr_val = rand_r(&xr_seed) % 1000;
 }
 
+/* -------------------------------------------------------------------------------- */
+// Template specialization for features of type uchar
+
+inline double compareSquared(uchar x_1, uchar x_2)
+{
+	return POW2(static_cast<int>(x_1) - x_2);
+}
+
+inline void randomize(uchar& xr_val, unsigned int& xr_seed)
+{
+	xr_val = rand_r(&xr_seed) % 256;
+}
+
 /* -------------------------------------------------------------------------------- */
 // Template specialization for features of type uint
 
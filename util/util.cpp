@@ -31,6 +31,7 @@
 #include <opencv2/opencv.hpp>
 #include "Manager.h"
 #include "Event.h"
+#include "ImageEncoder.h"
 #include "MkException.h"
 #include "AnnotationSrtFileReader.h"
 #include "AnnotationAssFileReader.h"
@@ -556,18 +557,21 @@ void execute(const string& x_cmd, vector<string>& xr_result)
 }
 
 /**
-* @brief Write image to disk and add the path of the image to the event
+* @brief Write image to disk (asynchronously) and add the path of the image to the event
 *
 * @param x_image        Image to add
-* @param x_fileWithPath Path to image
+* @param x_fileWithPath Path to image, the extension determines the format
 * @param xr_event       Event to modify
+* @param xr_encoder     Encoder used to write the image
+* @param x_quality      Quality of the encoding [0-100]
+* @return A future that is ready once the image is written: the image must be on disk before the event is notified
 *
 */
-void addExternalImage(const Mat& x_image, const std::string& x_name, const std::string& x_fileWithPath, Event& xr_event)
+std::future<void> addExternalImage(const Mat& x_image, const std::string& x_name, const std::string& x_fileWithPath, Event& xr_event, ImageEncoder& xr_encoder, int x_quality)
 {
-	imwrite(x_fileWithPath, x_image);
 	// LOG_DEBUG(m_logger, "Add external file to event " << x_name << ": " << x_fileWithPath);
 	xr_event.AddExternalFile(x_name, x_fileWithPath);
+	return xr_encoder.Encode(x_image, x_fileWithPath.substr(x_fileWithPath.find_last_of('.') + 1), x_quality, x_fileWithPath);
 }
 
 
@@ -583,15 +587,16 @@ void addExternalImage(const Mat& x_image, const std::string& x_name, const std::
 AnnotationFileReader* createAnnotationFileReader(const string& x_fileName, int x_width, int x_height)
 {
 	AnnotationFileReader* p = nullptr;
+	const string name = uncompressedFileName(x_fileName);
 	if(x_fileName.empty())
 	{
 		throw MkException("Name for file is empty", LOC);
 	}
-	else if(x_fileName.substr(x_fileName.find_last_of(".") + 1) == "ass")
+	else if(name.substr(name.find_last_of(".") + 1) == "ass")
 	{
 		p = new AnnotationAssFileReader(x_width, x_height);
 	}
-	else if(x_fileName.substr(x_fileName.find_last_of(".") + 1) == "srt")
+	else if(name.substr(name.find_last_of(".") + 1) == "srt")
 	{
 		p = new AnnotationSrtFileReader();
 	}
@@ -600,6 +605,22 @@ AnnotationFileReader* createAnnotationFileReader(const string& x_fileName, int x
 	return p;
 }
 
+/**
+* @brief Return the name of a file without the extension of compression (.gz or .bz2)
+*
+* @param x_fileName Name of the file
+* @return Name without the extension of compression
+*/
+string uncompressedFileName(const string& x_fileName)
+{
+	for(const string ext : {".gz", ".bz2"})
+	{
+		if(x_fileName.size() > ext.size() && x_fileName.compare(x_fileName.size() - ext.size(), ext.size(), ext) == 0)
+			return x_fileName.substr(0, x_fileName.size() - ext.size());
+	}
+	return x_fileName;
+}
+
 /**
 * @brief Remove tabs and carriage return
 *
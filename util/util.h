@@ -25,10 +25,12 @@
 #define UTIL_H
 
 #include <opencv2/core/core.hpp>
+#include <future>
 #include "define.h"
 
 namespace mk {
 class Event;
+class ImageEncoder;
 class AnnotationFileReader;
 class FeaturePtr;
 
@@ -57,7 +59,7 @@ std::string basename(const std::string& x_pathName);
 void printStack(int sig);
 void execute(const std::string& x_cmd, std::ostream& xr_stdout);
 void execute(const std::string& x_cmd, std::vector<std::string>& xr_result);
-void addExternalImage(const cv::Mat& x_image, const std::string& x_name, const std::string& x_fileWithPath, Event& xr_event);
+std::future<void> addExternalImage(const cv::Mat& x_image, const std::string& x_name, const std::string& x_fileWithPath, Event& xr_event, ImageEncoder& xr_encoder, int x_quality);
 
 template<class T> void mergeVector(std::vector<T>& vdest, const std::vector<T>& vori)
 {
@@ -70,6 +72,7 @@ template<class T> void mergeVector(std::vector<T>& vdest, const std::vector<T>&
 }
 
 AnnotationFileReader* createAnnotationFileReader(const std::string& x_fileName, int x_width, int x_height);
+std::string uncompressedFileName(const std::string& x_fileName);
 void singleLine(std::string& str);
 double convertAspectRatio(const std::string& x_string);
 std::string convertAspectRatio(const cv::Size& x_size);